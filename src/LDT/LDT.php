@@ -198,6 +198,12 @@ abstract class LDT
      * @see LDT::errorno()
      */
     protected $errorno;
+    /**
+     * The prepared UDF calls of the module, indexed by function name
+     * @var array
+     * @see Aerospike::prepareApply()
+     */
+    protected $calls = array();
 
     /**
      * Constructor for the abstract \Aerospike\LDT class. Inherited by LDT types.
@@ -254,7 +260,7 @@ abstract class LDT
      * @return boolean
      */
     public function isLDT() {
-        $status = $this->db->apply($this->key, $this->module, 'ldt_exists', array($this->bin), $returned);
+        $status = $this->apply('ldt_exists', array($this->bin), $returned);
         $this->processStatusCode($status);
         if ($status !== Aerospike::OK) {
             return false;
@@ -270,7 +276,7 @@ abstract class LDT
      * @return int status code of the operation
      */
     public function size(&$num_elements) {
-        $status = $this->db->apply($this->key, $this->module, 'size', array($this->bin), $num_elements);
+        $status = $this->apply('size', array($this->bin), $num_elements);
         $this->processStatusCode($status);
         return $status;
     }
@@ -282,7 +288,7 @@ abstract class LDT
      * @return int status code of the operation
      */
     public function getCapacity(&$num_elements) {
-        $status = $this->db->apply($this->key, $this->module, 'get_capacity', array($this->bin), $num_elements);
+        $status = $this->apply('get_capacity', array($this->bin), $num_elements);
         $this->processStatusCode($status);
         return $status;
     }
@@ -294,7 +300,7 @@ abstract class LDT
      * @return int status code of the operation
      */
     public function setCapacity($num_elements) {
-        $status = $this->db->apply($this->key, $this->module, 'set_capacity', array($this->bin, $num_elements));
+        $status = $this->apply('set_capacity', array($this->bin, $num_elements));
         $this->processStatusCode($status);
         return $status;
     }
@@ -305,11 +311,31 @@ abstract class LDT
      * @return int status code of the operation
      */
     public function destroy() {
-        $status = $this->db->apply($this->key, $this->module, 'destroy', array($this->bin));
+        $status = $this->apply('destroy', array($this->bin));
         $this->processStatusCode($status);
         return $status;
     }
 
+    /**
+     * Applies a function of the LDT's UDF module to the record, reusing
+     * the prepared call for that function across operations.
+     *
+     * @param string $function name of the UDF in the module
+     * @param array $args passed to the UDF
+     * @param mixed $returned value of the UDF
+     * @return int status code of the operation
+     */
+    protected function apply($function, array $args, &$returned = null) {
+        if (!isset($this->calls[$function])) {
+            $call = $this->db->prepareApply($this->module, $function);
+            if (!$call) {
+                return $this->db->apply($this->key, $this->module, $function, $args, $returned);
+            }
+            $this->calls[$function] = $call;
+        }
+        return $this->calls[$function]->apply($this->key, $args, $returned);
+    }
+
     /**
      * Process the operation status code into error number and message
      *
@@ -67,7 +67,7 @@ class LList extends LDT
             $this->error = self::MSG_TYPE_NOT_SUPPORTED;
             return $this->errorno;
         }
-        $status = $this->db->apply($this->key, 'llist', 'add', array($this->bin, $value));
+        $status = $this->apply('add', array($this->bin, $value));
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -81,7 +81,7 @@ class LList extends LDT
      * @return int status code of the operation
      */
     public function addMany(array $values) {
-        $status = $this->db->apply($this->key, 'llist', 'add_all', array($this->bin, $values));
+        $status = $this->apply('add_all', array($this->bin, $values));
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -102,7 +102,7 @@ class LList extends LDT
             return $this->errorno;
         }
         $elements = array();
-        $status = $this->db->apply($this->key, 'llist', 'find', array($this->bin, $value), $elements);
+        $status = $this->apply('find', array($this->bin, $value), $elements);
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -122,7 +122,7 @@ class LList extends LDT
             $this->error = self::MSG_TYPE_NOT_ATOMIC;
             return $this->errorno;
         }
-        $status = $this->db->apply($this->key, 'llist', 'remove', array($this->bin, $value));
+        $status = $this->apply('remove', array($this->bin, $value));
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -141,7 +141,7 @@ class LList extends LDT
     public function scan(&$elements, $min=null, $max=null) {
         $elements = array();
         if (is_null($min) && is_null($max)) {
-            $status = $this->db->apply($this->key, 'llist', 'scan', array($this->bin), $elements);
+            $status = $this->apply('scan', array($this->bin), $elements);
         } else {
             if ((!is_string($min) && !is_int($min) && !is_null($min)) ||
                 (!is_string($max) && !is_int($max) && !is_null($max))) {
@@ -149,7 +149,7 @@ class LList extends LDT
                 $this->error = self::MSG_RANGE_TYPE_INVALID;
                 return $this->errorno;
             }
-            $status = $this->db->apply($this->key, 'llist', 'range', array($this->bin, $min, $max), $elements);
+            $status = $this->apply('range', array($this->bin, $min, $max), $elements);
         }
         $this->processStatusCode($status);
         return $this->errorno;
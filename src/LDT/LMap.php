@@ -71,7 +71,7 @@ class LMap extends LDT
             $this->error = self::MSG_TYPE_NOT_SUPPORTED;
             return $this->errorno;
         }
-        $status = $this->db->apply($this->key, 'lmap', 'put', array($this->bin, $key, $value));
+        $status = $this->apply('put', array($this->bin, $key, $value));
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -86,7 +86,7 @@ class LMap extends LDT
      * @see put
      */
     public function putMany(array $key_values) {
-        $status = $this->db->apply($this->key, 'lmap', 'put_all', array($this->bin, $key_values));
+        $status = $this->apply('put_all', array($this->bin, $key_values));
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -105,7 +105,7 @@ class LMap extends LDT
             return $this->errorno;
         }
         $element = array();
-        $status = $this->db->apply($this->key, 'lmap', 'get', array($this->bin, $key), $element);
+        $status = $this->apply('get', array($this->bin, $key), $element);
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -122,7 +122,7 @@ class LMap extends LDT
             $this->error = self::MSG_TYPE_NOT_ATOMIC;
             return $this->errorno;
         }
-        $status = $this->db->apply($this->key, 'lmap', 'remove', array($this->bin, $key));
+        $status = $this->apply('remove', array($this->bin, $key));
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -135,7 +135,7 @@ class LMap extends LDT
      */
     public function scan(&$elements) {
         $elements = array();
-        $status = $this->db->apply($this->key, 'lmap', 'scan', array($this->bin), $elements);
+        $status = $this->apply('scan', array($this->bin), $elements);
         $this->processStatusCode($status);
         return $this->errorno;
     }
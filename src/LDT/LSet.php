@@ -66,7 +66,7 @@ class LSet extends LDT
             $this->error = self::MSG_TYPE_NOT_SUPPORTED;
             return $this->errorno;
         }
-        $status = $this->db->apply($this->key, 'lset', 'add', array($this->bin, $value));
+        $status = $this->apply('add', array($this->bin, $value));
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -80,7 +80,7 @@ class LSet extends LDT
      * @return int status code of the operation
      */
     public function addMany(array $values) {
-        $status = $this->db->apply($this->key, 'lset', 'add_all', array($this->bin, $values));
+        $status = $this->apply('add_all', array($this->bin, $values));
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -102,7 +102,7 @@ class LSet extends LDT
             return $this->errorno;
         }
         $elements = array();
-        $status = $this->db->apply($this->key, 'lset', 'exists', array($this->bin, $value), $found);
+        $status = $this->apply('exists', array($this->bin, $value), $found);
         $this->processStatusCode($status);
         if ($status !== Aerospike::OK) {
             $found = false;
@@ -127,7 +127,7 @@ class LSet extends LDT
             $this->error = self::MSG_TYPE_NOT_ATOMIC;
             return $this->errorno;
         }
-        $status = $this->db->apply($this->key, 'lset', 'remove', array($this->bin, $value));
+        $status = $this->apply('remove', array($this->bin, $value));
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -140,7 +140,7 @@ class LSet extends LDT
      */
     public function scan(&$elements) {
         $elements = array();
-        $status = $this->db->apply($this->key, 'lset', 'scan', array($this->bin), $elements);
+        $status = $this->apply('scan', array($this->bin), $elements);
         $this->processStatusCode($status);
         return $status;
     }
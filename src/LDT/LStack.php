@@ -65,7 +65,7 @@ class LStack extends LDT
             $this->error = self::MSG_TYPE_NOT_SUPPORTED;
             return $this->errorno;
         }
-        $status = $this->db->apply($this->key, 'lstack', 'push', array($this->bin, $value));
+        $status = $this->apply('push', array($this->bin, $value));
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -80,7 +80,7 @@ class LStack extends LDT
      * @see push
      */
     public function pushMany(array $values) {
-        $status = $this->db->apply($this->key, 'lstack', 'push_all', array($this->bin, $values));
+        $status = $this->apply('push_all', array($this->bin, $values));
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -99,7 +99,7 @@ class LStack extends LDT
             return $this->errorno;
         }
         $elements = array();
-        $status = $this->db->apply($this->key, 'lstack', 'peek', array($this->bin, $num), $elements);
+        $status = $this->apply('peek', array($this->bin, $num), $elements);
         $this->processStatusCode($status);
         return $this->errorno;
     }
@@ -67,6 +67,10 @@ bool record_stream_callback(const as_val* p_val, void* udata);
  */
 static zend_class_entry *Aerospike_ce;
 static zend_object_handlers Aerospike_handlers;
+static zend_class_entry *Aerospike_udf_call_ce;
+static zend_object_handlers Aerospike_udf_call_handlers;
+zend_class_entry *Aerospike_key_ce;
+static zend_object_handlers Aerospike_key_handlers;
 /*
  ********************************************************************
  * END OF GLOBAL AEROSPIKE CLASS ENTRY
@@ -93,6 +97,26 @@ PHP_INI_BEGIN()
    STD_PHP_INI_ENTRY("aerospike.shm.max_nodes", "16", PHP_INI_PERDIR|PHP_INI_SYSTEM, OnUpdateLong, shm_max_nodes, zend_aerospike_globals, aerospike_globals)
    STD_PHP_INI_ENTRY("aerospike.shm.max_namespaces", "8", PHP_INI_PERDIR|PHP_INI_SYSTEM, OnUpdateLong, shm_max_namespaces, zend_aerospike_globals, aerospike_globals)
    STD_PHP_INI_ENTRY("aerospike.shm.takeover_threshold_sec", "30", PHP_INI_PERDIR|PHP_INI_SYSTEM, OnUpdateLong, shm_takeover_threshold_sec, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.session.lock", "false", PHP_INI_ALL, OnUpdateBool, session_lock, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.session.lock_ttl", "30", PHP_INI_ALL, OnUpdateLong, session_lock_ttl, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.session.lock_wait", "5000", PHP_INI_ALL, OnUpdateLong, session_lock_wait, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.session.skip_read_new_id", "false", PHP_INI_ALL, OnUpdateBool, session_skip_read_new_id, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.session.compress_threshold", "0", PHP_INI_ALL, OnUpdateLong, session_compress_threshold, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.session.bin_per_key", "false", PHP_INI_ALL, OnUpdateBool, session_bin_per_key, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.session.bin_per_key_max", "64", PHP_INI_ALL, OnUpdateLong, session_bin_per_key_max, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.sindex_cache_ttl", "5", PHP_INI_ALL, OnUpdateLong, sindex_cache_ttl, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.read_cache.max_memory", "0", PHP_INI_PERDIR|PHP_INI_SYSTEM, OnUpdateLong, read_cache_max_memory, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.read_cache.max_age", "1", PHP_INI_ALL, OnUpdateLong, read_cache_max_age, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.shm.record_cache.key", "2785017856", PHP_INI_PERDIR|PHP_INI_SYSTEM, OnUpdateLong, shm_record_cache_key, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.shm.record_cache.size", "0", PHP_INI_PERDIR|PHP_INI_SYSTEM, OnUpdateLong, shm_record_cache_size, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.shm.record_cache.slot_size", "1024", PHP_INI_PERDIR|PHP_INI_SYSTEM, OnUpdateLong, shm_record_cache_slot_size, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.shm.record_cache.max_ttl", "60", PHP_INI_ALL, OnUpdateLong, shm_record_cache_max_ttl, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.read_memo", "false", PHP_INI_ALL, OnUpdateBool, read_memo, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.call_trace_size", "0", PHP_INI_ALL, OnUpdateLong, call_trace_size, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.slow_log.threshold", "0", PHP_INI_ALL, OnUpdateLong, slow_log_threshold, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.slow_log.sample_rate", "0", PHP_INI_ALL, OnUpdateLong, slow_log_sample_rate, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.slow_log.path", NULL, PHP_INI_PERDIR|PHP_INI_SYSTEM, OnUpdateString, slow_log_path, zend_aerospike_globals, aerospike_globals)
+   STD_PHP_INI_ENTRY("aerospike.log_handler.buffer_size", "0", PHP_INI_PERDIR|PHP_INI_SYSTEM, OnUpdateLong, log_handler_buffer_size, zend_aerospike_globals, aerospike_globals)
 PHP_INI_END()
 
 
@@ -115,6 +139,8 @@ static void aerospike_check_close_and_destroy(void *hashtable_element) {
             }
             as_ref_p->ref_hosts_entry = 0;
             as_ref_p->as_p = NULL;
+            aerospike_index_cache_destroy(&as_ref_p->sindex_cache);
+            aerospike_record_cache_destroy(&as_ref_p->record_cache);
             if (as_ref_p) {
                 pefree(as_ref_p, 1);
             }
@@ -130,6 +156,14 @@ static void aerospike_globals_ctor(zend_aerospike_globals *globals TSRMLS_DC)
 {
     DEBUG_PHP_EXT_DEBUG("In ctor");
     pthread_rwlock_init(&AEROSPIKE_G(aerospike_mutex), NULL);
+    AEROSPIKE_G(session_save_path_g) = NULL;
+    AEROSPIKE_G(session_as_ref_g) = NULL;
+    AEROSPIKE_G(read_memo_g) = NULL;
+    AEROSPIKE_G(call_traces_g) = NULL;
+    AEROSPIKE_G(call_trace_capacity_g) = 0;
+    AEROSPIKE_G(call_trace_count_g) = 0;
+    AEROSPIKE_G(call_trace_next_g) = 0;
+    AEROSPIKE_G(slow_log_calls_g) = 0;
     if ((!(AEROSPIKE_G(persistent_list_g))) || (AEROSPIKE_G(persistent_ref_count) < 1)) {
         AEROSPIKE_G(persistent_list_g) = (HashTable *)pemalloc(sizeof(HashTable), 1);
         zend_hash_init(AEROSPIKE_G(persistent_list_g), 1000, NULL, &aerospike_check_close_and_destroy, 1);
@@ -141,6 +175,15 @@ static void aerospike_globals_ctor(zend_aerospike_globals *globals TSRMLS_DC)
 
 static void aerospike_globals_dtor(zend_aerospike_globals *globals TSRMLS_DC)
 {
+    if (globals->session_save_path_g) {
+        pefree(globals->session_save_path_g, 1);
+        globals->session_save_path_g = NULL;
+    }
+    globals->session_as_ref_g = NULL;
+    if (globals->call_traces_g) {
+        pefree(globals->call_traces_g, 1);
+        globals->call_traces_g = NULL;
+    }
     if (globals->persistent_list_g) {
         if (AEROSPIKE_G(persistent_ref_count) == 1) {
             DEBUG_PHP_EXT_DEBUG("Ref count is working");
@@ -289,8 +332,11 @@ static zend_function_entry Aerospike_class_functions[] =
     PHP_ME(Aerospike, close, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, reconnect, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, getNodes, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, getStats, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, lastCallTrace, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, info, arginfo_sec_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, infoMany, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, infoParsed, arginfo_sec_by_ref, ZEND_ACC_PUBLIC)
 
     /*
      ********************************************************************
@@ -307,12 +353,14 @@ static zend_function_entry Aerospike_class_functions[] =
      */
     PHP_ME(Aerospike, add, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, append, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, compilePolicy, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, exists, arginfo_sec_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, get, arginfo_sec_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, getHeader, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, getMetadata, arginfo_sec_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, increment, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, initKey, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, prepareKey, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, operate, arginfo_third_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, prepend, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, put, NULL, ZEND_ACC_PUBLIC)
@@ -336,7 +384,10 @@ static zend_function_entry Aerospike_class_functions[] =
      ********************************************************************
      */
     PHP_ME(Aerospike, createIndex, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, createIndexAsync, arginfo_sixth_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, dropIndex, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, indexes, arginfo_first_by_ref, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, taskStatus, arginfo_sec_by_ref, ZEND_ACC_PUBLIC)
 
     /*
      ********************************************************************
@@ -345,11 +396,20 @@ static zend_function_entry Aerospike_class_functions[] =
      */
     PHP_ME(Aerospike, predicateBetween, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Aerospike, predicateEquals, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Aerospike, predicateIn, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Aerospike, predicateContains, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Aerospike, query, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, aggregate, arginfo_seventh_by_ref, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, reduce, arginfo_fifth_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, scan, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, scanNodes, arginfo_third_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, scanApply, arginfo_sixth_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, scanInfo, arginfo_sec_by_ref, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, queryApplyEach, arginfo_seventh_by_ref, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, jobInfo, arginfo_third_by_ref, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, jobsList, arginfo_first_by_ref, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, jobAbort, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, jobSetPriority, NULL, ZEND_ACC_PUBLIC)
 
     /*
      ********************************************************************
@@ -357,8 +417,10 @@ static zend_function_entry Aerospike_class_functions[] =
      ********************************************************************
      */
     PHP_ME(Aerospike, register, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, registerAsync, arginfo_third_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, deregister, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, apply, arginfo_fifth_by_ref, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, prepareApply, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, listRegistered, arginfo_first_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, getRegistered, arginfo_sec_by_ref, ZEND_ACC_PUBLIC)
 
@@ -373,6 +435,30 @@ static zend_function_entry Aerospike_class_functions[] =
     { NULL, NULL, NULL }
 };
 
+/*
+ ********************************************************************
+ *  The function entries for the Aerospike\UdfCall class.
+ ********************************************************************
+ */
+static zend_function_entry Aerospike_udf_call_class_functions[] =
+{
+    PHP_ME(AerospikeUdfCall, apply, arginfo_third_by_ref, ZEND_ACC_PUBLIC)
+
+    { NULL, NULL, NULL }
+};
+
+/*
+ ********************************************************************
+ *  The function entries for the Aerospike\Key class.
+ ********************************************************************
+ */
+static zend_function_entry Aerospike_key_class_functions[] =
+{
+    PHP_ME(AerospikeKey, toArray, NULL, ZEND_ACC_PUBLIC)
+
+    { NULL, NULL, NULL }
+};
+
 /*
  ********************************************************************
  * Aerospike object freeing up on scope termination
@@ -395,6 +481,8 @@ static void Aerospike_object_free_storage(void *object TSRMLS_DC)
             }
             aerospike_destroy(intern_obj_p->as_ref_p->as_p);
             intern_obj_p->as_ref_p->as_p = NULL;
+            aerospike_index_cache_destroy(&intern_obj_p->as_ref_p->sindex_cache);
+            aerospike_record_cache_destroy(&intern_obj_p->as_ref_p->record_cache);
             if (intern_obj_p->as_ref_p) {
                 pefree(intern_obj_p->as_ref_p, 1);
             }
@@ -437,6 +525,106 @@ static zend_object_value Aerospike_object_new(zend_class_entry *ce TSRMLS_DC)
     return (retval);
 }
 
+/*
+ ********************************************************************
+ * Aerospike\UdfCall object freeing up on scope termination
+ ********************************************************************
+ */
+static void Aerospike_udf_call_object_free_storage(void *object TSRMLS_DC)
+{
+    Aerospike_udf_call_object   *intern_obj_p = (Aerospike_udf_call_object *) object;
+
+    if (intern_obj_p) {
+        if (intern_obj_p->args_list_p) {
+            as_arraylist_destroy(intern_obj_p->args_list_p);
+            intern_obj_p->args_list_p = NULL;
+        }
+        if (intern_obj_p->udf_pool_p) {
+            efree(intern_obj_p->udf_pool_p);
+            intern_obj_p->udf_pool_p = NULL;
+        }
+        if (intern_obj_p->aerospike_p) {
+            zval_ptr_dtor(&intern_obj_p->aerospike_p);
+        }
+        zend_object_std_dtor(&intern_obj_p->std TSRMLS_CC);
+        efree(intern_obj_p);
+    } else {
+        DEBUG_PHP_EXT_ERROR("invalid udf call object");
+    }
+}
+
+/*
+ ********************************************************************
+ * Aerospike\UdfCall class new method
+ ********************************************************************
+ */
+static zend_object_value Aerospike_udf_call_object_new(zend_class_entry *ce TSRMLS_DC)
+{
+    zend_object_value retval = {0};
+    Aerospike_udf_call_object *intern_obj_p;
+
+    if (NULL != (intern_obj_p = ecalloc(1, sizeof(Aerospike_udf_call_object)))) {
+        zend_object_std_init(&(intern_obj_p->std), ce TSRMLS_CC);
+#if PHP_VERSION_ID < 50399
+        zend_hash_copy(intern_obj_p->std.properties, &ce->default_properties, (copy_ctor_func_t) zval_add_ref, NULL, sizeof(zval *));
+#else
+        object_properties_init((zend_object*) &(intern_obj_p->std), ce);
+#endif
+
+        retval.handle = zend_objects_store_put(intern_obj_p, NULL, (zend_objects_free_object_storage_t) Aerospike_udf_call_object_free_storage, NULL TSRMLS_CC);
+        retval.handlers = &Aerospike_udf_call_handlers;
+    } else {
+        DEBUG_PHP_EXT_ERROR("Could not allocate memory for udf call object");
+    }
+    return (retval);
+}
+
+/*
+ ********************************************************************
+ * Aerospike\Key object freeing up on scope termination
+ ********************************************************************
+ */
+static void Aerospike_key_object_free_storage(void *object TSRMLS_DC)
+{
+    Aerospike_key_object   *intern_obj_p = (Aerospike_key_object *) object;
+
+    if (intern_obj_p) {
+        if (intern_obj_p->key.valuep) {
+            as_key_destroy(&intern_obj_p->key);
+        }
+        zend_object_std_dtor(&intern_obj_p->std TSRMLS_CC);
+        efree(intern_obj_p);
+    } else {
+        DEBUG_PHP_EXT_ERROR("invalid key object");
+    }
+}
+
+/*
+ ********************************************************************
+ * Aerospike\Key class new method
+ ********************************************************************
+ */
+static zend_object_value Aerospike_key_object_new(zend_class_entry *ce TSRMLS_DC)
+{
+    zend_object_value retval = {0};
+    Aerospike_key_object *intern_obj_p;
+
+    if (NULL != (intern_obj_p = ecalloc(1, sizeof(Aerospike_key_object)))) {
+        zend_object_std_init(&(intern_obj_p->std), ce TSRMLS_CC);
+#if PHP_VERSION_ID < 50399
+        zend_hash_copy(intern_obj_p->std.properties, &ce->default_properties, (copy_ctor_func_t) zval_add_ref, NULL, sizeof(zval *));
+#else
+        object_properties_init((zend_object*) &(intern_obj_p->std), ce);
+#endif
+
+        retval.handle = zend_objects_store_put(intern_obj_p, NULL, (zend_objects_free_object_storage_t) Aerospike_key_object_free_storage, NULL TSRMLS_CC);
+        retval.handlers = &Aerospike_key_handlers;
+    } else {
+        DEBUG_PHP_EXT_ERROR("Could not allocate memory for key object");
+    }
+    return (retval);
+}
+
 /*
  ********************************************************************
  *  Aerospike Client Object APIs:
@@ -544,7 +732,7 @@ PHP_METHOD(Aerospike, __construct)
     DEBUG_PHP_EXT_INFO("Success in creating php-aerospike object");
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -571,7 +759,7 @@ PHP_METHOD(Aerospike, __destruct)
 
     DEBUG_PHP_EXT_INFO("Destruct method of aerospike object executed");
 exit:
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -655,7 +843,7 @@ PHP_METHOD(Aerospike, close)
     aerospike_obj_p->is_conn_16 = AEROSPIKE_CONN_STATE_FALSE;
 
 exit:
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -709,7 +897,7 @@ PHP_METHOD(Aerospike, reconnect)
     aerospike_obj_p->is_conn_16 = AEROSPIKE_CONN_STATE_TRUE;
 
 exit:
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 /*
@@ -761,9 +949,9 @@ PHP_METHOD(Aerospike, get)
         goto exit;
     }
 
-    if (PHP_TYPE_ISNOTARR(key_record_p) ||
+    if (PHP_TYPE_ISNOTKEY(key_record_p) ||
             ((bins_p) && ((PHP_TYPE_ISNOTARR(bins_p)) && (PHP_TYPE_ISNOTNULL(bins_p)))) ||
-            ((options_p) && ((PHP_TYPE_ISNOTARR(options_p)) && (PHP_TYPE_ISNOTNULL(options_p))))) {
+            ((options_p) && ((PHP_TYPE_ISNOTOPTIONS(options_p)) && (PHP_TYPE_ISNOTNULL(options_p))))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Input parameters (type) for get function not proper");
         DEBUG_PHP_EXT_ERROR("Input parameters (type) for get function not proper.");
@@ -781,15 +969,21 @@ PHP_METHOD(Aerospike, get)
     zval_dtor(record_p);
     array_init(record_p);
 
-    if (AEROSPIKE_OK != (status = aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_record_p),
+    if (AEROSPIKE_OK != (status = aerospike_transform_get_rec_key(key_record_p,
                     &as_key_for_get_record,
-                    &initializeKey))) {
+                    &initializeKey TSRMLS_CC))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse key parameters for get function");
         DEBUG_PHP_EXT_ERROR("Unable to parse key parameters for get function ");
         goto exit;
     }
 
+    if (aerospike_read_memo_get(&aerospike_obj_p->as_ref_p->record_cache,
+                &as_key_for_get_record, bins_p, record_p TSRMLS_CC)) {
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_OK, DEFAULT_ERROR);
+        goto exit;
+    }
+
     if (AEROSPIKE_OK != (status = aerospike_transform_get_record(aerospike_obj_p,
                     &as_key_for_get_record,
                     options_p,
@@ -800,12 +994,15 @@ PHP_METHOD(Aerospike, get)
         goto exit;
     }
 
+    aerospike_read_memo_put(&aerospike_obj_p->as_ref_p->record_cache,
+            &as_key_for_get_record, bins_p, record_p TSRMLS_CC);
+
 exit:
     if (initializeKey) {
         as_key_destroy(&as_key_for_get_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -844,24 +1041,24 @@ PHP_METHOD(Aerospike, put)
         goto exit;
     }
 
-    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "aa|la", &key_record_p, &record_p, &ttl_u32, &options_p)) {
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "za|lz", &key_record_p, &record_p, &ttl_u32, &options_p)) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse parameters for put");
         DEBUG_PHP_EXT_ERROR("Unable to parse parameters for put");
         goto exit;
     }
 
-    if ((PHP_TYPE_ISNOTARR(key_record_p)) ||
+    if ((PHP_TYPE_ISNOTKEY(key_record_p)) ||
             (PHP_TYPE_ISNOTARR(record_p)) ||
-            ((options_p) && (PHP_TYPE_ISNOTARR(options_p)))) {
+            ((options_p) && (PHP_TYPE_ISNOTOPTIONS(options_p)))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Input parameters (type) for get function not proper");
         DEBUG_PHP_EXT_ERROR("Input parameters (type) for put function not proper");
         goto exit;
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_record_p),
-                    &as_key_for_put_record, &initializeKey))) {
+    if (AEROSPIKE_OK != (status = aerospike_transform_get_rec_key(key_record_p,
+                    &as_key_for_put_record, &initializeKey TSRMLS_CC))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to iterate through put key params");
         DEBUG_PHP_EXT_ERROR("Unable to iterate through put key params");
@@ -876,13 +1073,64 @@ PHP_METHOD(Aerospike, put)
 
 exit:
     if (initializeKey) {
+        aerospike_record_cache_remove(&aerospike_obj_p->as_ref_p->record_cache, &as_key_for_put_record TSRMLS_CC);
         as_key_destroy(&as_key_for_put_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::compilePolicy()
+ *******************************************************************************************************
+ * Validates options once into an Aerospike\Policy object, which can be
+ * passed in place of the options array of the methods of its policy type.
+ * Method prototype for PHP userland:
+ * public Aerospike\Policy Aerospike::compilePolicy ( int $type [, array $options ] )
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, compilePolicy)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    long                   type = 0;
+    zval*                  options_p = NULL;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    PHP_EXT_SET_AS_ERR(&error, DEFAULT_ERRORNO, DEFAULT_ERROR);
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "l|a!",
+                &type, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for compilePolicy()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse parameters for compilePolicy()");
+        goto exit;
+    }
+
+    aerospike_policy_compile(return_value, type, options_p, &error TSRMLS_CC);
+    if (AEROSPIKE_OK != (status = error.code)) {
+        DEBUG_PHP_EXT_ERROR("Unable to compile policy");
+        goto exit;
+    }
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    if (AEROSPIKE_OK != status) {
+        RETURN_NULL();
+    }
+}
+
 /*
  *******************************************************************************************************
  * PHP Method:  Aerospike::getNodes()
@@ -925,13 +1173,50 @@ PHP_METHOD(Aerospike, getNodes)
 
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     if (AEROSPIKE_OK != status) {
         zval_dtor(return_value);
         RETURN_NULL();
     }
 }
 
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::getStats()
+ *******************************************************************************************************
+ * Get the latency statistics of the operations of this process.
+ * Method prototype for PHP userland:
+ * public array Aerospike::getStats ( void )
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, getStats)
+{
+    if (zend_parse_parameters_none() == FAILURE) {
+        RETURN_NULL();
+    }
+
+    aerospike_latency_stats(return_value TSRMLS_CC);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::lastCallTrace()
+ *******************************************************************************************************
+ * Get the traces of the last calls of the request, kept when
+ * aerospike.call_trace_size is set.
+ * Method prototype for PHP userland:
+ * public array Aerospike::lastCallTrace ( void )
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, lastCallTrace)
+{
+    if (zend_parse_parameters_none() == FAILURE) {
+        RETURN_NULL();
+    }
+
+    aerospike_call_trace_list(return_value TSRMLS_CC);
+}
+
 /*
  *******************************************************************************************************
  * PHP Method:  Aerospike::info()
@@ -993,7 +1278,7 @@ PHP_METHOD(Aerospike, info)
 
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -1057,13 +1342,80 @@ PHP_METHOD(Aerospike, infoMany)
 
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     if (AEROSPIKE_OK != status) {
         zval_dtor(return_value);
         RETURN_NULL();
     }
 }
 
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::infoParsed()
+ *******************************************************************************************************
+ * Aerospike::infoParsed - send an info request to a single cluster node and
+ * parse the response into an array of typed values.
+ * Method prototype for PHP userland:
+ * public int Aerospike::infoParsed ( string $request, array &$response [, array $host [, array options ] ] )
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, infoParsed)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    char*                  request = NULL;
+    zval*                  response_p = NULL;
+    long                   request_len = 0;
+    zval*                  host = NULL;
+    zval*                  options_p = NULL;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER, "InfoParsed: connection not established");
+        DEBUG_PHP_EXT_ERROR("InfoParsed: connection not established");
+        goto exit;
+    }
+
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "sz|zz",
+                &request, &request_len, &response_p,
+                &host, &options_p) == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse php parameters for InfoParsed function");
+        DEBUG_PHP_EXT_ERROR("Unable to parse php parameters for InfoParsed function.");
+        goto exit;
+    }
+
+    if (!request || (host && PHP_TYPE_ISNOTARR(host)) || ((options_p) && (PHP_TYPE_ISNOTARR(options_p)))) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Input parameters (type) for InfoParsed function not proper");
+        DEBUG_PHP_EXT_ERROR("Input parameters (type) for InfoParsed function not proper.");
+        goto exit;
+    }
+
+    zval_dtor(response_p);
+    ZVAL_NULL(response_p);
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_info_specific_host_parsed(aerospike_obj_p->as_ref_p->as_p, &error,
+                    request, response_p, host, options_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("InfoParsed function returned an error");
+        goto exit;
+    }
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+
 /*
  *******************************************************************************************************
  * PHP Method:  Aerospike::add()
@@ -1119,7 +1471,7 @@ PHP_METHOD(Aerospike, existsMany)
         goto exit;
     }
 
-    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "az|a", &keys_p, &metadata_p, &options_p)) {
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "az|z", &keys_p, &metadata_p, &options_p)) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse parameters for existsMany");
         DEBUG_PHP_EXT_ERROR("Unable to parse parameters for existsMany");
@@ -1127,7 +1479,7 @@ PHP_METHOD(Aerospike, existsMany)
     }
 
     if ((PHP_TYPE_ISNOTARR(keys_p)) ||
-            ((options_p) && (PHP_TYPE_ISNOTARR(options_p)))) {
+            ((options_p) && (PHP_TYPE_ISNOTOPTIONS(options_p)))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Input parameters (type) for existsMany function not proper");
         DEBUG_PHP_EXT_ERROR("Input parameters (type) for existsMany function not proper");
@@ -1147,7 +1499,7 @@ PHP_METHOD(Aerospike, existsMany)
 
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -1185,7 +1537,7 @@ PHP_METHOD(Aerospike, getMany)
         goto exit;
     }
 
-    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "az|za", &keys_p,
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "az|zz", &keys_p,
                 &records_p, &filter_bins_p, &options_p)) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
@@ -1194,6 +1546,14 @@ PHP_METHOD(Aerospike, getMany)
         goto exit;
     }
 
+    if ((options_p) && (PHP_TYPE_ISNOTOPTIONS(options_p))) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Input parameters (type) for getMany function not proper");
+        DEBUG_PHP_EXT_ERROR("Input parameters (type) for getMany function not proper");
+        goto exit;
+    }
+
     if (filter_bins_p && PHP_TYPE_ISNULL(filter_bins_p)) {
         filter_bins_p = NULL;
     }
@@ -1202,14 +1562,15 @@ PHP_METHOD(Aerospike, getMany)
     array_init(records_p);
 
     if (AEROSPIKE_OK != (status = aerospike_batch_operations_get_many(aerospike_obj_p->as_ref_p->as_p,
-                    &error, keys_p, records_p, filter_bins_p, options_p TSRMLS_CC))) {
+                    &error, &aerospike_obj_p->as_ref_p->record_cache, keys_p,
+                    records_p, filter_bins_p, options_p TSRMLS_CC))) {
         DEBUG_PHP_EXT_ERROR("existsMany() function returned an error");
         goto exit;
     }
 
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -1248,7 +1609,7 @@ PHP_METHOD(Aerospike, operate)
         goto exit;
     }
 
-    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "za|za",
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "za|zz",
                 &key_record_p, &operations_p, &returned_p, &options_p) == FAILURE) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse php parameters for operate function");
@@ -1256,18 +1617,18 @@ PHP_METHOD(Aerospike, operate)
         goto exit;
     }
 
-    if (PHP_TYPE_ISNOTARR(key_record_p) ||
+    if (PHP_TYPE_ISNOTKEY(key_record_p) ||
             PHP_TYPE_ISNOTARR(operations_p) ||
-            ((options_p) && (PHP_TYPE_ISNOTARR(options_p)))) {
+            ((options_p) && (PHP_TYPE_ISNOTOPTIONS(options_p)))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Input parameters (type) for operate function not proper");
         DEBUG_PHP_EXT_ERROR("Input parameters (type) for operate function not proper");
         goto exit;
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_record_p),
+    if (AEROSPIKE_OK != (status = aerospike_transform_get_rec_key(key_record_p,
                     &as_key_for_get_record,
-                    &initializeKey))) {
+                    &initializeKey TSRMLS_CC))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse key parameters for operate function");
         DEBUG_PHP_EXT_ERROR("Unable to parse key parameters for operate function");
@@ -1292,10 +1653,11 @@ PHP_METHOD(Aerospike, operate)
 
 exit:
     if (initializeKey) {
+        aerospike_record_cache_remove(&aerospike_obj_p->as_ref_p->record_cache, &as_key_for_get_record TSRMLS_CC);
         as_key_destroy(&as_key_for_get_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 /*
@@ -1336,7 +1698,7 @@ PHP_METHOD(Aerospike, append)
         goto exit;
     }
 
-    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zss|a",
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zss|z",
                 &key_record_p, &bin_name_p, &bin_name_len,
                 &append_str_p, &append_str_len, &options_p) == FAILURE) {
         status = AEROSPIKE_ERR_PARAM;
@@ -1345,18 +1707,18 @@ PHP_METHOD(Aerospike, append)
         goto exit;
     }
 
-    if (PHP_TYPE_ISNOTARR(key_record_p) ||
+    if (PHP_TYPE_ISNOTKEY(key_record_p) ||
             (!bin_name_p) || (!append_str_p) ||
-            ((options_p) && (PHP_TYPE_ISNOTARR(options_p)))) {
+            ((options_p) && (PHP_TYPE_ISNOTOPTIONS(options_p)))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Input parameters (type) for append function not proper");
         DEBUG_PHP_EXT_ERROR("Input parameters (type) for append function not proper.");
         goto exit;
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_record_p),
+    if (AEROSPIKE_OK != (status = aerospike_transform_get_rec_key(key_record_p,
                     &as_key_for_get_record,
-                    &initializeKey))) {
+                    &initializeKey TSRMLS_CC))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse php parameters for append function");
         DEBUG_PHP_EXT_ERROR("Unable to parse key parameters for append function");
@@ -1379,10 +1741,11 @@ PHP_METHOD(Aerospike, append)
 
 exit:
     if (initializeKey) {
+        aerospike_record_cache_remove(&aerospike_obj_p->as_ref_p->record_cache, &as_key_for_get_record TSRMLS_CC);
         as_key_destroy(&as_key_for_get_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -1420,21 +1783,22 @@ PHP_METHOD(Aerospike, remove)
         goto exit;
     }
 
-    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "a|a", &key_record_p, &options_p)) {
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "z|z", &key_record_p, &options_p)) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse parameters for remove");
         DEBUG_PHP_EXT_ERROR("Unable to parse parameters for remove");
         goto exit;
     }
 
-    if (PHP_TYPE_ISNOTARR(key_record_p)) {
+    if (PHP_TYPE_ISNOTKEY(key_record_p) ||
+            ((options_p) && (PHP_TYPE_ISNOTOPTIONS(options_p)))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Input parameters (type) for remove function not proper");
         DEBUG_PHP_EXT_ERROR("Input parameters (type) for remove function not proper");
         goto exit;
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_record_p), &as_key_for_put_record, &initializeKey))) {
+    if (AEROSPIKE_OK != (status = aerospike_transform_get_rec_key(key_record_p, &as_key_for_put_record, &initializeKey TSRMLS_CC))) {
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "unable to iterate through remove key params");
         DEBUG_PHP_EXT_ERROR("Unable to iterate through remove key params");
         goto exit;
@@ -1448,10 +1812,11 @@ PHP_METHOD(Aerospike, remove)
 
 exit:
     if (initializeKey) {
+        aerospike_record_cache_remove(&aerospike_obj_p->as_ref_p->record_cache, &as_key_for_put_record TSRMLS_CC);
         as_key_destroy(&as_key_for_put_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -1501,7 +1866,7 @@ exit:
     } else {
         PHP_EXT_RESET_AS_ERR_IN_CLASS();
     }
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -1552,7 +1917,7 @@ exit:
     } else {
         PHP_EXT_RESET_AS_ERR_IN_CLASS();
     }
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -1613,7 +1978,7 @@ PHP_METHOD(Aerospike, prepend)
         goto exit;
     }
 
-    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zss|a",
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zss|z",
                 &key_record_p, &bin_name_p, &bin_name_len,
                 &prepend_str_p, &prepend_str_len, &options_p) == FAILURE) {
         status = AEROSPIKE_ERR_PARAM;
@@ -1622,18 +1987,18 @@ PHP_METHOD(Aerospike, prepend)
         goto exit;
     }
 
-    if (PHP_TYPE_ISNOTARR(key_record_p) ||
+    if (PHP_TYPE_ISNOTKEY(key_record_p) ||
             (!bin_name_p) || (!prepend_str_p) ||
-            ((options_p) && (PHP_TYPE_ISNOTARR(options_p)))) {
+            ((options_p) && (PHP_TYPE_ISNOTOPTIONS(options_p)))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Input parameters (type) for prepend function not proper");
         DEBUG_PHP_EXT_ERROR("Input parameters (type) for prepend function not proper");
         goto exit;
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_record_p),
+    if (AEROSPIKE_OK != (status = aerospike_transform_get_rec_key(key_record_p,
                     &as_key_for_get_record,
-                    &initializeKey))) {
+                    &initializeKey TSRMLS_CC))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse key parameters for prepend function");
         DEBUG_PHP_EXT_ERROR("Unable to parse key parameters for prepend function");
@@ -1656,10 +2021,11 @@ PHP_METHOD(Aerospike, prepend)
 
 exit:
     if (initializeKey) {
+        aerospike_record_cache_remove(&aerospike_obj_p->as_ref_p->record_cache, &as_key_for_get_record TSRMLS_CC);
         as_key_destroy(&as_key_for_get_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -1701,7 +2067,7 @@ PHP_METHOD(Aerospike, increment)
         goto exit;
     }
 
-    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zsl|la",
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zsl|lz",
                 &key_record_p, &bin_name_p, &bin_name_len,
                 &offset, &initial_value, &options_p) == FAILURE) {
         status = AEROSPIKE_ERR_PARAM;
@@ -1710,18 +2076,18 @@ PHP_METHOD(Aerospike, increment)
         goto exit;
     }
 
-    if (PHP_TYPE_ISNOTARR(key_record_p) ||
+    if (PHP_TYPE_ISNOTKEY(key_record_p) ||
             (!bin_name_p) ||
-            ((options_p) && (PHP_TYPE_ISNOTARR(options_p)))) {
+            ((options_p) && (PHP_TYPE_ISNOTOPTIONS(options_p)))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Input parameters (type) for increment function not proper");
         DEBUG_PHP_EXT_ERROR("Input parameters (type) for increment function not proper");
         goto exit;
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_record_p),
+    if (AEROSPIKE_OK != (status = aerospike_transform_get_rec_key(key_record_p,
                     &as_key_for_get_record,
-                    &initializeKey))) {
+                    &initializeKey TSRMLS_CC))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse key parameters for increment function");
         DEBUG_PHP_EXT_ERROR("Unable to parse key parameters for increment function");
@@ -1744,10 +2110,11 @@ PHP_METHOD(Aerospike, increment)
 
 exit:
     if (initializeKey) {
+        aerospike_record_cache_remove(&aerospike_obj_p->as_ref_p->record_cache, &as_key_for_get_record TSRMLS_CC);
         as_key_destroy(&as_key_for_get_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -1786,7 +2153,7 @@ PHP_METHOD(Aerospike, touch)
         goto exit;
     }
 
-    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zl|a",
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zl|z",
                 &key_record_p, &time_to_live, &options_p) == FAILURE) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse php parameters for touch function");
@@ -1794,17 +2161,17 @@ PHP_METHOD(Aerospike, touch)
         goto exit;
     }
 
-    if (PHP_TYPE_ISNOTARR(key_record_p) ||
-            ((options_p) && (PHP_TYPE_ISNOTARR(options_p)))) {
+    if (PHP_TYPE_ISNOTKEY(key_record_p) ||
+            ((options_p) && (PHP_TYPE_ISNOTOPTIONS(options_p)))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Input parameters (type) for touch function not proper");
         DEBUG_PHP_EXT_ERROR("Input parameters (type) for touch function not proper");
         goto exit;
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_record_p),
+    if (AEROSPIKE_OK != (status = aerospike_transform_get_rec_key(key_record_p,
                     &as_key_for_get_record,
-                    &initializeKey))) {
+                    &initializeKey TSRMLS_CC))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse key parameters for touch function");
         DEBUG_PHP_EXT_ERROR("Unable to parse key parameters for touch function");
@@ -1827,10 +2194,11 @@ PHP_METHOD(Aerospike, touch)
 
 exit:
     if (initializeKey) {
+        aerospike_record_cache_remove(&aerospike_obj_p->as_ref_p->record_cache, &as_key_for_get_record TSRMLS_CC);
         as_key_destroy(&as_key_for_get_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -1887,6 +2255,90 @@ PHP_METHOD(Aerospike, initKey)
     }
 }
 
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::prepareKey()
+ *******************************************************************************************************
+ * Prepares an immutable Aerospike\Key, which holds the key in native form
+ * with its digest computed once, and is accepted in place of a key array by
+ * the key-value and batch methods.
+ * Method prototype for PHP userland:
+ * public Aerospike\Key Aerospike::prepareKey ( string $ns, string $set, int|string $pk [,
+ *                                              boolean $digest = false ])
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, prepareKey)
+{
+    char                   *ns_p = NULL;
+    int                    ns_p_length = 0;
+    char                   *set_p = NULL;
+    int                    set_p_length = 0;
+    zval                   *pk_p ;
+    zend_bool              is_digest = false;
+    Aerospike_key_object*  key_obj_p = NULL;
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "ssz|b", &ns_p, &ns_p_length,
+                                         &set_p, &set_p_length, &pk_p, &is_digest)) {
+        php_error_docref(NULL TSRMLS_CC, E_WARNING, "Aerospike::prepareKey() expects parameter 1-3 to be a non-empty strings");
+        DEBUG_PHP_EXT_ERROR("Aerospike::prepareKey() expects parameter 1-3 to be non-empty strings");
+        RETURN_NULL();
+    }
+    if (ns_p_length == 0 || set_p_length == 0 || PHP_TYPE_ISNULL(pk_p)) {
+        php_error_docref(NULL TSRMLS_CC, E_WARNING, "Aerospike::prepareKey() expects parameter 1-3 to be a non-empty strings");
+        DEBUG_PHP_EXT_ERROR("Aerospike::prepareKey() expects parameter 1-3 to be non-empty strings");
+        RETURN_NULL();
+    }
+
+    object_init_ex(return_value, Aerospike_key_ce);
+    key_obj_p = (Aerospike_key_object *) zend_object_store_get_object(return_value TSRMLS_CC);
+
+    if (AEROSPIKE_OK != aerospike_transform_init_key_object(&key_obj_p->key,
+                ns_p, ns_p_length, set_p, set_p_length, pk_p, is_digest)) {
+        php_error_docref(NULL TSRMLS_CC, E_WARNING, "Aerospike::prepareKey() was unable to initialize the key");
+        DEBUG_PHP_EXT_ERROR("prepareKey() function returned an error");
+        zval_dtor(return_value);
+        RETURN_NULL();
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike\Key::toArray()
+ *******************************************************************************************************
+ * Returns the prepared key as an array with keys ns, set, key and digest.
+ * The key is NULL if the Aerospike\Key was prepared from a digest.
+ * Method prototype for PHP userland:
+ * public array Aerospike\Key::toArray ( void )
+ *******************************************************************************************************
+ */
+PHP_METHOD(AerospikeKey, toArray)
+{
+    as_key*                as_key_p = NULL;
+    Aerospike_key_object*  key_obj_p = (Aerospike_key_object *)
+        zend_object_store_get_object(getThis() TSRMLS_CC);
+
+    if (!aerospike_transform_is_key_object(getThis() TSRMLS_CC)) {
+        DEBUG_PHP_EXT_ERROR("Aerospike\\Key objects are created by Aerospike::prepareKey()");
+        RETURN_NULL();
+    }
+    as_key_p = &key_obj_p->key;
+
+    array_init(return_value);
+    add_assoc_string(return_value, PHP_AS_KEY_DEFINE_FOR_NS, as_key_p->ns, 1);
+    add_assoc_string(return_value, PHP_AS_KEY_DEFINE_FOR_SET, as_key_p->set, 1);
+    if (!as_key_p->valuep) {
+        add_assoc_null(return_value, PHP_AS_KEY_DEFINE_FOR_KEY);
+    } else if (AS_STRING == as_val_type((as_val *) as_key_p->valuep)) {
+        add_assoc_string(return_value, PHP_AS_KEY_DEFINE_FOR_KEY,
+                as_string_get(&as_key_p->value.string), 1);
+    } else {
+        add_assoc_long(return_value, PHP_AS_KEY_DEFINE_FOR_KEY,
+                as_integer_get(&as_key_p->value.integer));
+    }
+    add_assoc_stringl(return_value, PHP_AS_KEY_DEFINE_FOR_DIGEST,
+            (char *) as_key_p->digest.value, AS_DIGEST_VALUE_SIZE, 1);
+}
+
 /*
  *******************************************************************************************************
  * PHP Method:  Aerospike::setDeserializer
@@ -1999,22 +2451,24 @@ PHP_METHOD(Aerospike, removeBin)
         goto exit;
     }
 
-    if (PHP_TYPE_ISNOTARR(key_record_p) || PHP_TYPE_ISNOTARR(bins_p)) {
+    if (PHP_TYPE_ISNOTKEY(key_record_p) || PHP_TYPE_ISNOTARR(bins_p)) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Input parameters (type) for removeBin function not proper");
         DEBUG_PHP_EXT_ERROR("Input parameters (type) for removeBin function not proper");
         goto exit;
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_record_p),
+    if (AEROSPIKE_OK != (status = aerospike_transform_get_rec_key(key_record_p,
                     &as_key_for_put_record,
-                    &initializeKey))) {
+                    &initializeKey TSRMLS_CC))) {
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse key parameters for removeBin function");
         DEBUG_PHP_EXT_ERROR("Unable to parse key parameters for removeBin function");
         goto exit;
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_record_operations_remove_bin(aerospike_obj_p, &as_key_for_put_record, bins_p, &error, options_p))) {
+    status = aerospike_record_operations_remove_bin(aerospike_obj_p, &as_key_for_put_record, bins_p, &error, options_p);
+    aerospike_record_cache_remove(&aerospike_obj_p->as_ref_p->record_cache, &as_key_for_put_record TSRMLS_CC);
+    if (AEROSPIKE_OK != status) {
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Unable to remove bin");
         DEBUG_PHP_EXT_ERROR("Unable to remove bin");
         goto exit;
@@ -2022,7 +2476,7 @@ PHP_METHOD(Aerospike, removeBin)
 
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -2128,9 +2582,112 @@ PHP_METHOD(Aerospike, predicateBetween)
 
 /*
  *******************************************************************************************************
- * PHP Method:  Aerospike::query()
+ * PHP Method:  Aerospike::predicateIn()
  *******************************************************************************************************
- * Queries a secondary index on a set in the Aerospike database.
+ * Helper method for building an IN WHERE predicate.
+ * Method prototype for PHP userland:
+ * public array Aerospike::predicateIn ( string $bin, array $vals )
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, predicateIn)
+{
+    char                   *bin_name_p  =  NULL;
+    int                    bin_name_len = 0;
+    zval                   *vals_p = NULL;
+    zval                   **val_pp = NULL;
+    zval                   *vals_arr = NULL;
+    HashPosition           pos;
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "sa",
+                &bin_name_p, &bin_name_len, &vals_p)) {
+        DEBUG_PHP_EXT_ERROR("Invalid parameters for predicateIn");
+        RETURN_NULL();
+    }
+
+    if (bin_name_len == 0) {
+        DEBUG_PHP_EXT_ERROR("Aerospike::predicateIn() expects parameter 1 to be a non-empty string.");
+        RETURN_NULL();
+    }
+
+    if (zend_hash_num_elements(Z_ARRVAL_P(vals_p)) == 0) {
+        DEBUG_PHP_EXT_ERROR("Aerospike::predicateIn() expects parameter 2 to be a non-empty array.");
+        RETURN_NULL();
+    }
+
+    MAKE_STD_ZVAL(vals_arr);
+    array_init_size(vals_arr, zend_hash_num_elements(Z_ARRVAL_P(vals_p)));
+    foreach_hashtable(Z_ARRVAL_P(vals_p), pos, val_pp) {
+        switch(Z_TYPE_PP(val_pp)) {
+            case IS_LONG:
+                add_next_index_long(vals_arr, Z_LVAL_PP(val_pp));
+                break;
+            case IS_STRING:
+                add_next_index_stringl(vals_arr, Z_STRVAL_PP(val_pp),
+                        Z_STRLEN_PP(val_pp), 1);
+                break;
+            default:
+                zval_ptr_dtor(&vals_arr);
+                DEBUG_PHP_EXT_ERROR("Aerospike::predicateIn() expects parameter 2 to contain only strings or integers.");
+                RETURN_NULL();
+        }
+    }
+
+    array_init(return_value);
+    add_assoc_stringl(return_value, BIN, bin_name_p, bin_name_len, 1);
+    add_assoc_stringl(return_value, OP, "IN", sizeof("IN") - 1, 1);
+    add_assoc_zval(return_value, VAL, vals_arr);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::predicateContains()
+ *******************************************************************************************************
+ * Helper method for building a CONTAINS WHERE predicate, matching list bins
+ * holding the value or map bins holding it as a key.
+ * Method prototype for PHP userland:
+ * public array Aerospike::predicateContains ( string $bin, int|string $val )
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, predicateContains)
+{
+    char                   *bin_name_p  =  NULL;
+    int                    bin_name_len = 0;
+    zval                   *val_p;
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "sz",
+                &bin_name_p, &bin_name_len, &val_p)) {
+        DEBUG_PHP_EXT_ERROR("Invalid parameters for predicateContains");
+        RETURN_NULL();
+    }
+
+    if (bin_name_len == 0) {
+        DEBUG_PHP_EXT_ERROR("Aerospike::predicateContains() expects parameter 1 to be a non-empty string.");
+        RETURN_NULL();
+    }
+
+    array_init(return_value);
+    add_assoc_stringl(return_value, BIN, bin_name_p, bin_name_len, 1);
+    add_assoc_stringl(return_value, OP, "CONTAINS", sizeof("CONTAINS") - 1, 1);
+
+    switch(Z_TYPE_P(val_p)) {
+        case IS_LONG:
+            add_assoc_long(return_value, VAL, Z_LVAL_P(val_p));
+            break;
+        case IS_STRING:
+            add_assoc_stringl(return_value, VAL, Z_STRVAL_P(val_p), Z_STRLEN_P(val_p), 1);
+            break;
+        default:
+            zval_dtor(return_value);
+            DEBUG_PHP_EXT_ERROR("Aerospike::predicateContains() expects parameter 2 to be a string or an integer.");
+            RETURN_NULL();
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::query()
+ *******************************************************************************************************
+ * Queries a secondary index on a set in the Aerospike database.
  * Method prototype for PHP userland:
  * public int Aerospike::query ( string $ns, string $set, array $where,
  * callback $record_cb [, array $select [, array $options ]] )
@@ -2140,9 +2697,13 @@ PHP_METHOD(Aerospike, predicateBetween)
  * @param where             The predicate for the query, conforming to one of the following:
  *                          Associative Array:
  *                              bin => bin name
- *                              op => one of Aerospike::OP_EQ, Aerospike::OP_BETWEEN
- *                              val => scalar integer/string for OP_EQ or array($min, $max) for
- *                                     OP_BETWEEN
+ *                              op => one of Aerospike::OP_EQ, Aerospike::OP_BETWEEN,
+ *                                    Aerospike::OP_IN
+ *                              val => scalar integer/string for OP_EQ, array($min, $max) for
+ *                                     OP_BETWEEN or an array of values for OP_IN
+ *                          or a list of such predicates, the first one run against the
+ *                          secondary index and the others (which may also use
+ *                          Aerospike::OP_CONTAINS) filtering the records it returns.
  * @param record_cb         A callback function invoked for each record streaming back from
  *                          the server.
  * @param select            An array of bin names to be returned.
@@ -2165,6 +2726,7 @@ PHP_METHOD(Aerospike, query)
     zval*                   bins_p = NULL;
     HashTable*              bins_ht_p = NULL;
     HashTable*              predicate_ht_p = NULL;
+    aerospike_sindex_cache* sindex_cache_p = NULL;
     Aerospike_object*       aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
 
     PHP_EXT_SET_AS_ERR(&error, DEFAULT_ERRORNO, DEFAULT_ERROR);
@@ -2205,13 +2767,20 @@ PHP_METHOD(Aerospike, query)
     user_func.fci_p =  &fci;
     user_func.fcc_p = &fcc;
     user_func.obj = aerospike_obj_p;
+    user_func.max_records = 0;
+    user_func.records_count = 0;
+    user_func.hidden_bins_pp = NULL;
+    user_func.hidden_bins_count = 0;
 
     bins_ht_p = (bins_p ? Z_ARRVAL_P(bins_p) : NULL);
     predicate_ht_p = (predicate_p ? Z_ARRVAL_P(predicate_p) : NULL);
+    if (SINDEX_CACHE_TTL_PHP_INI > 0) {
+        sindex_cache_p = &aerospike_obj_p->as_ref_p->sindex_cache;
+    }
 
     if (AEROSPIKE_OK !=
             (status = aerospike_query_run(aerospike_obj_p->as_ref_p->as_p,
-                                          &error, ns_p, set_p, &user_func,
+                                          &error, sindex_cache_p, ns_p, set_p, &user_func,
                                           bins_ht_p, predicate_ht_p,
                                           options_p TSRMLS_CC))) {
         DEBUG_PHP_EXT_ERROR("scan returned an error");
@@ -2220,7 +2789,7 @@ PHP_METHOD(Aerospike, query)
 
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -2368,7 +2937,107 @@ PHP_METHOD(Aerospike, aggregate)
     }
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::reduce()
+ *******************************************************************************************************
+ * Reduces the records matching a query with a native reducer, without a UDF.
+ * Method prototype for PHP userland:
+ * public int Aerospike::reduce ( string $ns, string $set, array $where,
+ *      array $reducer, mixed &$returned [, array $options ] )
+ *
+ * @param ns                The namespace.
+ * @param set               The set to be queried.
+ * @param where             The Aerospike::predicate array.
+ * @param reducer           An array describing the reducer, with the keys
+ *                          'type' (one of the Aerospike::REDUCE_* constants),
+ *                          'bin', 'k' for Aerospike::REDUCE_TOP_K and
+ *                          'group_by' for Aerospike::REDUCE_GROUP_BY_SUM.
+ * @param returned          The reduced value to be populated by this method.
+ * @param options           Options including Aerospike::OPT_READ_TIMEOUT.
+ * @return                  Returns an integer status code. Compare to the Aerospike class status
+ *                          constants.  When non-zero the Aerospike::error() and
+ *                          Aerospike::errorno() methods can be used.
+ *
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, reduce)
+{
+    as_status               status = AEROSPIKE_OK;
+    as_error                error;
+    zval*                   namespace_zval_p = NULL;
+    zval*                   set_zval_p = NULL;
+    zval*                   predicate_p = NULL;
+    zval*                   reducer_p = NULL;
+    zval*                   returned_p = NULL;
+    zval*                   options_p = NULL;
+    Aerospike_object*       aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR,
+                "reduce: Connection not established");
+        DEBUG_PHP_EXT_ERROR("reduce: Connection not established");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC,
+                "zzzzz|z", &namespace_zval_p, &set_zval_p, &predicate_p,
+                &reducer_p, &returned_p, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for reduce()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for reduce()");
+        goto exit;
+    }
+
+    if (((options_p) && (PHP_TYPE_ISNOTARR(options_p)) &&
+                (PHP_TYPE_ISNOTNULL(options_p))) ||
+            (PHP_TYPE_ISNOTSTR(namespace_zval_p)) ||
+            (PHP_TYPE_ISNOTSTR(set_zval_p)) ||
+            (PHP_TYPE_ISNOTARR(predicate_p)) ||
+            (PHP_TYPE_ISNOTARR(reducer_p))) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Input parameters (type) for reduce function are not proper");
+        DEBUG_PHP_EXT_ERROR("Input parameters (type) for reduce function are not proper");
+        goto exit;
+    }
+
+    if (options_p && PHP_TYPE_ISNULL(options_p)) {
+        options_p = NULL;
+    }
+
+    if (Z_STRLEN_P(namespace_zval_p) == 0 || Z_STRLEN_P(set_zval_p) == 0) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Expects parameter 1 and 2 to be non-empty strings");
+        goto exit;
+    }
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_query_reduce(aerospike_obj_p->as_ref_p->as_p,
+                                             &error, Z_STRVAL_P(namespace_zval_p),
+                                             Z_STRVAL_P(set_zval_p),
+                                             Z_ARRVAL_P(predicate_p),
+                                             Z_ARRVAL_P(reducer_p), returned_p,
+                                             options_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("reduce returned an error");
+        goto exit;
+    }
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 /*
@@ -2457,20 +3126,136 @@ PHP_METHOD(Aerospike, scan)
     user_func.fci_p =  &fci;
     user_func.fcc_p = &fcc;
     user_func.obj = aerospike_obj_p;
+    user_func.max_records = 0;
+    user_func.records_count = 0;
+    user_func.hidden_bins_pp = NULL;
+    user_func.hidden_bins_count = 0;
 
     bins_ht_p = (bins_p ? Z_ARRVAL_P(bins_p) : NULL);
 
     if (AEROSPIKE_OK !=
             (status = aerospike_scan_run(aerospike_obj_p->as_ref_p->as_p,
                                      &error, ns_p, set_p, &user_func,
-                                     bins_ht_p, options_p TSRMLS_CC))) {
+                                     bins_ht_p, options_p, NULL TSRMLS_CC))) {
         DEBUG_PHP_EXT_ERROR("scan returned an error");
         goto exit;
     }
 
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::scanNodes()
+ *******************************************************************************************************
+ * Scans a set in the Aerospike database node by node, resumably.
+ * Method prototype for PHP userland:
+ * public int Aerospike::scanNodes ( string $ns, string $set, array &$cursor,
+ *      callback $record_cb [, array $select [, array $options ]] )
+ *
+ * @param ns                The namespace
+ * @param set               The set to be scanned
+ * @param cursor            An empty array to start the scan, or the cursor
+ *                          left by a previous call to resume it. It is
+ *                          updated in place with the nodes scanned to their
+ *                          end.
+ * @param record_cb         A callback function invoked for each record streaming back from
+ *                          the server.
+ * @param bins              An array of bin names to be returned.
+ * @param options           Options including
+ *                          Aerospike::OPT_READ_TIMEOUT
+ *                          Aerospike::OPT_SCAN_PRIORITY
+ *                          Aerospike::OPT_SCAN_PERCENTAGE of the records in the set to return
+ *                          Aerospike::OPT_SCAN_NOBINS whether to not retrieve bins for
+ *                          the records
+ *                          Aerospike::OPT_SCAN_SHARD the shard of the nodes to scan
+ *                          Aerospike::OPT_MAX_RECORDS the number of records after
+ *                          which no new node is started
+ * @return                  Returns an integer status code.  Compare to the Aerospike class status
+ *                          constants.  When non-zero the Aerospike::error() and
+ *                          Aerospike::errorno() methods can be used.
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, scanNodes)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+    char                   *ns_p = NULL;
+    int                    ns_p_length = 0;
+    char                   *set_p = NULL;
+    int                    set_p_length = 0;
+    zval                   *cursor_p = NULL;
+    zend_fcall_info        fci = empty_fcall_info;
+    zend_fcall_info_cache  fcc = empty_fcall_info_cache;
+    zval                   *bins_p = NULL;
+    zval                   *options_p = NULL;
+    HashTable*             bins_ht_p = NULL;
+    userland_callback      user_func;
+
+    as_error_init(&error);
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        DEBUG_PHP_EXT_ERROR("Aerospike::scanNodes() has no valid aerospike object");
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Aerospike::scanNodes() has no valid aerospike object");
+        goto exit;
+    }
+
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        DEBUG_PHP_EXT_ERROR("Aerospike::scanNodes() has no connection to the database");
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER, "Aerospike::scanNodes() has no connection to the database");
+        goto exit;
+    }
+
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "sszf|a!a!",
+        &ns_p, &ns_p_length, &set_p, &set_p_length, &cursor_p,
+        &fci, &fcc, &bins_p, &options_p) == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        DEBUG_PHP_EXT_ERROR("Aerospike::scanNodes() unable to parse parameters");
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Aerospike::scanNodes() unable to parse parameters");
+        goto exit;
+    }
+
+    if (ns_p_length == 0 || set_p_length == 0) {
+        status = AEROSPIKE_ERR_PARAM;
+        DEBUG_PHP_EXT_ERROR("Aerospike::scanNodes() expects parameter 1 & 2 to be a non-empty strings.");
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Aerospike::scanNodes() expects parameter 1 & 2 to be a non-empty strings.");
+        goto exit;
+    }
+
+    if (PHP_TYPE_ISNOTARR(cursor_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        DEBUG_PHP_EXT_ERROR("Aerospike::scanNodes() expects parameter 3 to be an array.");
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Aerospike::scanNodes() expects parameter 3 to be an array.");
+        goto exit;
+    }
+
+    user_func.fci_p =  &fci;
+    user_func.fcc_p = &fcc;
+    user_func.obj = aerospike_obj_p;
+    user_func.max_records = 0;
+    user_func.records_count = 0;
+    user_func.hidden_bins_pp = NULL;
+    user_func.hidden_bins_count = 0;
+
+    bins_ht_p = (bins_p ? Z_ARRVAL_P(bins_p) : NULL);
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_scan_run(aerospike_obj_p->as_ref_p->as_p,
+                                     &error, ns_p, set_p, &user_func,
+                                     bins_ht_p, options_p, cursor_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("scanNodes returned an error");
+        goto exit;
+    }
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -2608,7 +3393,7 @@ PHP_METHOD(Aerospike, scanApply)
     }
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -2697,39 +3482,49 @@ PHP_METHOD(Aerospike, scanInfo)
     }
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 /*
  *******************************************************************************************************
- *  User Defined Function (UDF) APIs:
- *******************************************************************************************************
- */
-
-/*
- *******************************************************************************************************
- * PHP Method : Aerospike::register()
+ * PHP Method:  Aerospike::queryApplyEach()
  *******************************************************************************************************
- * Registers a UDF module with the Aerospike DB.
+ * Applies a record UDF to each of the records matching a query, one record at
+ * a time from the client, as the 3.0 C client has no background query.
  * Method prototype for PHP userland:
- * public int Aerospike::register ( string $path, string $module [, int
- *                                  $language = Aerospike::UDF_TYPE_LUA [, array
- *                                  $options]] )
+ * public int Aerospike::queryApplyEach ( string $ns, string $set, array $where,
+ *      string $module, string $function, array $args, int &$applied
+ *      [, array $options ] )
+ *
+ * @param ns                The namespace.
+ * @param set               The set to be queried.
+ * @param where             The Aerospike::predicate array.
+ * @param module            The name of the UDF module registered with the cluster.
+ * @param function          The name of the record UDF to be applied.
+ * @param args              An array of arguments for the UDF.
+ * @param applied           The number of records the UDF was applied to.
+ * @param options           Options including Aerospike::OPT_READ_TIMEOUT,
+ *                          Aerospike::OPT_WRITE_TIMEOUT and
+ *                          Aerospike::OPT_SERIALIZER.
+ * @return                  Returns an integer status code. Compare to the Aerospike class status
+ *                          constants.  When non-zero the Aerospike::error() and
+ *                          Aerospike::errorno() methods can be used.
+ *
  *******************************************************************************************************
  */
-PHP_METHOD(Aerospike, register)
+PHP_METHOD(Aerospike, queryApplyEach)
 {
-    as_status              status = AEROSPIKE_OK;
-    as_error               error;
-    char*                  path_p = NULL;
-    char*                  module_p = NULL;
-    long                   path_len = 0;
-    long                   module_len = 0;
-    long                   language = AS_UDF_TYPE_LUA;
-    zval*                  module_zval_p = NULL;
-    zval*                  path_zval_p = NULL;
-    zval*                  options_p = NULL;
-    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+    as_status               status = AEROSPIKE_OK;
+    as_error                error;
+    zval*                   namespace_zval_p = NULL;
+    zval*                   set_zval_p = NULL;
+    zval*                   predicate_p = NULL;
+    zval*                   module_zval_p = NULL;
+    zval*                   function_zval_p = NULL;
+    zval*                   args_p = NULL;
+    zval*                   applied_p = NULL;
+    zval*                   options_p = NULL;
+    Aerospike_object*       aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
 
     if (!aerospike_obj_p) {
         status = AEROSPIKE_ERR;
@@ -2741,14 +3536,411 @@ PHP_METHOD(Aerospike, register)
     if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
         status = AEROSPIKE_ERR_CLUSTER;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
-                "register: connection not established");
-        DEBUG_PHP_EXT_ERROR("register: connection not established");
+                "queryApplyEach: Connection not established");
+        DEBUG_PHP_EXT_ERROR("queryApplyEach: Connection not established");
         goto exit;
     }
 
-    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zz|la",
-                &path_zval_p, &module_zval_p, &language, &options_p)) {
-        status = AEROSPIKE_ERR_PARAM;
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC,
+                "zzzzzzz|z", &namespace_zval_p, &set_zval_p, &predicate_p,
+                &module_zval_p, &function_zval_p, &args_p, &applied_p,
+                &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for queryApplyEach()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for queryApplyEach()");
+        goto exit;
+    }
+
+    if (((args_p) && (PHP_TYPE_ISNOTARR(args_p)) &&
+                (PHP_TYPE_ISNOTNULL(args_p))) || ((options_p) &&
+                (PHP_TYPE_ISNOTARR(options_p)) &&
+                (PHP_TYPE_ISNOTNULL(options_p))) ||
+            (PHP_TYPE_ISNOTSTR(namespace_zval_p)) ||
+            (PHP_TYPE_ISNOTSTR(set_zval_p)) ||
+            (PHP_TYPE_ISNOTARR(predicate_p)) ||
+            (PHP_TYPE_ISNOTSTR(module_zval_p)) ||
+            (PHP_TYPE_ISNOTSTR(function_zval_p))) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Input parameters (type) for queryApplyEach function are not proper");
+        DEBUG_PHP_EXT_ERROR("Input parameters (type) for queryApplyEach function are not proper");
+        goto exit;
+    }
+
+    if (args_p && PHP_TYPE_ISNULL(args_p)) {
+        args_p = NULL;
+    }
+
+    if (options_p && PHP_TYPE_ISNULL(options_p)) {
+        options_p = NULL;
+    }
+
+    if (Z_STRLEN_P(namespace_zval_p) == 0 || Z_STRLEN_P(set_zval_p) == 0 ||
+            Z_STRLEN_P(module_zval_p) == 0 || Z_STRLEN_P(function_zval_p) == 0) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Expects parameter 1,2,4 and 5 to be non-empty strings");
+        goto exit;
+    }
+
+    zval_dtor(applied_p);
+    ZVAL_LONG(applied_p, 0);
+    if (AEROSPIKE_OK !=
+            (status = aerospike_query_apply_each(aerospike_obj_p->as_ref_p->as_p,
+                                                 &aerospike_obj_p->as_ref_p->record_cache,
+                                                 &error, Z_STRVAL_P(namespace_zval_p),
+                                                 Z_STRVAL_P(set_zval_p),
+                                                 Z_ARRVAL_P(predicate_p),
+                                                 Z_STRVAL_P(module_zval_p),
+                                                 Z_STRVAL_P(function_zval_p),
+                                                 &args_p, applied_p,
+                                                 options_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("queryApplyEach returned an error");
+        goto exit;
+    }
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::jobInfo()
+ *******************************************************************************************************
+ * Checks the progress of a scan or query job running on the cluster.
+ * Method prototype for PHP userland:
+ * public int Aerospike::jobInfo ( string $module, integer $job_id, array &$info
+ *                                 [, array $options ] )
+ *
+ * @param module            One of Aerospike::JOB_SCAN and Aerospike::JOB_QUERY.
+ * @param job_id            The job id, such as the scan id of scanApply().
+ * @param info              The status of the job returned as an associative
+ *                          array with the keys 'status' (one of the
+ *                          Aerospike::SCAN_STATUS_* constants), 'progress_pct'
+ *                          and 'nodes', the job as reported by each node.
+ * @param options           Options including Aerospike::OPT_READ_TIMEOUT.
+ * @return                  Returns an integer status code. Compare to the Aerospike class status
+ *                          constants.  When non-zero the Aerospike::error() and
+ *                          Aerospike::errorno() methods can be used.
+ *
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, jobInfo)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    char*                  module_p = NULL;
+    int                    module_len = 0;
+    long                   job_id = 0;
+    zval*                  info_p = NULL;
+    zval*                  options_p = NULL;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
+                "jobInfo: Connection not established");
+        DEBUG_PHP_EXT_ERROR("jobInfo: Connection not established");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "slz|a!",
+                &module_p, &module_len, &job_id, &info_p, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for jobInfo()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for jobInfo()");
+        goto exit;
+    }
+
+    zval_dtor(info_p);
+    array_init(info_p);
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_info_job_get(aerospike_obj_p->as_ref_p->as_p,
+                                             &error, module_p, (uint64_t) job_id,
+                                             info_p, options_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("jobInfo returned an error");
+        goto exit;
+    }
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::jobsList()
+ *******************************************************************************************************
+ * Lists the scan and query jobs running or recently finished on the cluster.
+ * Method prototype for PHP userland:
+ * public int Aerospike::jobsList ( array &$jobs [, string $module [, array
+ *                                  $options ]] )
+ *
+ * @param jobs              The jobs of each node, keyed by node ID.
+ * @param module            One of Aerospike::JOB_SCAN and Aerospike::JOB_QUERY,
+ *                          or NULL for both.
+ * @param options           Options including Aerospike::OPT_READ_TIMEOUT.
+ * @return                  Returns an integer status code. Compare to the Aerospike class status
+ *                          constants.  When non-zero the Aerospike::error() and
+ *                          Aerospike::errorno() methods can be used.
+ *
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, jobsList)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    zval*                  jobs_p = NULL;
+    char*                  module_p = NULL;
+    int                    module_len = 0;
+    zval*                  options_p = NULL;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
+                "jobsList: Connection not established");
+        DEBUG_PHP_EXT_ERROR("jobsList: Connection not established");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "z|s!a!",
+                &jobs_p, &module_p, &module_len, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for jobsList()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for jobsList()");
+        goto exit;
+    }
+
+    zval_dtor(jobs_p);
+    array_init(jobs_p);
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_info_jobs_list(aerospike_obj_p->as_ref_p->as_p,
+                                               &error, module_p, 0, jobs_p,
+                                               options_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("jobsList returned an error");
+        goto exit;
+    }
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::jobAbort()
+ *******************************************************************************************************
+ * Aborts a scan or query job on every node of the cluster.
+ * Method prototype for PHP userland:
+ * public int Aerospike::jobAbort ( string $module, integer $job_id [, array
+ *                                  $options ] )
+ *
+ * @param module            One of Aerospike::JOB_SCAN and Aerospike::JOB_QUERY.
+ * @param job_id            The job id.
+ * @param options           Options including Aerospike::OPT_READ_TIMEOUT.
+ * @return                  Returns an integer status code. Compare to the Aerospike class status
+ *                          constants.  When non-zero the Aerospike::error() and
+ *                          Aerospike::errorno() methods can be used.
+ *
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, jobAbort)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    char*                  module_p = NULL;
+    int                    module_len = 0;
+    long                   job_id = 0;
+    zval*                  options_p = NULL;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
+                "jobAbort: Connection not established");
+        DEBUG_PHP_EXT_ERROR("jobAbort: Connection not established");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "sl|a!",
+                &module_p, &module_len, &job_id, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for jobAbort()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for jobAbort()");
+        goto exit;
+    }
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_info_job_command(aerospike_obj_p->as_ref_p->as_p,
+                                                 &error, module_p, (uint64_t) job_id,
+                                                 "kill-job", options_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("jobAbort returned an error");
+        goto exit;
+    }
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::jobSetPriority()
+ *******************************************************************************************************
+ * Changes the priority of a scan or query job on every node of the cluster,
+ * to throttle it.
+ * Method prototype for PHP userland:
+ * public int Aerospike::jobSetPriority ( string $module, integer $job_id,
+ *                                        integer $priority [, array $options ] )
+ *
+ * @param module            One of Aerospike::JOB_SCAN and Aerospike::JOB_QUERY.
+ * @param job_id            The job id.
+ * @param priority          One of Aerospike::SCAN_PRORITY_LOW,
+ *                          Aerospike::SCAN_PRIORITY_MEDIUM and
+ *                          Aerospike::SCAN_PRIORITY_HIGH.
+ * @param options           Options including Aerospike::OPT_READ_TIMEOUT.
+ * @return                  Returns an integer status code. Compare to the Aerospike class status
+ *                          constants.  When non-zero the Aerospike::error() and
+ *                          Aerospike::errorno() methods can be used.
+ *
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, jobSetPriority)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    char*                  module_p = NULL;
+    int                    module_len = 0;
+    long                   job_id = 0;
+    long                   priority = 0;
+    char                   command[32];
+    zval*                  options_p = NULL;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
+                "jobSetPriority: Connection not established");
+        DEBUG_PHP_EXT_ERROR("jobSetPriority: Connection not established");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "sll|a!",
+                &module_p, &module_len, &job_id, &priority, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for jobSetPriority()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for jobSetPriority()");
+        goto exit;
+    }
+
+    if ((priority < AS_SCAN_PRIORITY_LOW) || (priority > AS_SCAN_PRIORITY_HIGH)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Priority must be one of the Aerospike::SCAN_PRIORITY_* constants, except auto");
+        DEBUG_PHP_EXT_ERROR("Priority must be one of the Aerospike::SCAN_PRIORITY_* constants, except auto");
+        goto exit;
+    }
+
+    snprintf(command, sizeof(command), "set-priority;value=%ld", priority);
+    if (AEROSPIKE_OK !=
+            (status = aerospike_info_job_command(aerospike_obj_p->as_ref_p->as_p,
+                                                 &error, module_p, (uint64_t) job_id,
+                                                 command, options_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("jobSetPriority returned an error");
+        goto exit;
+    }
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+
+/*
+ *******************************************************************************************************
+ *  User Defined Function (UDF) APIs:
+ *******************************************************************************************************
+ */
+
+/*
+ *******************************************************************************************************
+ * PHP Method : Aerospike::register()
+ *******************************************************************************************************
+ * Registers a UDF module with the Aerospike DB.
+ * Method prototype for PHP userland:
+ * public int Aerospike::register ( string $path, string $module [, int
+ *                                  $language = Aerospike::UDF_TYPE_LUA [, array
+ *                                  $options]] )
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, register)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    char*                  path_p = NULL;
+    char*                  module_p = NULL;
+    long                   path_len = 0;
+    long                   module_len = 0;
+    long                   language = AS_UDF_TYPE_LUA;
+    zval*                  module_zval_p = NULL;
+    zval*                  path_zval_p = NULL;
+    zval*                  options_p = NULL;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
+                "register: connection not established");
+        DEBUG_PHP_EXT_ERROR("register: connection not established");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zz|la",
+                &path_zval_p, &module_zval_p, &language, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
                 "Unable to parse parameters for register function");
         DEBUG_PHP_EXT_ERROR("Unable to parse parameters for register function");
@@ -2779,13 +3971,104 @@ PHP_METHOD(Aerospike, register)
 
     if (AEROSPIKE_OK !=
             (status = aerospike_udf_register(aerospike_obj_p, &error, path_p,
-                                             module_p, language, options_p))) {
+                                             module_p, language, options_p,
+                                             true, NULL))) {
         DEBUG_PHP_EXT_ERROR("register function returned an error");
         goto exit;
     }
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method : Aerospike::registerAsync()
+ *******************************************************************************************************
+ * Registers a UDF module with the Aerospike DB without waiting for every node
+ * of the cluster to have it.
+ * Method prototype for PHP userland:
+ * public int Aerospike::registerAsync ( string $path, string $module,
+ *                                       array &$task [, int $language =
+ *                                       Aerospike::UDF_TYPE_LUA [, array
+ *                                       $options]] )
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, registerAsync)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    char*                  path_p = NULL;
+    char*                  module_p = NULL;
+    long                   path_len = 0;
+    long                   module_len = 0;
+    long                   language = AS_UDF_TYPE_LUA;
+    zval*                  module_zval_p = NULL;
+    zval*                  path_zval_p = NULL;
+    zval*                  task_p = NULL;
+    zval*                  options_p = NULL;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
+                "registerAsync: connection not established");
+        DEBUG_PHP_EXT_ERROR("registerAsync: connection not established");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zzz|la",
+                &path_zval_p, &module_zval_p, &task_p, &language, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for registerAsync function");
+        DEBUG_PHP_EXT_ERROR("Unable to parse parameters for registerAsync function");
+        goto exit;
+    }
+
+    if ((PHP_TYPE_ISNOTSTR(module_zval_p)) ||
+            (PHP_TYPE_ISNOTSTR(path_zval_p))) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Input parameters (type) for registerAsync function not proper");
+        DEBUG_PHP_EXT_ERROR("Input parameters (type) for registerAsync function not proper");
+        goto exit;
+    }
+
+    module_p = Z_STRVAL_P(module_zval_p);
+    path_p = Z_STRVAL_P(path_zval_p);
+
+    module_len = Z_STRLEN_P(module_zval_p);
+    path_len = Z_STRLEN_P(path_zval_p);
+
+    if (path_len == 0 || module_len == 0) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Expects parameter 1 & 2 to be non-empty strings");
+        goto exit;
+    }
+
+    zval_dtor(task_p);
+    array_init(task_p);
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_udf_register(aerospike_obj_p, &error, path_p,
+                                             module_p, language, options_p,
+                                             false, task_p))) {
+        DEBUG_PHP_EXT_ERROR("registerAsync function returned an error");
+        goto exit;
+    }
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -2856,7 +4139,7 @@ PHP_METHOD(Aerospike, deregister)
     }
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -2895,71 +4178,237 @@ PHP_METHOD(Aerospike, apply)
         goto exit;
     }
 
-    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
-        status = AEROSPIKE_ERR_CLUSTER;
-        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
-                "apply: Connection not established");
-        DEBUG_PHP_EXT_ERROR("apply: Connection not established");
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
+                "apply: Connection not established");
+        DEBUG_PHP_EXT_ERROR("apply: Connection not established");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zzz|zzz",
+                &key_record_p, &module_zval_p, &function_zval_p, &args_p,
+                &return_value_of_udf_p, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for apply()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for apply()");
+        goto exit;
+    }
+
+    if (PHP_TYPE_ISNOTKEY(key_record_p) ||
+            ((args_p) &&
+             (PHP_TYPE_ISNOTARR(args_p)) &&
+             (PHP_TYPE_ISNOTNULL(args_p))) ||
+            ((options_p) &&
+             (PHP_TYPE_ISNOTOPTIONS(options_p)) &&
+             (PHP_TYPE_ISNOTNULL(options_p))) ||
+            (PHP_TYPE_ISNOTSTR(module_zval_p)) ||
+            (PHP_TYPE_ISNOTSTR(function_zval_p))) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Input parameters (type) for apply function are not proper");
+        DEBUG_PHP_EXT_ERROR("Input parameters (type) for apply function are not proper");
+        goto exit;
+    }
+
+    if (args_p && PHP_TYPE_ISNULL(args_p)) {
+        args_p = NULL;
+    }
+
+    if (options_p && PHP_TYPE_ISNULL(options_p)) {
+        options_p = NULL;
+    }
+    module_p = Z_STRVAL_P(module_zval_p);
+    function_name_p = Z_STRVAL_P(function_zval_p);
+
+    module_len = Z_STRLEN_P(module_zval_p);
+    function_len = Z_STRLEN_P(function_zval_p);
+
+    if (module_len == 0 || function_len == 0) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Expects parameter 2 and 3 to be non-empty strings");
+        goto exit;
+    }
+
+    if ((options_p) && (PHP_TYPE_ISNOTOPTIONS(options_p))) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Input parameters (type) for apply function not proper");
+        DEBUG_PHP_EXT_ERROR("Input parameters (type) for apply function not proper");
+    }
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_transform_get_rec_key(key_record_p,
+                                                      &as_key_for_apply_udf,
+                                                      &initializeKey TSRMLS_CC))) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to iterate through apply key params");
+        DEBUG_PHP_EXT_ERROR("Unable to iterate through apply key params");
+        goto exit;
+    }
+
+    if (return_value_of_udf_p) {
+        zval_dtor(return_value_of_udf_p);
+    } else {
+        MAKE_STD_ZVAL(return_value_of_udf_p);
+    }
+    array_init(return_value_of_udf_p);
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_udf_apply(aerospike_obj_p, 
+                                          &as_key_for_apply_udf, &error,
+                                          module_p, function_name_p, &args_p,
+                                          return_value_of_udf_p, options_p))) {
+        DEBUG_PHP_EXT_ERROR("apply function returned an error");
+        goto exit;
+    }
+exit:
+    if (initializeKey) {
+        aerospike_record_cache_remove(&aerospike_obj_p->as_ref_p->record_cache, &as_key_for_apply_udf TSRMLS_CC);
+        as_key_destroy(&as_key_for_apply_udf);
+    }
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method : Aerospike::prepareApply()
+ *******************************************************************************************************
+ * Prepares a UDF call to be applied repeatedly to records. The module,
+ * function and apply policy are resolved once, and the buffers into which the
+ * arguments are marshalled are kept by the returned Aerospike\UdfCall object.
+ * Method prototype for PHP userland:
+ * public Aerospike\UdfCall Aerospike::prepareApply ( string $module,
+ *                               string $function [, array $options ] )
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, prepareApply)
+{
+    as_status                   status = AEROSPIKE_OK;
+    as_error                    error;
+    char*                       module_p = NULL;
+    int                         module_len = 0;
+    char*                       function_p = NULL;
+    int                         function_len = 0;
+    zval*                       options_p = NULL;
+    as_policy_apply             apply_policy;
+    Aerospike_udf_call_object*  udf_call_p = NULL;
+    Aerospike_object*           aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    PHP_EXT_SET_AS_ERR(&error, DEFAULT_ERRORNO, DEFAULT_ERROR);
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "ss|a!",
+                &module_p, &module_len, &function_p, &function_len,
+                &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for prepareApply()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for prepareApply()");
         goto exit;
     }
 
-    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zzz|zzz",
-                &key_record_p, &module_zval_p, &function_zval_p, &args_p,
-                &return_value_of_udf_p, &options_p)) {
+    if (module_len == 0 || function_len == 0 ||
+            module_len >= AS_UDF_MODULE_MAX_SIZE ||
+            function_len >= AS_UDF_FUNCTION_MAX_SIZE) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
-                "Unable to parse parameters for apply()");
-        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for apply()");
+                "Expects parameter 1 and 2 to be non-empty strings of a valid length");
+        DEBUG_PHP_EXT_ERROR("Expects parameter 1 and 2 to be non-empty strings of a valid length");
         goto exit;
     }
 
-    if (PHP_TYPE_ISNOTARR(key_record_p) ||
-            ((args_p) &&
-             (PHP_TYPE_ISNOTARR(args_p)) &&
-             (PHP_TYPE_ISNOTNULL(args_p))) ||
-            ((options_p) &&
-             (PHP_TYPE_ISNOTARR(options_p)) &&
-             (PHP_TYPE_ISNOTNULL(options_p))) ||
-            (PHP_TYPE_ISNOTSTR(module_zval_p)) ||
-            (PHP_TYPE_ISNOTSTR(function_zval_p))) {
-        status = AEROSPIKE_ERR_PARAM;
-        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
-                "Input parameters (type) for apply function are not proper");
-        DEBUG_PHP_EXT_ERROR("Input parameters (type) for apply function are not proper");
+    set_policy_udf_apply(&apply_policy, options_p, &error TSRMLS_CC);
+    if (AEROSPIKE_OK != (status = error.code)) {
+        DEBUG_PHP_EXT_ERROR("Unable to set policy");
         goto exit;
     }
 
-    if (args_p && PHP_TYPE_ISNULL(args_p)) {
-        args_p = NULL;
+    object_init_ex(return_value, Aerospike_udf_call_ce);
+    udf_call_p = (Aerospike_udf_call_object *)
+        zend_object_store_get_object(return_value TSRMLS_CC);
+    strcpy(udf_call_p->module, module_p);
+    strcpy(udf_call_p->function, function_p);
+    udf_call_p->apply_policy = apply_policy;
+    udf_call_p->args_list_p = as_arraylist_new(UDF_CALL_ARGS_CAPACITY,
+            UDF_CALL_ARGS_CAPACITY);
+    udf_call_p->udf_pool_p = (as_static_pool *) ecalloc(1, sizeof(as_static_pool));
+    udf_call_p->aerospike_p = getThis();
+    Z_ADDREF_P(udf_call_p->aerospike_p);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    if (AEROSPIKE_OK != status) {
+        RETURN_NULL();
     }
+}
 
-    if (options_p && PHP_TYPE_ISNULL(options_p)) {
-        options_p = NULL;
+/*
+ *******************************************************************************************************
+ * PHP Method : Aerospike\UdfCall::apply()
+ *******************************************************************************************************
+ * Applies a UDF call prepared by Aerospike::prepareApply() to a record. Errors
+ * are reported by the Aerospike object the call was prepared on.
+ * Method prototype for PHP userland:
+ * public int Aerospike\UdfCall::apply ( array $key [, array $args [, mixed &$returned ]] )
+ *******************************************************************************************************
+ */
+PHP_METHOD(AerospikeUdfCall, apply)
+{
+    as_status                   status = AEROSPIKE_OK;
+    as_error                    error;
+    as_key                      as_key_for_apply_udf;
+    int16_t                     initializeKey = 0;
+    zval*                       key_record_p = NULL;
+    zval*                       args_p = NULL;
+    zval*                       return_value_of_udf_p = NULL;
+    Aerospike_object*           aerospike_obj_p = NULL;
+    Aerospike_udf_call_object*  udf_call_p = (Aerospike_udf_call_object *)
+        zend_object_store_get_object(getThis() TSRMLS_CC);
+
+    PHP_EXT_SET_AS_ERR(&error, DEFAULT_ERRORNO, DEFAULT_ERROR);
+
+    if (!udf_call_p || !udf_call_p->aerospike_p) {
+        DEBUG_PHP_EXT_ERROR("Aerospike\\UdfCall objects are created by Aerospike::prepareApply()");
+        RETURN_LONG(AEROSPIKE_ERR_CLIENT);
     }
-    module_p = Z_STRVAL_P(module_zval_p);
-    function_name_p = Z_STRVAL_P(function_zval_p);
 
-    module_len = Z_STRLEN_P(module_zval_p);
-    function_len = Z_STRLEN_P(function_zval_p);
+    aerospike_obj_p = (Aerospike_object *)
+        zend_object_store_get_object(udf_call_p->aerospike_p TSRMLS_CC);
 
-    if (module_len == 0 || function_len == 0) {
-        status = AEROSPIKE_ERR_PARAM;
-        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
-                "Expects parameter 2 and 3 to be non-empty strings");
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
+                "apply: Connection not established");
+        DEBUG_PHP_EXT_ERROR("apply: Connection not established");
         goto exit;
     }
 
-    if ((options_p) && (PHP_TYPE_ISNOTARR(options_p))) {
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "z|a!z",
+                &key_record_p, &args_p, &return_value_of_udf_p)) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
-                "Input parameters (type) for apply function not proper");
-        DEBUG_PHP_EXT_ERROR("Input parameters (type) for apply function not proper");
+                "Unable to parse parameters for apply()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for apply()");
+        goto exit;
     }
 
     if (AEROSPIKE_OK !=
-            (status = aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_record_p),
-                                                                     &as_key_for_apply_udf,
-                                                                     &initializeKey))) {
+            (status = aerospike_transform_get_rec_key(key_record_p,
+                                                      &as_key_for_apply_udf,
+                                                      &initializeKey TSRMLS_CC))) {
         status = AEROSPIKE_ERR_PARAM;
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
                 "Unable to iterate through apply key params");
@@ -2969,25 +4418,23 @@ PHP_METHOD(Aerospike, apply)
 
     if (return_value_of_udf_p) {
         zval_dtor(return_value_of_udf_p);
-    } else {
-        MAKE_STD_ZVAL(return_value_of_udf_p);
+        array_init(return_value_of_udf_p);
     }
-    array_init(return_value_of_udf_p);
 
     if (AEROSPIKE_OK !=
-            (status = aerospike_udf_apply(aerospike_obj_p, 
-                                          &as_key_for_apply_udf, &error,
-                                          module_p, function_name_p, &args_p,
-                                          return_value_of_udf_p, options_p))) {
+            (status = aerospike_udf_call_apply(aerospike_obj_p, udf_call_p,
+                                               &as_key_for_apply_udf, &error,
+                                               args_p, return_value_of_udf_p))) {
         DEBUG_PHP_EXT_ERROR("apply function returned an error");
         goto exit;
     }
 exit:
     if (initializeKey) {
+        aerospike_record_cache_remove(&aerospike_obj_p->as_ref_p->record_cache, &as_key_for_apply_udf TSRMLS_CC);
         as_key_destroy(&as_key_for_apply_udf);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(udf_call_p->aerospike_p TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -3055,7 +4502,7 @@ PHP_METHOD(Aerospike, listRegistered)
     }
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -3136,7 +4583,7 @@ PHP_METHOD(Aerospike, getRegistered)
     }
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -3215,14 +4662,95 @@ PHP_METHOD(Aerospike, createIndex)
     if (AEROSPIKE_OK !=
             (status = aerospike_index_create_php(aerospike_obj_p->as_ref_p->as_p,
                                              &error, ns_p, set_p, bin_p, type,
-                                             name_p, options_p TSRMLS_CC))) {
+                                             name_p, options_p, true, NULL TSRMLS_CC))) {
         DEBUG_PHP_EXT_ERROR("createIndex() function returned an error");
         goto exit;
     }
+    aerospike_index_cache_invalidate(&aerospike_obj_p->as_ref_p->sindex_cache);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::createIndexAsync()
+ *******************************************************************************************************
+ * Starts creating a secondary index on a bin in the Aerospike database,
+ * without waiting for the index to be built.
+ * Method prototype for PHP userland:
+ * public int Aerospike::createIndexAsync ( string $ns, string $set, string $bin, int $type,
+ * string $name, array &$task [, array $options ] )
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, createIndexAsync)
+{
+    as_status               status = AEROSPIKE_OK;
+    as_error                error;
+    char                    *ns_p = NULL;
+    int                     ns_p_length = 0;
+    char                    *set_p = NULL;
+    int                     set_p_length = 0;
+    char                    *bin_p = NULL;
+    int                     bin_p_length = 0;
+    long                    type = -1;
+    char                    *name_p = NULL;
+    int                     name_p_length = 0;
+    zval*                   task_p = NULL;
+    zval*                   options_p = NULL;
+    Aerospike_object*       aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
+                "createIndexAsync: Connection not established");
+        DEBUG_PHP_EXT_ERROR("createIndexAsync: Connection not established");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "ssslsz|a",
+                &ns_p, &ns_p_length, &set_p, &set_p_length, &bin_p,
+                &bin_p_length, &type, &name_p, &name_p_length, &task_p,
+                &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for createIndexAsync()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for createIndexAsync()");
+        goto exit;
+    }
+
+    if (ns_p_length == 0 || set_p_length == 0 || bin_p_length == 0 || name_p_length == 0) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Aerospike::createIndexAsync() expects parameters 1-3 and 5 to be non-empty strings");
+        DEBUG_PHP_EXT_ERROR("Aerospike::createIndexAsync() expects parameters 1-3 and 5 to be non-empty strings");
+        goto exit;
+    }
+
+    zval_dtor(task_p);
+    array_init(task_p);
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_index_create_php(aerospike_obj_p->as_ref_p->as_p,
+                                             &error, ns_p, set_p, bin_p, type,
+                                             name_p, options_p, false, task_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("createIndexAsync() function returned an error");
+        goto exit;
+    }
+    aerospike_index_cache_invalidate(&aerospike_obj_p->as_ref_p->sindex_cache);
 
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -3292,10 +4820,189 @@ PHP_METHOD(Aerospike, dropIndex)
         DEBUG_PHP_EXT_ERROR("dropIndex() function returned an error");
         goto exit;
     }
+    aerospike_index_cache_invalidate(&aerospike_obj_p->as_ref_p->sindex_cache);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::indexes()
+ *******************************************************************************************************
+ * Lists the secondary indexes of the cluster, from the cache of the index
+ * metadata which is reloaded once older than aerospike.sindex_cache_ttl.
+ * Method prototype for PHP userland:
+ * public int Aerospike::indexes ( array &$indexes [, string $ns [, array $options ]] )
+ *
+ * @param indexes           The indexes returned as a list of arrays with the
+ *                          keys 'ns', 'set', 'name', 'bin' and 'type'.
+ * @param ns                The namespace to list the indexes of, or NULL for
+ *                          every namespace.
+ * @param options           Options including Aerospike::OPT_READ_TIMEOUT.
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, indexes)
+{
+    as_status               status = AEROSPIKE_OK;
+    as_error                error;
+    zval*                   indexes_p = NULL;
+    char*                   ns_p = NULL;
+    int                     ns_p_length = 0;
+    zval*                   options_p = NULL;
+    Aerospike_object*       aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
+                "indexes: Connection not established");
+        DEBUG_PHP_EXT_ERROR("indexes: Connection not established");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "z|s!a!",
+                &indexes_p, &ns_p, &ns_p_length, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for indexes()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for indexes()");
+        goto exit;
+    }
+
+    zval_dtor(indexes_p);
+    array_init(indexes_p);
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_index_cache_refresh(aerospike_obj_p->as_ref_p->as_p,
+                                                    &error,
+                                                    &aerospike_obj_p->as_ref_p->sindex_cache,
+                                                    (SINDEX_CACHE_TTL_PHP_INI <= 0),
+                                                    options_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("indexes() function returned an error");
+        goto exit;
+    }
+    aerospike_index_cache_list(&aerospike_obj_p->as_ref_p->sindex_cache,
+            ns_p, indexes_p);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Method:  Aerospike::taskStatus()
+ *******************************************************************************************************
+ * Gets the progress of a task started by Aerospike::createIndexAsync() or
+ * Aerospike::registerAsync() on every node of the cluster.
+ * Method prototype for PHP userland:
+ * public int Aerospike::taskStatus ( array $task, array &$status [, array $options ] )
+ *
+ * @param task              The task handle.
+ * @param status            The status of the task returned as an associative
+ *                          array with the keys 'done', 'progress_pct' (the
+ *                          lowest over the nodes) and 'nodes', the progress
+ *                          of each node.
+ * @param options           Options including Aerospike::OPT_READ_TIMEOUT.
+ *******************************************************************************************************
+ */
+PHP_METHOD(Aerospike, taskStatus)
+{
+    as_status               status = AEROSPIKE_OK;
+    as_error                error;
+    zval*                   task_p = NULL;
+    zval*                   task_status_p = NULL;
+    zval*                   options_p = NULL;
+    zval**                  type_pp = NULL;
+    zval**                  first_pp = NULL;
+    zval**                  second_pp = NULL;
+    Aerospike_object*       aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    if (!aerospike_obj_p) {
+        status = AEROSPIKE_ERR;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR, "Invalid aerospike object");
+        DEBUG_PHP_EXT_ERROR("Invalid aerospike object");
+        goto exit;
+    }
+
+    if (PHP_IS_CONN_NOT_ESTABLISHED(aerospike_obj_p->is_conn_16)) {
+        status = AEROSPIKE_ERR_CLUSTER;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLUSTER,
+                "taskStatus: Connection not established");
+        DEBUG_PHP_EXT_ERROR("taskStatus: Connection not established");
+        goto exit;
+    }
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "az|a!",
+                &task_p, &task_status_p, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for taskStatus()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for taskStatus()");
+        goto exit;
+    }
+
+    zval_dtor(task_status_p);
+    array_init(task_status_p);
+
+    if (FAILURE == zend_hash_find(Z_ARRVAL_P(task_p), TASK_TYPE,
+                sizeof(TASK_TYPE), (void **) &type_pp) ||
+            (Z_TYPE_PP(type_pp) != IS_STRING)) {
+        status = AEROSPIKE_ERR_PARAM;
+    } else if (0 == strcmp(Z_STRVAL_PP(type_pp), TASK_TYPE_INDEX)) {
+        if ((SUCCESS == zend_hash_find(Z_ARRVAL_P(task_p), TASK_NS,
+                        sizeof(TASK_NS), (void **) &first_pp)) &&
+                (SUCCESS == zend_hash_find(Z_ARRVAL_P(task_p), TASK_NAME,
+                        sizeof(TASK_NAME), (void **) &second_pp)) &&
+                (Z_TYPE_PP(first_pp) == IS_STRING) &&
+                (Z_TYPE_PP(second_pp) == IS_STRING)) {
+            status = aerospike_index_task_status(aerospike_obj_p->as_ref_p->as_p,
+                    &error, Z_STRVAL_PP(first_pp), Z_STRVAL_PP(second_pp),
+                    task_status_p, options_p TSRMLS_CC);
+        } else {
+            status = AEROSPIKE_ERR_PARAM;
+        }
+    } else if (0 == strcmp(Z_STRVAL_PP(type_pp), TASK_TYPE_UDF)) {
+        if ((SUCCESS == zend_hash_find(Z_ARRVAL_P(task_p), TASK_MODULE,
+                        sizeof(TASK_MODULE), (void **) &first_pp)) &&
+                (SUCCESS == zend_hash_find(Z_ARRVAL_P(task_p), TASK_HASH,
+                        sizeof(TASK_HASH), (void **) &second_pp)) &&
+                (Z_TYPE_PP(first_pp) == IS_STRING) &&
+                (Z_TYPE_PP(second_pp) == IS_STRING)) {
+            status = aerospike_udf_task_status(aerospike_obj_p, &error,
+                    Z_STRVAL_PP(first_pp), Z_STRVAL_PP(second_pp),
+                    task_status_p, options_p);
+        } else {
+            status = AEROSPIKE_ERR_PARAM;
+        }
+    } else {
+        status = AEROSPIKE_ERR_PARAM;
+    }
+
+    if (status == AEROSPIKE_ERR_PARAM) {
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Expects parameter 1 to be a task handle of createIndexAsync() or registerAsync()");
+        DEBUG_PHP_EXT_ERROR("Expects parameter 1 to be a task handle of createIndexAsync() or registerAsync()");
+        goto exit;
+    }
+    if (AEROSPIKE_OK != status) {
+        DEBUG_PHP_EXT_ERROR("taskStatus() function returned an error");
+        goto exit;
+    }
 
 exit:
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -3358,7 +5065,7 @@ exit:
     } else {
         PHP_EXT_RESET_AS_ERR_IN_CLASS();
     }
-    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    aerospike_helper_set_error(getThis() TSRMLS_CC);
     RETURN_LONG(status);
 }
 
@@ -3366,11 +5073,13 @@ exit:
  *******************************************************************************************************
  * PHP Method:  Aerospike::setLogHandler()
  *******************************************************************************************************
- * Sets a handler for log events.
+ * Sets a handler for log events, or removes it when passed NULL.
  * Method prototype for PHP userland:
- * public static void Aerospike::setLogHandler ( callback $log_handler )
+ * public static void Aerospike::setLogHandler ( callback $log_handler [, bool $batch = false ] )
  * where callback must follow the signature:
  * public function log_handler ( int $level, string $file, string $function, int $line )
+ * or with batch:
+ * public function log_handler ( array $events )
  *******************************************************************************************************
  */
 PHP_METHOD(Aerospike, setLogHandler)
@@ -3379,6 +5088,9 @@ PHP_METHOD(Aerospike, setLogHandler)
     as_status              status = AEROSPIKE_OK;
     as_error               error;
     uint32_t               ret_val = -1;
+    zend_bool              batch = 0;
+
+    aerospike_helper_log_flush(TSRMLS_C);
     is_callback_registered = 0;
 
     if (!aerospike_obj_p) {
@@ -3395,15 +5107,21 @@ PHP_METHOD(Aerospike, setLogHandler)
         RETURN_FALSE;
     }
 
-    if(zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "f*",
-                &func_call_info, &func_call_info_cache,
-                &func_call_info.params, &func_call_info.param_count) == FAILURE) {
+    if(zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "f!|b",
+                &func_call_info, &func_call_info_cache, &batch) == FAILURE) {
         PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse parameters for setLogHandler");
         DEBUG_PHP_EXT_ERROR("Unable to parse parameters for setLogHandler");
         RETURN_FALSE;
     }
 
+    if (!func_call_info.size) {
+        PHP_EXT_RESET_AS_ERR_IN_CLASS();
+        RETURN_TRUE;
+    }
+
+    aerospike_helper_log_buffer_init(TSRMLS_C);
     as_log_set_callback((as_log_callback)&aerospike_helper_log_callback);
+    is_callback_batched = batch;
     is_callback_registered = 1;
     Z_ADDREF_P(func_call_info.function_name);
     PHP_EXT_RESET_AS_ERR_IN_CLASS();
@@ -3427,8 +5145,9 @@ PHP_METHOD(Aerospike, setLogHandler)
  */
 PHP_METHOD(Aerospike, error)
 {
-    char *error_msg = Z_STRVAL_P(zend_read_property(Aerospike_ce, getThis(), "error", strlen("error"), 1 TSRMLS_CC));
-    RETURN_STRINGL(error_msg, strlen(error_msg), 1);
+    Aerospike_object*   aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    RETURN_STRINGL(aerospike_obj_p->error_msg, strlen(aerospike_obj_p->error_msg), 1);
 }
 
 /*
@@ -3442,8 +5161,9 @@ PHP_METHOD(Aerospike, error)
  */
 PHP_METHOD(Aerospike, errorno)
 {
-    int error_code = Z_LVAL_P(zend_read_property(Aerospike_ce, getThis(), "errorno", strlen("errorno"), 1 TSRMLS_CC));
-    RETURN_LONG(error_code);
+    Aerospike_object*   aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    RETURN_LONG(aerospike_obj_p->error_code);
 }
 
 /*
@@ -3455,6 +5175,8 @@ PHP_MINIT_FUNCTION(aerospike)
 {
     DEBUG_PHP_EXT_DEBUG("Inside minit");
     zend_class_entry ce={0};
+    zend_class_entry udf_call_ce={0};
+    zend_class_entry key_ce={0};
     INIT_CLASS_ENTRY(ce, "Aerospike", Aerospike_class_functions);
     if (!(Aerospike_ce = zend_register_internal_class(&ce TSRMLS_CC))) {
         return FAILURE;
@@ -3469,6 +5191,24 @@ PHP_MINIT_FUNCTION(aerospike)
     memcpy(&Aerospike_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
 
     Aerospike_ce->ce_flags |= ZEND_ACC_FINAL_CLASS;
+
+    INIT_NS_CLASS_ENTRY(udf_call_ce, "Aerospike", "UdfCall", Aerospike_udf_call_class_functions);
+    if (!(Aerospike_udf_call_ce = zend_register_internal_class(&udf_call_ce TSRMLS_CC))) {
+        return FAILURE;
+    }
+    Aerospike_udf_call_ce->create_object = Aerospike_udf_call_object_new;
+    memcpy(&Aerospike_udf_call_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+    Aerospike_udf_call_handlers.clone_obj = NULL;
+    Aerospike_udf_call_ce->ce_flags |= ZEND_ACC_FINAL_CLASS;
+
+    INIT_NS_CLASS_ENTRY(key_ce, "Aerospike", "Key", Aerospike_key_class_functions);
+    if (!(Aerospike_key_ce = zend_register_internal_class(&key_ce TSRMLS_CC))) {
+        return FAILURE;
+    }
+    Aerospike_key_ce->create_object = Aerospike_key_object_new;
+    memcpy(&Aerospike_key_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+    Aerospike_key_handlers.clone_obj = NULL;
+    Aerospike_key_ce->ce_flags |= ZEND_ACC_FINAL_CLASS;
 #ifdef ZTS
     ts_allocate_id(&aerospike_globals_id, sizeof(zend_aerospike_globals), (ts_allocate_ctor) aerospike_globals_ctor, (ts_allocate_dtor) aerospike_globals_dtor);
 #else
@@ -3480,13 +5220,9 @@ PHP_MINIT_FUNCTION(aerospike)
      * as well as CSDK to PHP client.
      */
     declare_policy_constants_php(Aerospike_ce TSRMLS_CC);
-
-    /* Refer aerospike_status.h
-     * This will expose the status code from CSDK
-     * to PHP client.
-     */
-    zend_declare_property_long(Aerospike_ce, "errorno", strlen("errorno"), DEFAULT_ERRORNO, ZEND_ACC_PRIVATE TSRMLS_CC);
-    zend_declare_property_string(Aerospike_ce, "error", strlen("error"), DEFAULT_ERROR, ZEND_ACC_PRIVATE TSRMLS_CC);
+    if (AEROSPIKE_OK != declare_policy_class_php(TSRMLS_C)) {
+        return FAILURE;
+    }
 
     EXPOSE_LOGGER_CONSTANTS_STR_ZEND(Aerospike_ce);
     EXPOSE_STATUS_CODE_ZEND(Aerospike_ce);
@@ -3550,6 +5286,10 @@ PHP_RSHUTDOWN_FUNCTION(aerospike)
             DEBUG_PHP_EXT_ERROR("leak for user deserializer function");
         }
     }
+    aerospike_read_memo_destroy(TSRMLS_C);
+    aerospike_call_trace_reset(TSRMLS_C);
+    /* the events of the request, see aerospike_helper_log_flush() */
+    aerospike_helper_log_flush(TSRMLS_C);
 
     DEBUG_PHP_EXT_DEBUG("Inside rshutdown of this build");
     return SUCCESS;
@@ -3566,5 +5306,6 @@ PHP_MINFO_FUNCTION(aerospike)
     php_info_print_table_row(2, "aerospike support", "enabled");
     php_info_print_table_row(2, "aerospike version", PHP_AEROSPIKE_VERSION);
     php_info_print_table_end();
+    aerospike_latency_info(TSRMLS_C);
 }
 
@@ -162,6 +162,7 @@ aerospike_batch_operations_exists_many(aerospike* as_object_p, as_error* error_p
     int                         i = 0;
     bool                        is_batch_init = false;
     foreach_callback_udata      metadata_callback;
+    uint64_t                    started_at = 0;
 
     if (!(as_object_p) || !(keys_p) || !(metadata_p)) {
         status = AEROSPIKE_ERR_PARAM;
@@ -188,16 +189,19 @@ aerospike_batch_operations_exists_many(aerospike* as_object_p, as_error* error_p
     is_batch_init = true;
 
     foreach_hashtable(keys_array, key_pointer, key_entry) {
-        aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_PP(key_entry),
-                as_batch_keyat(&batch, i), &initializeKey);
+        aerospike_transform_get_rec_key(*key_entry,
+                as_batch_keyat(&batch, i), &initializeKey TSRMLS_CC);
         i++;
     }
 
     metadata_callback.udata_p = metadata_p;
     metadata_callback.error_p = error_p;
 
-    if (AEROSPIKE_OK != (status = aerospike_batch_exists(as_object_p, error_p,
-                    &batch_policy, &batch, batch_exists_cb, &metadata_callback))) {
+    started_at = aerospike_latency_now();
+    status = aerospike_batch_exists(as_object_p, error_p, &batch_policy, &batch,
+            batch_exists_cb, &metadata_callback);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_BATCH, NULL, started_at);
+    if (AEROSPIKE_OK != status) {
         DEBUG_PHP_EXT_DEBUG("Unable to get metadata of batch records");
         goto exit;
     }
@@ -232,13 +236,96 @@ exit:
     return status;
 }
 
+/*
+ ******************************************************************************************************
+ * User data of batch_get_cb(): the result of getMany() and, for a read with
+ * OPT_READ_CACHE, the read cache to be populated with the records read.
+ ******************************************************************************************************
+ */
+typedef struct batch_get_callback_udata_t {
+    foreach_callback_udata      udata;
+    aerospike_record_cache*     cache_p;
+    size_t                      cache_max_memory;
+    uint32_t*                   cache_tokens_p;
+} batch_get_callback_udata;
+
+/*
+ ******************************************************************************************************
+ * Adds a record to the result of getMany(), under its key.
+ *
+ * @param key_p                     The key of the record.
+ * @param record_p                  The record.
+ * @param udata_ptr                 The result of getMany() and the as_error to
+ *                                  be set to the encountered error.
+ *
+ * @return true if the record is added. Otherwise false.
+ ******************************************************************************************************
+ */
+static bool
+batch_get_populate_record(as_key* key_p, as_record* record_p,
+        foreach_callback_udata* udata_ptr TSRMLS_DC)
+{
+    zval*                         record_container_p = NULL;
+    zval*                         get_record_p = NULL;
+    foreach_callback_udata        foreach_record_callback_udata;
+
+    MAKE_STD_ZVAL(record_container_p);
+    array_init(record_container_p);
+    ALLOC_INIT_ZVAL(get_record_p);
+    array_init(get_record_p);
+
+    foreach_record_callback_udata.udata_p = get_record_p;
+    foreach_record_callback_udata.error_p = udata_ptr->error_p;
+    foreach_record_callback_udata.obj = udata_ptr->obj;
+
+    if (AEROSPIKE_OK != aerospike_get_key_meta_bins_of_record(record_p,
+                key_p, record_container_p, NULL, false TSRMLS_CC)) {
+        PHP_EXT_SET_AS_ERR(udata_ptr->error_p, AEROSPIKE_ERR,
+                "Unable to get metadata of a record");
+        DEBUG_PHP_EXT_DEBUG("Unable to get metadata of a record");
+        goto cleanup;
+    }
+
+    if (!as_record_foreach(record_p, (as_rec_foreach_callback) AS_DEFAULT_GET,
+        &foreach_record_callback_udata)) {
+        PHP_EXT_SET_AS_ERR(udata_ptr->error_p, AEROSPIKE_ERR,
+                "Unable to get bins of a record");
+        DEBUG_PHP_EXT_DEBUG("Unable to get bins of a record");
+        goto cleanup;
+    }
+
+    if (0 != add_assoc_zval(record_container_p, PHP_AS_RECORD_DEFINE_FOR_BINS, get_record_p)) {
+        PHP_EXT_SET_AS_ERR(udata_ptr->error_p, AEROSPIKE_ERR,
+                "Unable to get a record");
+        DEBUG_PHP_EXT_DEBUG("Unable to get a record");
+        goto cleanup;
+    }
+    get_record_p = NULL;
+
+    populate_result_for_get_exists_many(key_p, udata_ptr->udata_p,
+            record_container_p, udata_ptr->error_p, false TSRMLS_CC);
+    if (AEROSPIKE_OK != udata_ptr->error_p->code) {
+        DEBUG_PHP_EXT_DEBUG("%s", udata_ptr->error_p->message);
+        goto cleanup;
+    }
+    return true;
+
+cleanup:
+    if (get_record_p) {
+        zval_ptr_dtor(&get_record_p);
+    }
+    zval_ptr_dtor(&record_container_p);
+    return false;
+}
+
 /*
  ******************************************************************************************************
  * This callback will be called with the results of aerospike_batch_get().
  * 
  * @param results                   An array of n as_batch_read entries.
  * @param n                         The number of results from the batch request.
- * @param udata                     The zval return value to be filled with the
+ * @param udata                     The batch_get_callback_udata holding the
+ *                                  zval return value to be filled with the
  *                                  result of getMany().
  *
  ******************************************************************************************************
@@ -247,91 +334,114 @@ bool
 batch_get_cb(const as_batch_read* results, uint32_t n, void* udata)
 {
     TSRMLS_FETCH();
-    foreach_callback_udata*       udata_ptr = (foreach_callback_udata *) udata;
+    batch_get_callback_udata*     batch_udata_ptr = (batch_get_callback_udata *) udata;
+    foreach_callback_udata*       udata_ptr = &batch_udata_ptr->udata;
     uint32_t                      i = 0;
-    foreach_callback_udata        foreach_record_callback_udata;
-    bool                          null_flag = false;
 
     for (i = 0; i < n; i++) {
-        zval *record_p = NULL;
-        zval *get_record_p = NULL;
-
         if (results[i].result == AEROSPIKE_OK) {
-            MAKE_STD_ZVAL(record_p);
-            array_init(record_p);
-            ALLOC_INIT_ZVAL(get_record_p);
-            array_init(get_record_p);
-    
-            foreach_record_callback_udata.udata_p = get_record_p;
-            foreach_record_callback_udata.error_p = udata_ptr->error_p;
-            foreach_record_callback_udata.obj = udata_ptr->obj;
-            null_flag = false;
+            if (!batch_get_populate_record((as_key *) results[i].key,
+                        (as_record *) &results[i].record, udata_ptr TSRMLS_CC)) {
+                return false;
+            }
+            if (batch_udata_ptr->cache_p) {
+                aerospike_record_cache_put(batch_udata_ptr->cache_p,
+                        (as_key *) results[i].key, &results[i].record,
+                        batch_udata_ptr->cache_max_memory,
+                        batch_udata_ptr->cache_tokens_p[i] TSRMLS_CC);
+            }
         } else if (results[i].result == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
-            null_flag = true;
+            populate_result_for_get_exists_many((as_key *) results[i].key,
+                    udata_ptr->udata_p, NULL, udata_ptr->error_p, true TSRMLS_CC);
+            if (AEROSPIKE_OK != udata_ptr->error_p->code) {
+                DEBUG_PHP_EXT_DEBUG("%s", udata_ptr->error_p->message);
+                return false;
+            }
         } else {
             return false;
         }
+    }
 
-        populate_result_for_get_exists_many((as_key *) results[i].key,
-                udata_ptr->udata_p, record_p, udata_ptr->error_p, null_flag TSRMLS_CC);
-        if (AEROSPIKE_OK != udata_ptr->error_p->code) {
-            DEBUG_PHP_EXT_DEBUG("%s", udata_ptr->error_p->message);
-            goto cleanup;
-        }
-
-        if (null_flag) {
-            goto cleanup;
-        }
-
-        if (AEROSPIKE_OK != aerospike_get_key_meta_bins_of_record((as_record *) &results[i].record,
-                    (as_key *) results[i].key, record_p, NULL, false TSRMLS_CC)) {
-            PHP_EXT_SET_AS_ERR(udata_ptr->error_p, AEROSPIKE_ERR,
-                    "Unable to get metadata of a record");
-            DEBUG_PHP_EXT_DEBUG("Unable to get metadata of a record");
-            goto cleanup;
-        }
-
-        if (!as_record_foreach(&results[i].record, (as_rec_foreach_callback) AS_DEFAULT_GET,
-            &foreach_record_callback_udata)) {
-            PHP_EXT_SET_AS_ERR(udata_ptr->error_p, AEROSPIKE_ERR,
-                    "Unable to get bins of a record");
-            DEBUG_PHP_EXT_DEBUG("Unable to get bins of a record");
-            goto cleanup;
-        }
-
-        if (0 != add_assoc_zval(record_p, PHP_AS_RECORD_DEFINE_FOR_BINS, get_record_p)) {
-            PHP_EXT_SET_AS_ERR(udata_ptr->error_p, AEROSPIKE_ERR,
-                    "Unable to get a record");
-            DEBUG_PHP_EXT_DEBUG("Unable to get a record");
-            goto cleanup;
-        }
+    return true;
+}
 
-        if (udata_ptr->error_p->code == AEROSPIKE_OK) {
+/*
+ ******************************************************************************************************
+ * Adds the records of a batch found in the read cache to the result of
+ * getMany(), and copies the keys of the others into miss_batch_p. The keys
+ * of miss_batch_p borrow the values of those of batch_p. A placeholder is
+ * added for each miss, so that the result keeps the order of the keys.
+ *
+ * @param cache_p                   The read cache.
+ * @param batch_p                   The keys of getMany().
+ * @param miss_batch_p              The batch to be populated with the keys
+ *                                  not found in the cache, of the same capacity.
+ * @param tokens_p                  The read cache tokens of the keys of
+ *                                  miss_batch_p, to be populated.
+ * @param udata_ptr                 The result of getMany() and the as_error to
+ *                                  be set to the encountered error.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+static as_status
+batch_get_from_cache(aerospike_record_cache* cache_p, as_batch* batch_p,
+        as_batch* miss_batch_p, uint32_t* tokens_p,
+        foreach_callback_udata* udata_ptr TSRMLS_DC)
+{
+    as_key*                       key_p = NULL;
+    as_key*                       miss_key_p = NULL;
+    as_record*                    cached_record_p = NULL;
+    as_record                     cached_record_view;
+    uint32_t                      cached_ttl = 0;
+    uint32_t                      token = 0;
+    uint32_t                      i = 0;
+    bool                          is_populated = false;
+
+    miss_batch_p->keys.size = 0;
+    for (i = 0; i < batch_p->keys.size; i++) {
+        key_p = as_batch_keyat(batch_p, i);
+        if ((cached_record_p = aerospike_record_cache_get(cache_p, NULL, NULL,
+                        key_p, &cached_ttl, &token TSRMLS_CC))) {
+            memcpy(&cached_record_view, cached_record_p, sizeof(as_record));
+            cached_record_view.ttl = cached_ttl;
+            is_populated = batch_get_populate_record(key_p, &cached_record_view,
+                    udata_ptr TSRMLS_CC);
+            as_record_destroy(cached_record_p);
+            if (!is_populated) {
+                break;
+            }
             continue;
         }
 
-cleanup:
-        foreach_record_callback_udata.udata_p = NULL;
-        if (get_record_p) {
-            zval_ptr_dtor(&get_record_p);
+        populate_result_for_get_exists_many(key_p, udata_ptr->udata_p, NULL,
+                udata_ptr->error_p, true TSRMLS_CC);
+        if (AEROSPIKE_OK != udata_ptr->error_p->code) {
+            break;
         }
-        if (record_p) {
-            zval_ptr_dtor(&record_p);
+
+        tokens_p[miss_batch_p->keys.size] = token;
+        miss_key_p = as_batch_keyat(miss_batch_p, miss_batch_p->keys.size++);
+        memcpy(miss_key_p, key_p, sizeof(as_key));
+        if (key_p->valuep == (as_key_value *) &key_p->value) {
+            miss_key_p->valuep = &miss_key_p->value;
+            if (as_val_type((as_val *) key_p->valuep) == AS_STRING) {
+                as_string_init(&miss_key_p->value.string,
+                        key_p->value.string.value, false);
+            }
         }
     }
 
-exit:
-    if (udata_ptr->error_p->code != AEROSPIKE_OK) {
-        return false;
-    }
-    return true;
+    return udata_ptr->error_p->code;
 }
+
 /*
  ******************************************************************************************************
  * Get all records identified by the array of keys.
  *
  * @param as_object_p               The C client's aerospike object.
  * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param cache_p                   The read cache used by reads with OPT_READ_CACHE.
  * @param keys_p                    An array of initialized keys, each an array
  *                                  with keys ['ns','set','key'] or ['ns','set','digest'].
  * @param records_p                 The array of records to be populated with
@@ -345,18 +455,24 @@ exit:
  */
 extern as_status
 aerospike_batch_operations_get_many(aerospike* as_object_p, as_error* error_p,
-        zval* keys_p, zval* records_p, zval* filter_bins_p, zval* options_p TSRMLS_DC)
+        aerospike_record_cache* cache_p, zval* keys_p, zval* records_p,
+        zval* filter_bins_p, zval* options_p TSRMLS_DC)
 {
     as_policy_batch                     batch_policy;
     as_batch                            batch;
+    as_batch                            miss_batch;
+    as_batch*                           read_batch_p = &batch;
     HashTable*                          keys_ht_p = NULL;
     HashPosition                        key_pointer;
     zval**                              key_entry;
     int16_t                             initializeKey = 0;
     int                                 i = 0;
     bool                                is_batch_init = false;
-    foreach_callback_udata              batch_get_callback_udata;
+    bool                                is_miss_batch_init = false;
+    batch_get_callback_udata            batch_get_callback_udata;
     int                                 filter_bins_count = 0;
+    uint64_t                            started_at = 0;
+    uint32_t*                           cache_tokens_p = NULL;
 
 /*    if (filter_bins_p) {
         filter_bins_count = zend_hash_num_elements(Z_ARRVAL_P(filter_bins_p));
@@ -399,23 +515,58 @@ aerospike_batch_operations_get_many(aerospike* as_object_p, as_error* error_p,
     is_batch_init = true;
 
     foreach_hashtable(keys_ht_p, key_pointer, key_entry) {
-        aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_PP(key_entry),
-                as_batch_keyat(&batch, i), &initializeKey);
+        aerospike_transform_get_rec_key(*key_entry,
+                as_batch_keyat(&batch, i), &initializeKey TSRMLS_CC);
         i++;
     }
 
-    batch_get_callback_udata.udata_p = records_p;
+    batch_get_callback_udata.udata.udata_p = records_p;
     //batch_get_callback_udata.select_p = select_p;
-    batch_get_callback_udata.error_p = error_p;
+    batch_get_callback_udata.udata.error_p = error_p;
+    batch_get_callback_udata.udata.obj = NULL;
+    batch_get_callback_udata.cache_p = NULL;
+    batch_get_callback_udata.cache_max_memory = 0;
+    batch_get_callback_udata.cache_tokens_p = NULL;
+
+    /*
+     * With OPT_READ_CACHE, the records held by the read cache are served from
+     * it, the others are read in a batch and cached. Stale entries are read
+     * again rather than revalidated one key at a time.
+     */
+    if (aerospike_record_cache_is_enabled(options_p TSRMLS_CC)) {
+        as_batch_inita(&miss_batch, zend_hash_num_elements(keys_ht_p));
+        is_miss_batch_init = true;
+        cache_tokens_p = (uint32_t *) emalloc(sizeof(uint32_t) * zend_hash_num_elements(keys_ht_p));
+        if (AEROSPIKE_OK != batch_get_from_cache(cache_p, &batch, &miss_batch, cache_tokens_p,
+                    &batch_get_callback_udata.udata TSRMLS_CC)) {
+            DEBUG_PHP_EXT_DEBUG("Unable to get cached records");
+            goto exit;
+        }
+        if (miss_batch.keys.size == 0) {
+            goto exit;
+        }
+        read_batch_p = &miss_batch;
+        batch_get_callback_udata.cache_p = cache_p;
+        batch_get_callback_udata.cache_max_memory = READ_CACHE_MAX_MEMORY_PHP_INI;
+        batch_get_callback_udata.cache_tokens_p = cache_tokens_p;
+    }
 
-    if (AEROSPIKE_OK != aerospike_batch_get(as_object_p, error_p, &batch_policy,
-                &batch, (aerospike_batch_read_callback) batch_get_cb,
-                &batch_get_callback_udata)) {
+    started_at = aerospike_latency_now();
+    aerospike_batch_get(as_object_p, error_p, &batch_policy, read_batch_p,
+            (aerospike_batch_read_callback) batch_get_cb, &batch_get_callback_udata);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_BATCH, NULL, started_at);
+    if (AEROSPIKE_OK != error_p->code) {
         DEBUG_PHP_EXT_DEBUG("Unable to get batch records");
         goto exit;
     }
 
 exit:
+    if (cache_tokens_p) {
+        efree(cache_tokens_p);
+    }
+    if (is_miss_batch_init) {
+        as_batch_destroy(&miss_batch);
+    }
     if (is_batch_init) {
         as_batch_destroy(&batch);
     }
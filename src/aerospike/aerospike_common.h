@@ -7,6 +7,10 @@
 #include "aerospike/as_node.h"
 #include "aerospike/as_operations.h"
 #include "aerospike/as_record.h"
+#include "aerospike/as_policy.h"
+#include "aerospike/as_udf.h"
+#include <pthread.h>
+#include <time.h>
 
 /*
  *******************************************************************************************************
@@ -55,6 +59,7 @@
 #define UDF_MODULE_NAME "name"
 #define UDF_MODULE_TYPE "type"
 #define LUA_FILE_BUFFER_FRAME 512
+#define UDF_CALL_ARGS_CAPACITY 8
 
 /*
  *******************************************************************************************************
@@ -85,6 +90,27 @@
 #define SAVE_HANDLER_PHP_INI INI_STR("session.save_handler") ? INI_STR("session.save_handler") : NULL
 #define SAVE_PATH_PHP_INI INI_STR("session.save_path") ? INI_STR("session.save_path") : NULL
 #define CACHE_EXPIRE_PHP_INI INI_INT("session.cache_expire") ? INI_INT("session.cache_expire") * 60 : 0
+#define SESSION_LOCK_PHP_INI INI_BOOL("aerospike.session.lock") ? INI_BOOL("aerospike.session.lock") : false
+#define SESSION_LOCK_TTL_PHP_INI INI_INT("aerospike.session.lock_ttl") ? INI_INT("aerospike.session.lock_ttl") : 30
+#define SESSION_LOCK_WAIT_PHP_INI INI_INT("aerospike.session.lock_wait") ? INI_INT("aerospike.session.lock_wait") : 5000
+#define SESSION_SKIP_READ_NEW_ID_PHP_INI INI_BOOL("aerospike.session.skip_read_new_id") ? INI_BOOL("aerospike.session.skip_read_new_id") : false
+#define SESSION_COMPRESS_THRESHOLD_PHP_INI INI_INT("aerospike.session.compress_threshold") ? INI_INT("aerospike.session.compress_threshold") : 0
+#define SESSION_BIN_PER_KEY_PHP_INI INI_BOOL("aerospike.session.bin_per_key") ? INI_BOOL("aerospike.session.bin_per_key") : false
+#define SESSION_BIN_PER_KEY_MAX_PHP_INI INI_INT("aerospike.session.bin_per_key_max") ? INI_INT("aerospike.session.bin_per_key_max") : 64
+#define SINDEX_CACHE_TTL_PHP_INI INI_INT("aerospike.sindex_cache_ttl")
+#define READ_CACHE_MAX_MEMORY_PHP_INI INI_INT("aerospike.read_cache.max_memory")
+#define READ_CACHE_MAX_AGE_PHP_INI INI_INT("aerospike.read_cache.max_age")
+#define SHM_RECORD_CACHE_KEY_PHP_INI INI_INT("aerospike.shm.record_cache.key")
+#define SHM_RECORD_CACHE_SIZE_PHP_INI INI_INT("aerospike.shm.record_cache.size")
+#define SHM_RECORD_CACHE_SLOT_SIZE_PHP_INI INI_INT("aerospike.shm.record_cache.slot_size")
+#define SHM_RECORD_CACHE_MAX_TTL_PHP_INI INI_INT("aerospike.shm.record_cache.max_ttl")
+#define READ_MEMO_PHP_INI INI_BOOL("aerospike.read_memo")
+#define CALL_TRACE_SIZE_PHP_INI INI_INT("aerospike.call_trace_size")
+#define SLOW_LOG_THRESHOLD_PHP_INI INI_INT("aerospike.slow_log.threshold")
+#define SLOW_LOG_SAMPLE_RATE_PHP_INI INI_INT("aerospike.slow_log.sample_rate")
+#define SLOW_LOG_PATH_PHP_INI INI_STR("aerospike.slow_log.path")
+#define LOG_HANDLER_BUFFER_SIZE_PHP_INI INI_INT("aerospike.log_handler.buffer_size")
+#define SESSION_SERIALIZE_HANDLER_PHP_INI INI_STR("session.serialize_handler") ? INI_STR("session.serialize_handler") : "php"
 
 #define AEROSPIKE_SESSION "aerospike"
 #define AEROSPIKE_SESSION_LEN 9
@@ -98,6 +124,31 @@
 #define OP "op"
 #define VAL "val"
 
+/*
+ *******************************************************************************************************
+ * MACROS FOR REDUCER ARRAY KEYS.
+ *******************************************************************************************************
+ */
+#define REDUCER_TYPE "type"
+#define REDUCER_K "k"
+#define REDUCER_GROUP_BY "group_by"
+
+/*
+ *******************************************************************************************************
+ * MACROS FOR TASK HANDLE ARRAY KEYS AND VALUES, AND TASK STATUS ARRAY KEYS.
+ *******************************************************************************************************
+ */
+#define TASK_TYPE "type"
+#define TASK_TYPE_INDEX "index"
+#define TASK_TYPE_UDF "udf"
+#define TASK_NS "ns"
+#define TASK_NAME "name"
+#define TASK_MODULE "module"
+#define TASK_HASH "hash"
+#define TASK_STATUS_DONE "done"
+#define TASK_STATUS_PROGRESS_PCT "progress_pct"
+#define TASK_STATUS_NODES "nodes"
+
 /*
  *******************************************************************************************************
  * EXPECTED KEYS IN INPUT FROM PHP USERLAND.
@@ -159,6 +210,107 @@ typedef struct list_map_static_pool {
     u_int32_t        current_bytes_id;
 } as_static_pool;
 
+/*
+ *******************************************************************************************************
+ * Secondary index metadata, as reported by the sindex info command.
+ *******************************************************************************************************
+ */
+#define SINDEX_NAME_MAX_SIZE 256
+
+typedef struct aerospike_sindex_t {
+    char                ns[AS_NAMESPACE_MAX_SIZE];
+    char                set[AS_SET_MAX_SIZE];       /* empty if the index is on the whole namespace */
+    char                name[SINDEX_NAME_MAX_SIZE];
+    char                bin[AS_BIN_NAME_MAX_SIZE];
+    uint32_t            type;                       /* one of INDEX_TYPE_* */
+} aerospike_sindex;
+
+/*
+ *******************************************************************************************************
+ * Cache of the secondary indexes of a cluster, shared by the Aerospike objects
+ * holding the same C client's aerospike object.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_sindex_cache_t {
+    pthread_rwlock_t    lock;
+    aerospike_sindex*   sindexes_p;
+    uint32_t            count;
+    time_t              refreshed_at;               /* 0 if never loaded or invalidated */
+} aerospike_sindex_cache;
+
+/*
+ *******************************************************************************************************
+ * A record held by the read cache, a copy owned by the cache.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_record_cache_entry_t {
+    char                ns[AS_NAMESPACE_MAX_SIZE];
+    uint8_t             digest[AS_DIGEST_VALUE_SIZE];
+    as_record*          record_p;
+    size_t              size;                       /* estimated footprint of the entry */
+    time_t              cached_at;                  /* when read or last revalidated */
+    time_t              expires_at;                 /* from the record's ttl, 0 if it never expires */
+    uint32_t            bucket;
+    struct aerospike_record_cache_entry_t*  hash_next_p;
+    struct aerospike_record_cache_entry_t*  lru_prev_p;
+    struct aerospike_record_cache_entry_t*  lru_next_p;
+} aerospike_record_cache_entry;
+
+/*
+ *******************************************************************************************************
+ * LRU cache of records read with OPT_READ_CACHE, keyed by digest and bounded
+ * by aerospike.read_cache.max_memory. Shared by the Aerospike objects holding
+ * the same C client's aerospike object.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_record_cache_t {
+    pthread_mutex_t                 lock;
+    aerospike_record_cache_entry**  buckets_p;
+    aerospike_record_cache_entry*   lru_head_p;     /* most recently used */
+    aerospike_record_cache_entry*   lru_tail_p;
+    size_t                          size;
+    uint32_t                        cluster_id;     /* of the seeds, for the shared memory record cache */
+} aerospike_record_cache;
+
+/*
+ *******************************************************************************************************
+ * Types of operations whose latencies are recorded for Aerospike::getStats().
+ *******************************************************************************************************
+ */
+typedef enum aerospike_latency_operation_e {
+    AEROSPIKE_LATENCY_GET,
+    AEROSPIKE_LATENCY_PUT,
+    AEROSPIKE_LATENCY_OPERATE,
+    AEROSPIKE_LATENCY_BATCH,
+    AEROSPIKE_LATENCY_SCAN,
+    AEROSPIKE_LATENCY_QUERY,
+    AEROSPIKE_LATENCY_UDF,
+    AEROSPIKE_LATENCY_INFO,
+    AEROSPIKE_LATENCY_OPERATIONS
+} aerospike_latency_operation;
+
+/*
+ *******************************************************************************************************
+ * Trace of a call, kept for Aerospike::lastCallTrace() when
+ * aerospike.call_trace_size is set.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_call_trace_t {
+    aerospike_latency_operation operation;
+    const char*         name_p;                     /* of the method, defaults to the operation's */
+    as_key*             key_p;                      /* only during the call */
+    const as_record*    sent_record_p;              /* only during the call, sized if kept or logged */
+    const as_record*    received_record_p;
+    char                ns[AS_NAMESPACE_MAX_SIZE];
+    char                set[AS_SET_MAX_SIZE];
+    as_status           status;
+    uint64_t            marshal_us;                 /* PHP values into the request */
+    uint64_t            network_us;                 /* round trip through the C client */
+    uint64_t            unmarshal_us;               /* response into PHP values */
+    uint64_t            bytes_sent;                 /* estimated from the bins */
+    uint64_t            bytes_received;
+} aerospike_call_trace;
+
 /*
  *******************************************************************************************************
  * Structure containing C client's aerospike object and its reference counter.
@@ -183,6 +335,18 @@ typedef struct csdk_aerospike_obj {
      * persistent_list hashtable.
      */
     int ref_hosts_entry;
+
+    /*
+     * sindex_cache holds the secondary indexes of the cluster, used by
+     * Aerospike::indexes() and to fail queries on bins without an index.
+     */
+    aerospike_sindex_cache sindex_cache;
+
+    /*
+     * record_cache holds the records read with OPT_READ_CACHE by get() and
+     * getMany().
+     */
+    aerospike_record_cache record_cache;
 } aerospike_ref;
 
 /*
@@ -195,20 +359,63 @@ typedef struct Aerospike_object {
     bool is_persistent;
     aerospike_ref *as_ref_p;
     u_int16_t is_conn_16;
+    as_status error_code;
+    char error_msg[AS_ERROR_MESSAGE_MAX_SIZE];
 #ifdef ZTS
     void ***ts;
 #endif
 } Aerospike_object;
 
+/*
+ *******************************************************************************************************
+ * Structure of an Aerospike\UdfCall object, a UDF call prepared by
+ * Aerospike::prepareApply(). It holds the resolved module, function and apply
+ * policy, and the list and static pool the arguments are marshalled into,
+ * which are reused by each call.
+ *******************************************************************************************************
+ */
+typedef struct Aerospike_udf_call_object {
+    zend_object std;
+    zval *aerospike_p;
+    char module[AS_UDF_MODULE_MAX_SIZE];
+    char function[AS_UDF_FUNCTION_MAX_SIZE];
+    as_policy_apply apply_policy;
+    as_arraylist *args_list_p;
+    as_static_pool *udf_pool_p;
+} Aerospike_udf_call_object;
+
+/*
+ *******************************************************************************************************
+ * Structure of an Aerospike\Key object, a record key prepared by
+ * Aerospike::prepareKey(). It holds the as_key in native form, with its
+ * digest computed once, and owns a copy of a string key value.
+ *******************************************************************************************************
+ */
+typedef struct Aerospike_key_object {
+    zend_object std;
+    as_key key;
+} Aerospike_key_object;
+
+extern zend_class_entry *Aerospike_key_ce;
+
 /* 
  *******************************************************************************************************
  * Structure containing session info of Aerospike_object.
  *******************************************************************************************************
  */
+#define AEROSPIKE_SESSION_DIGEST_SIZE 20
+
 typedef struct aerospike_session_t {
     Aerospike_object    *aerospike_obj_p;
     char                ns_p[AS_NAMESPACE_MAX_SIZE];
     char                set_p[AS_SET_MAX_SIZE];
+    unsigned char       read_digest[AEROSPIKE_SESSION_DIGEST_SIZE];
+    bool                is_read_digest_set;
+    char                *lock_key_p;
+    int64_t             lock_owner;
+    char                *created_sid_p;
+    HashTable           *key_bins_p;
+    bool                has_session_bin;
 } aerospike_session;
 
 /*
@@ -245,6 +452,7 @@ extern zend_fcall_info       func_call_info;
 extern zend_fcall_info_cache func_call_info_cache;
 extern zval                  *func_callback_retval_p;
 extern uint32_t              is_callback_registered;
+extern uint32_t              is_callback_batched;
 
 /*
  *******************************************************************************************************
@@ -271,14 +479,36 @@ extern uint32_t              is_user_deserializer_registered;
  * A wrapper for the two structs zend_fcall_info and zend_fcall_info_cache
  * that allows for userland function callbacks from within a C-callback
  * context, by having both passed within this struct as a void *udata.
+ * max_records (0 for no limit) caps the number of records handed to the
+ * userland function, records_count counts those handed so far.
+ * hidden_bins_pp lists the bins selected only to evaluate query filters,
+ * which are left out of the records handed to the userland function.
  ****************************************************************************
  */
 typedef struct _userland_callback {
     zend_fcall_info *fci_p;
     zend_fcall_info_cache *fcc_p;
     Aerospike_object *obj;
+    uint64_t max_records;
+    uint64_t records_count;
+    const char **hidden_bins_pp;
+    uint32_t hidden_bins_count;
 } userland_callback;
 
+#define USERLAND_CALLBACK_LIMIT_REACHED(user_func_p)                          \
+    ((user_func_p)->max_records &&                                            \
+     (user_func_p)->records_count >= (user_func_p)->max_records)
+
+/*
+ * Whether a scan or query failed only because its callback stopped the
+ * streams on reaching OPT_MAX_RECORDS, the C client reporting the streams
+ * it aborted with these statuses.
+ */
+#define USERLAND_CALLBACK_LIMIT_ABORTED(user_func_p, error_p)                 \
+    ((user_func_p) && USERLAND_CALLBACK_LIMIT_REACHED(user_func_p) &&        \
+     ((error_p)->code == AEROSPIKE_ERR_SCAN_ABORTED ||                        \
+      (error_p)->code == AEROSPIKE_ERR_QUERY_ABORTED))
+
 /*
  *******************************************************************************************************
  * Decision Structure for as_config/zval to be populated by
@@ -315,8 +545,19 @@ typedef struct _transform_zval_config_into {
 extern bool
 aerospike_helper_log_callback(as_log_level level, const char * func TSRMLS_DC, const char * file, uint32_t line, const char * fmt, ...);
 extern int parseLogParameters(as_log *as_log_p);
+extern void
+aerospike_helper_log_buffer_init(TSRMLS_D);
+extern void
+aerospike_helper_log_flush(TSRMLS_D);
+extern void
+aerospike_helper_log_message(int level, const char* func, const char* file,
+        uint32_t line, const char* message TSRMLS_DC);
 extern bool
 aerospike_helper_record_stream_callback(const as_val* p_val, void* udata);
+extern void
+aerospike_helper_set_max_records(userland_callback* user_func_p, zval* options_p);
+extern as_status
+aerospike_helper_reject_max_records(zval* options_p, as_error* error_p);
 extern bool
 aerospike_helper_aggregate_callback(const as_val* val_p, void* udata_p);
 extern bool
@@ -345,12 +586,12 @@ extern as_log_level   php_log_level_set;
 #ifdef __DEBUG_PHP__
 #define DEBUG_PHP_EXT_COMPARE_LEVEL(log_level, php_log_level, args...)                                \
 do {                                                                                                  \
-    if (!(((as_log_level) PHP_EXT_AS_LOG_LEVEL_OFF) == php_log_level_set))                            \
-        if (php_log_level_set >= log_level) {                                                         \
-            php_error_docref(NULL TSRMLS_CC, php_log_level, args);                                    \
-            aerospike_helper_log_callback((log_level | 0x08), __func__ TSRMLS_CC,                     \
-                    __FILE__, __LINE__, ##args);                                                      \
-        }                                                                                             \
+    /* PHP_EXT_AS_LOG_LEVEL_OFF is below every level, and args are only evaluated past this check */  \
+    if (php_log_level_set >= log_level) {                                                             \
+        php_error_docref(NULL TSRMLS_CC, php_log_level, args);                                        \
+        aerospike_helper_log_callback((log_level | 0x08), __func__ TSRMLS_CC,                         \
+                __FILE__, __LINE__, ##args);                                                          \
+    }                                                                                                 \
 } while(0)
 
 /*
@@ -411,6 +652,8 @@ do {
 #define PHP_TYPE_ISNOTSTR(zend_val)      PHP_IS_NOT_STRING(Z_TYPE_P(zend_val))
 #define PHP_TYPE_ISNOTLONG(zend_val)     PHP_IS_NOT_LONG(Z_TYPE_P(zend_val))
 #define PHP_TYPE_ISNOTARR(zend_val)      PHP_IS_NOT_ARRAY(Z_TYPE_P(zend_val))
+#define PHP_TYPE_ISNOTKEY(zend_val)      (PHP_TYPE_ISNOTARR(zend_val) && \
+        !aerospike_transform_is_key_object(zend_val TSRMLS_CC))
  
 /*
  *******************************************************************************************************
@@ -468,6 +711,18 @@ extern as_status
 aerospike_transform_iterate_for_rec_key_params(HashTable* ht_p,
         as_key* as_key_p, int16_t* set_val_p);
 
+extern bool
+aerospike_transform_is_key_object(zval* key_record_p TSRMLS_DC);
+
+extern as_status
+aerospike_transform_get_rec_key(zval* key_record_p, as_key* as_key_p,
+        int16_t* set_val_p TSRMLS_DC);
+
+extern as_status
+aerospike_transform_init_key_object(as_key* as_key_p, char* ns_p,
+        int ns_p_length, char* set_p, int set_p_length, zval* pk_p,
+        bool is_digest);
+
 extern as_status
 aerospike_transform_check_and_set_config(HashTable* ht_p, zval** retdata_pp,
         void* config_p);
@@ -559,8 +814,7 @@ get_generation_value(zval* options_p, uint16_t* generation_value_p,
  *******************************************************************************************************
  */
 extern void
-aerospike_helper_set_error(zend_class_entry *ce_p,
-                           zval *object_p TSRMLS_DC);
+aerospike_helper_set_error(zval *object_p TSRMLS_DC);
 
 extern as_status
 aerospike_helper_object_from_alias_hash(Aerospike_object* as_object_p,
@@ -591,7 +845,17 @@ aerospike_helper_close_php_connection(Aerospike_object *as_obj_p,
  */
 extern as_status
 aerospike_udf_register(Aerospike_object* aerospike_obj_p, as_error* error_p,
-        char *path_p, char *module_p, long language, zval *options_p);
+        char *path_p, char *module_p, long language, zval *options_p,
+        bool block, zval* task_p);
+
+extern as_status
+aerospike_udf_call_apply(Aerospike_object* aerospike_obj_p,
+        Aerospike_udf_call_object* udf_call_p, as_key* as_key_p,
+        as_error* error_p, zval* args_p, zval* return_value_p);
+
+extern as_status
+aerospike_udf_task_status(Aerospike_object* aerospike_obj_p, as_error* error_p,
+        char* module_p, char* hash_p, zval* status_p, zval* options_p);
 
 extern as_status
 aerospike_udf_deregister(Aerospike_object* aerospike_obj_p, as_error* error_p,
@@ -620,7 +884,7 @@ aerospike_get_registered_udf_module_code(Aerospike_object* aerospike_obj_p,
 extern as_status
 aerospike_scan_run(aerospike* as_object_p, as_error* error_p,
         char* namespace_p, char* set_p, userland_callback* user_func_p,
-        HashTable* bins_ht_p, zval* options_p TSRMLS_DC);
+        HashTable* bins_ht_p, zval* options_p, zval* cursor_p TSRMLS_DC);
 
 extern as_status
 aerospike_scan_run_background(aerospike* as_object_p, as_error* error_p,
@@ -637,7 +901,8 @@ aerospike_scan_get_info(aerospike* as_object_p, as_error* error_p,
  ******************************************************************************************************
  */
 extern as_status
-aerospike_query_run(aerospike* as_object_p, as_error* error_p, char* namespace_p,
+aerospike_query_run(aerospike* as_object_p, as_error* error_p,
+        aerospike_sindex_cache* sindex_cache_p, char* namespace_p,
         char* set_p, userland_callback* user_func_p, HashTable* bins_ht_p,
         HashTable* predicate_ht_p, zval* options_p TSRMLS_DC);
 
@@ -647,6 +912,18 @@ aerospike_query_aggregate(aerospike* as_object_p, as_error* error_p,
         char* namespace_p, char* set_p, HashTable* bins_ht_p,
         HashTable* predicate_ht_p, zval* return_value_p, zval* options_p TSRMLS_DC);
 
+extern as_status
+aerospike_query_reduce(aerospike* as_object_p, as_error* error_p,
+        char* namespace_p, char* set_p, HashTable* predicate_ht_p,
+        HashTable* reducer_ht_p, zval* result_p, zval* options_p TSRMLS_DC);
+
+extern as_status
+aerospike_query_apply_each(aerospike* as_object_p,
+        aerospike_record_cache* cache_p, as_error* error_p, char* namespace_p,
+        char* set_p, HashTable* predicate_ht_p,
+        char* module_p, char* function_p, zval** args_pp, zval* applied_p,
+        zval* options_p TSRMLS_DC);
+
 /*
  ******************************************************************************************************
  * Extern declarations of index functions.
@@ -655,12 +932,114 @@ aerospike_query_aggregate(aerospike* as_object_p, as_error* error_p,
 extern as_status
 aerospike_index_create_php(aerospike* as_object_p, as_error *error_p,
         char* ns_p, char* set_p, char* bin_p, uint32_t type,
-        char *name_p, zval* options_p TSRMLS_DC);
+        char *name_p, zval* options_p, bool block, zval* task_p TSRMLS_DC);
+
+extern as_status
+aerospike_index_task_status(aerospike* as_object_p, as_error* error_p,
+        char* ns_p, char* name_p, zval* status_p, zval* options_p TSRMLS_DC);
+
+extern void
+aerospike_index_cache_init(aerospike_sindex_cache* cache_p);
+
+extern void
+aerospike_index_cache_destroy(aerospike_sindex_cache* cache_p);
+
+extern void
+aerospike_index_cache_invalidate(aerospike_sindex_cache* cache_p);
+
+extern as_status
+aerospike_index_cache_refresh(aerospike* as_object_p, as_error* error_p,
+        aerospike_sindex_cache* cache_p, bool force, zval* options_p TSRMLS_DC);
+
+extern bool
+aerospike_index_cache_is_reloadable(aerospike_sindex_cache* cache_p);
+
+extern bool
+aerospike_index_cache_lookup(aerospike_sindex_cache* cache_p, char* ns_p,
+        char* set_p, char* bin_p, int type);
+
+extern void
+aerospike_index_cache_list(aerospike_sindex_cache* cache_p, char* ns_p,
+        zval* indexes_p);
+
+extern void
+aerospike_record_cache_init(aerospike_record_cache* cache_p, as_config* config_p);
+
+extern void
+aerospike_record_cache_destroy(aerospike_record_cache* cache_p);
+
+extern bool
+aerospike_record_cache_is_enabled(zval* options_p TSRMLS_DC);
+
+extern as_record*
+aerospike_record_cache_get(aerospike_record_cache* cache_p,
+        aerospike* as_object_p, as_policy_read* read_policy_p, as_key* key_p,
+        uint32_t* ttl_p, uint32_t* token_p TSRMLS_DC);
+
+extern void
+aerospike_record_cache_put(aerospike_record_cache* cache_p, as_key* key_p,
+        const as_record* record_p, size_t max_memory, uint32_t token TSRMLS_DC);
+
+extern void
+aerospike_record_cache_remove(aerospike_record_cache* cache_p, as_key* key_p TSRMLS_DC);
+
+extern bool
+aerospike_read_memo_get(aerospike_record_cache* cache_p, as_key* key_p,
+        zval* bins_p, zval* record_p TSRMLS_DC);
+
+extern void
+aerospike_read_memo_put(aerospike_record_cache* cache_p, as_key* key_p,
+        zval* bins_p, zval* record_p TSRMLS_DC);
+
+extern void
+aerospike_read_memo_destroy(TSRMLS_D);
 
 extern as_status
 aerospike_index_remove_php(aerospike* as_object_p, as_error *error_p,
         char* ns_p, char *name_p, zval* options_p TSRMLS_DC);
 
+/*
+ ******************************************************************************************************
+ * Extern declarations of latency functions.
+ ******************************************************************************************************
+ */
+extern uint64_t
+aerospike_latency_now(void);
+
+extern void
+aerospike_latency_record(aerospike* as_object_p, aerospike_latency_operation operation,
+        as_key* key_p, uint64_t started_at);
+
+extern void
+aerospike_latency_record_node(aerospike_latency_operation operation,
+        const char* node_name_p, uint64_t started_at);
+
+extern void
+aerospike_latency_stats(zval* stats_p TSRMLS_DC);
+
+extern void
+aerospike_latency_info(TSRMLS_D);
+
+extern bool
+aerospike_call_trace_is_enabled(TSRMLS_D);
+
+extern void
+aerospike_call_trace_init(aerospike_call_trace* trace_p,
+        aerospike_latency_operation operation, as_key* key_p);
+
+extern void
+aerospike_call_trace_add(aerospike* as_object_p, aerospike_call_trace* trace_p TSRMLS_DC);
+
+extern void
+aerospike_call_trace_command(aerospike* as_object_p, aerospike_latency_operation operation,
+        const char* name_p, as_key* key_p, as_status status, uint64_t started_at TSRMLS_DC);
+
+extern void
+aerospike_call_trace_list(zval* traces_p TSRMLS_DC);
+
+extern void
+aerospike_call_trace_reset(TSRMLS_D);
+
 /*
  ******************************************************************************************************
  * Extern declarations of info functions.
@@ -670,6 +1049,10 @@ extern as_status
 aerospike_info_specific_host(aerospike* as_object_p, as_error* error_p,
         char* request, zval* response_p, zval* host, zval* options_p TSRMLS_DC);
 
+extern as_status
+aerospike_info_specific_host_parsed(aerospike* as_object_p, as_error* error_p,
+        char* request, zval* response_p, zval* host, zval* options_p TSRMLS_DC);
+
 extern as_status
 aerospike_info_request_multiple_nodes(aerospike* as_object_p,
         as_error* error_p, char* request_str_p, zval* config_p,
@@ -679,6 +1062,28 @@ extern as_status
 aerospike_info_get_cluster_nodes(aerospike* as_object_p,
         as_error* error_p, zval* return_p, zval* host, zval* options_p TSRMLS_DC);
 
+extern as_status
+aerospike_info_jobs_list(aerospike* as_object_p, as_error* error_p,
+        char* module_p, uint64_t job_id, zval* jobs_p, zval* options_p TSRMLS_DC);
+
+extern as_status
+aerospike_info_job_get(aerospike* as_object_p, as_error* error_p,
+        char* module_p, uint64_t job_id, zval* info_p, zval* options_p TSRMLS_DC);
+
+/*
+ * Checks whether the info response of a node shows that a task is done on it.
+ */
+typedef bool (*aerospike_info_task_match_fn)(const char* response_p, void* udata_p);
+
+extern as_status
+aerospike_info_task_status(aerospike* as_object_p, as_error* error_p,
+        char* request_p, aerospike_info_task_match_fn match_fn, void* match_udata_p,
+        char* progress_key_p, zval* status_p, zval* options_p TSRMLS_DC);
+
+extern as_status
+aerospike_info_job_command(aerospike* as_object_p, as_error* error_p,
+        char* module_p, uint64_t job_id, char* command_p, zval* options_p TSRMLS_DC);
+
 /*
  ******************************************************************************************************
  * Extern declarations of Batch operations.
@@ -691,7 +1096,8 @@ aerospike_batch_operations_exists_many(aerospike* as_object_p,
 
 extern as_status
 aerospike_batch_operations_get_many(aerospike* as_object_p, as_error* as_error_p,
-        zval* keys_p, zval* records_p, zval* filter_bins_p, zval* options_p TSRMLS_DC);
+        aerospike_record_cache* cache_p, zval* keys_p, zval* records_p,
+        zval* filter_bins_p, zval* options_p TSRMLS_DC);
 
 /*
  ******************************************************************************************************
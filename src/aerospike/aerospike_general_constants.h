@@ -27,6 +27,20 @@ enum Aerospike_operate_constants {
     OPERATOR_APPEND  = 5,
     OPERATOR_TOUCH   = 8,
 };
+
+/*
+ *******************************************************************************************************
+ * Enum for PHP client's native reducer constant values.
+ *******************************************************************************************************
+ */
+enum Aerospike_reduce_constants {
+    REDUCE_COUNT        = 0,    /* Number of matching records */
+    REDUCE_SUM          = 1,    /* Sum of an integer bin */
+    REDUCE_MIN          = 2,    /* Smallest value of an integer bin */
+    REDUCE_MAX          = 3,    /* Largest value of an integer bin */
+    REDUCE_TOP_K        = 4,    /* The k largest values of an integer bin */
+    REDUCE_GROUP_BY_SUM = 5     /* Sum of an integer bin per distinct value of another bin */
+};
 /*
  *******************************************************************************************************
  * Structure to map constant number to constant name string for Aerospike General Long constants.
@@ -60,7 +74,13 @@ static AerospikeGeneralLongConstants aerospike_general_long_constants[] = {
     { OPERATOR_INCR,        "OPERATOR_INCR" },
     { OPERATOR_PREPEND,     "OPERATOR_PREPEND" },
     { OPERATOR_APPEND,      "OPERATOR_APPEND" },
-    { OPERATOR_TOUCH,       "OPERATOR_TOUCH" }
+    { OPERATOR_TOUCH,       "OPERATOR_TOUCH" },
+    { REDUCE_COUNT,         "REDUCE_COUNT" },
+    { REDUCE_SUM,           "REDUCE_SUM" },
+    { REDUCE_MIN,           "REDUCE_MIN" },
+    { REDUCE_MAX,           "REDUCE_MAX" },
+    { REDUCE_TOP_K,         "REDUCE_TOP_K" },
+    { REDUCE_GROUP_BY_SUM,  "REDUCE_GROUP_BY_SUM" }
 };
 
 /*
@@ -70,7 +90,11 @@ static AerospikeGeneralLongConstants aerospike_general_long_constants[] = {
  */
 static AerospikeGeneralStringConstants aerospike_general_string_constants[] = {
     { "=",         "OP_EQ"  },
-    { "BETWEEN",   "OP_BETWEEN" }
+    { "BETWEEN",   "OP_BETWEEN" },
+    { "IN",        "OP_IN" },
+    { "CONTAINS",  "OP_CONTAINS" },
+    { "scan",      "JOB_SCAN" },
+    { "query",     "JOB_QUERY" }
 };
 
 #define AEROSPIKE_GENERAL_LONG_CONSTANTS_ARR_SIZE (sizeof(aerospike_general_long_constants)/sizeof(AerospikeGeneralLongConstants))
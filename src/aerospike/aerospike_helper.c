@@ -9,6 +9,7 @@
 #include "aerospike/aerospike.h"
 #include "pthread.h"
 #include "aerospike_common.h"
+#include "aerospike_policy.h"
 
 #define SAVE_PATH_DELIMITER "|"
 #define IP_PORT_DELIMITER ":"
@@ -23,6 +24,7 @@ zend_fcall_info       func_call_info;
 zend_fcall_info_cache func_call_info_cache;
 zval                  *func_callback_retval_p;
 uint32_t              is_callback_registered;
+uint32_t              is_callback_batched;
 
 /*
  *******************************************************************************************************
@@ -35,12 +37,162 @@ as_log_level php_log_level_set = PHP_EXT_AS_LOG_LEVEL_OFF;
 as_log_level php_log_level_set = __AEROSPIKE_PHP_CLIENT_LOG_LEVEL__;
 #endif
 
+/*
+ *******************************************************************************************************
+ * Log events held for the log handler when aerospike.log_handler.buffer_size
+ * is set. The C client logs from its own threads as well, so the buffer is
+ * shared by the process and guarded by a mutex. Like the handler, which is
+ * global, it is shared by the threads of a ZTS build: the events are passed
+ * to the handler by whichever request thread flushes them first.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_log_event_t {
+    as_log_level    level;
+    const char*     func;
+    const char*     file;
+    uint32_t        line;
+} aerospike_log_event;
+
+static pthread_mutex_t      log_buffer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static aerospike_log_event* log_buffer_p = NULL;
+static uint32_t             log_buffer_capacity = 0;
+static uint32_t             log_buffer_count = 0;
+static uint32_t             log_buffer_dropped = 0;
+
+/*
+ *******************************************************************************************************
+ * Appends a log event to the array of events passed to a log handler set with
+ * Aerospike::setLogHandler($handler, true).
+ *
+ * @param events_p          The array of events.
+ * @param level             The as_log_level of the event.
+ * @param func              The function name generating the log.
+ * @param file              The file name containing the func generating the log.
+ * @param line              The line number in file where the log was generated.
+ * @param message           The message of a PHP client's event, or NULL.
+ *
+ *******************************************************************************************************
+ */
+static void
+aerospike_helper_log_event_add(zval* events_p, int level, const char* func,
+        const char* file, uint32_t line, const char* message)
+{
+    zval*     event_p = NULL;
+
+    ALLOC_INIT_ZVAL(event_p);
+    array_init(event_p);
+    add_assoc_long(event_p, "level", level);
+    add_assoc_string(event_p, "function", (char *) func, 1);
+    add_assoc_string(event_p, "file", (char *) file, 1);
+    add_assoc_long(event_p, "line", line);
+    if (message) {
+        add_assoc_string(event_p, "message", (char *) message, 1);
+    }
+    add_next_index_zval(events_p, event_p);
+}
+
+/*
+ *******************************************************************************************************
+ * Calls the log handler set with Aerospike::setLogHandler($handler, true)
+ * once for an array of log events.
+ *
+ * @param events_p          The array of events, released by the call.
+ *
+ *******************************************************************************************************
+ */
+static void
+aerospike_helper_log_call_batch(zval* events_p TSRMLS_DC)
+{
+    zval**    params[1];
+    zval*     retval_p = NULL;
+
+    params[0] = &events_p;
+    func_call_info.param_count = 1;
+    func_call_info.params = params;
+    func_call_info.retval_ptr_ptr = &retval_p;
+
+    if (zend_call_function(&func_call_info, &func_call_info_cache TSRMLS_CC) == SUCCESS &&
+            retval_p) {
+        zval_ptr_dtor(&retval_p);
+    }
+    zval_ptr_dtor(&events_p);
+}
+
+/*
+ *******************************************************************************************************
+ * Calls the log handler set with Aerospike::setLogHandler() for a log event.
+ *
+ * @param level             The as_log_level of the event.
+ * @param func              The function name generating the log.
+ * @param file              The file name containing the func generating the log.
+ * @param line              The line number in file where the log was generated.
+ *
+ *******************************************************************************************************
+ */
+static void
+aerospike_helper_log_call(as_log_level level, const char* func, const char* file,
+        uint32_t line TSRMLS_DC)
+{
+    int16_t   iter = 0;
+    zval**    params[4];
+    zval*     z_func = NULL;
+    zval*     z_file = NULL;
+    zval*     z_line = NULL; 
+    zval*     z_level = NULL;
+    zval*     events_p = NULL;
+    func_callback_retval_p = NULL;
+
+    if (is_callback_batched) {
+        ALLOC_INIT_ZVAL(events_p);
+        array_init(events_p);
+        aerospike_helper_log_event_add(events_p, level, func, file, line, NULL);
+        aerospike_helper_log_call_batch(events_p TSRMLS_CC);
+        return;
+    }
+
+    ALLOC_INIT_ZVAL(z_level);
+    ZVAL_LONG(z_level, level);
+    params[0] = &z_level;
+
+    ALLOC_INIT_ZVAL(z_func);
+    ZVAL_STRING(z_func, func, 1);
+    params[1] = &z_func;
+
+    ALLOC_INIT_ZVAL(z_file);
+    ZVAL_STRING(z_file, file, 1);
+    params[2] = &z_file;
+
+    ALLOC_INIT_ZVAL(z_line);
+    ZVAL_LONG(z_line, line);
+    params[3] = &z_line;
+
+    func_call_info.param_count = 4;
+    func_call_info.params = params;
+    func_call_info.retval_ptr_ptr = &func_callback_retval_p;
+
+    if (zend_call_function(&func_call_info, &func_call_info_cache TSRMLS_CC) == SUCCESS && 
+        func_call_info.retval_ptr_ptr && *func_call_info.retval_ptr_ptr) {
+            //TODO: COPY_PZVAL_TO_ZVAL(*return_value, *func_call_info.retval_ptr_ptr);
+    } else {
+            // TODO: Handle failure in zend_call_function
+    }
+
+    for (iter = 0; iter < 4; iter++) {
+        zval_ptr_dtor(params[iter]);
+    }
+}
+
 /*
  *******************************************************************************************************
  * Callback for C client's logger.
  * This function shall be invoked by:
  * 1. C client's logger statements.
  * 2. PHP client's logger statements.
+ *
+ * The log handler only receives the origin of an event, so the message is
+ * formatted only when no handler is set and it goes to stderr. When
+ * aerospike.log_handler.buffer_size is set, events are held until
+ * aerospike_helper_log_flush() passes them to the handler.
  * 
  * @param level             The as_log_level to be used by the callback.
  * @param func              The function name generating the log.
@@ -54,97 +206,247 @@ as_log_level php_log_level_set = __AEROSPIKE_PHP_CLIENT_LOG_LEVEL__;
 extern bool
 aerospike_helper_log_callback(as_log_level level, const char * func TSRMLS_DC, const char * file, uint32_t line, const char * fmt, ...)
 {
-    if (level & 0x08) {
-        char msg[1024] = {0};
-        va_list ap;
-
-        va_start(ap, fmt);
-        vsnprintf(msg, 1024, fmt, ap);
-        msg[1023] = '\0';
-        va_end(ap);
-        if (!is_callback_registered) { 
+    if (!is_callback_registered) {
+        if (level & 0x08) {
+            char msg[1024] = {0};
+            va_list ap;
+
+            va_start(ap, fmt);
+            vsnprintf(msg, 1024, fmt, ap);
+            msg[1023] = '\0';
+            va_end(ap);
             fprintf(stderr, "PHP EXTn: level %d func %s file %s line %d msg %s \n", level, func, file, line, msg);
-	    }
-    }
-
-    if (is_callback_registered) { 
-        int16_t   iter = 0;
-        zval**    params[4];
-        zval*     z_func = NULL;
-        zval*     z_file = NULL;
-        zval*     z_line = NULL; 
-        zval*     z_level = NULL;
-        func_callback_retval_p = NULL;
-
-        ALLOC_INIT_ZVAL(z_level);
-        ZVAL_LONG(z_level, level);
-        params[0] = &z_level;
-
-        ALLOC_INIT_ZVAL(z_func);
-        ZVAL_STRING(z_func, func, 1);
-        params[1] = &z_func;
-
-        ALLOC_INIT_ZVAL(z_file);
-        ZVAL_STRING(z_file, file, 1);
-        params[2] = &z_file;
-
-        ALLOC_INIT_ZVAL(z_line);
-        ZVAL_LONG(z_line, line);
-        params[3] = &z_line;
-
-        func_call_info.param_count = 4;
-        func_call_info.params = params;
-        func_call_info.retval_ptr_ptr = &func_callback_retval_p;
-   
-        if (zend_call_function(&func_call_info, &func_call_info_cache TSRMLS_CC) == SUCCESS && 
-            func_call_info.retval_ptr_ptr && *func_call_info.retval_ptr_ptr) {
-                //TODO: COPY_PZVAL_TO_ZVAL(*return_value, *func_call_info.retval_ptr_ptr);
-        } else {
-                // TODO: Handle failure in zend_call_function
         }
+        return true;
+    }
 
-        for (iter = 0; iter < 4; iter++) {
-            zval_ptr_dtor(params[iter]);
+    if (log_buffer_capacity) {
+        pthread_mutex_lock(&log_buffer_mutex);
+        if (log_buffer_count < log_buffer_capacity) {
+            log_buffer_p[log_buffer_count].level = level;
+            log_buffer_p[log_buffer_count].func = func;
+            log_buffer_p[log_buffer_count].file = file;
+            log_buffer_p[log_buffer_count].line = line;
+            log_buffer_count++;
+        } else {
+            log_buffer_dropped++;
         }
+        pthread_mutex_unlock(&log_buffer_mutex);
+        return true;
     }
 
+    aerospike_helper_log_call(level, func, file, line TSRMLS_CC);
     return true;
 }
 
 /*
  *******************************************************************************************************
- * Sets the private members error and errorno of the Aerospike class.
+ * Sizes the buffer of log events to aerospike.log_handler.buffer_size when a
+ * log handler is set. 0 calls the handler for each event as it is logged.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_helper_log_buffer_init(TSRMLS_D)
+{
+    long                    buffer_size = LOG_HANDLER_BUFFER_SIZE_PHP_INI;
+    aerospike_log_event*    buffer_p = NULL;
+
+    if (buffer_size < 0) {
+        buffer_size = 0;
+    }
+    if ((uint32_t) buffer_size == log_buffer_capacity) {
+        return;
+    }
+    if (buffer_size && !(buffer_p = malloc(buffer_size * sizeof(aerospike_log_event)))) {
+        buffer_size = 0;
+    }
+
+    pthread_mutex_lock(&log_buffer_mutex);
+    free(log_buffer_p);
+    log_buffer_p = buffer_p;
+    log_buffer_capacity = buffer_size;
+    log_buffer_count = 0;
+    log_buffer_dropped = 0;
+    pthread_mutex_unlock(&log_buffer_mutex);
+}
+
+/*
+ *******************************************************************************************************
+ * Passes the buffered log events to the log handler, outside of the buffer's
+ * lock so that the client keeps logging meanwhile. Events dropped as the
+ * buffer was full are reported to the handler as a warning message. A
+ * handler set with Aerospike::setLogHandler($handler, true) is called once
+ * with the array of the events.
+ *
+ * Called on the request thread when a handler is set, and at RSHUTDOWN. The
+ * handler then runs after the destructors of the request's objects were
+ * called and the output layer was shut down, so it can no longer print.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_helper_log_flush(TSRMLS_D)
+{
+    aerospike_log_event*    events_p = NULL;
+    uint32_t                count = 0;
+    uint32_t                dropped = 0;
+    uint32_t                iter = 0;
+    char                    message[64];
+    zval*                   batch_p = NULL;
+
+    if (!log_buffer_capacity || (!log_buffer_count && !log_buffer_dropped)) {
+        return;
+    }
+
+    pthread_mutex_lock(&log_buffer_mutex);
+    if (log_buffer_count && (events_p = emalloc(log_buffer_count * sizeof(aerospike_log_event)))) {
+        memcpy(events_p, log_buffer_p, log_buffer_count * sizeof(aerospike_log_event));
+        count = log_buffer_count;
+    }
+    dropped = log_buffer_dropped;
+    log_buffer_count = 0;
+    log_buffer_dropped = 0;
+    pthread_mutex_unlock(&log_buffer_mutex);
+
+    if (is_callback_registered && is_callback_batched) {
+        ALLOC_INIT_ZVAL(batch_p);
+        array_init(batch_p);
+        for (iter = 0; iter < count; iter++) {
+            aerospike_helper_log_event_add(batch_p, events_p[iter].level, events_p[iter].func,
+                    events_p[iter].file, events_p[iter].line, NULL);
+        }
+        if (dropped) {
+            snprintf(message, sizeof(message), "%u log events dropped", dropped);
+            aerospike_helper_log_event_add(batch_p, 4 /* Aerospike::LOG_LEVEL_WARN */,
+                    __func__, __FILE__, __LINE__, message);
+        }
+        aerospike_helper_log_call_batch(batch_p TSRMLS_CC);
+    } else if (is_callback_registered) {
+        for (iter = 0; iter < count; iter++) {
+            aerospike_helper_log_call(events_p[iter].level, events_p[iter].func,
+                    events_p[iter].file, events_p[iter].line TSRMLS_CC);
+        }
+        if (dropped) {
+            snprintf(message, sizeof(message), "%u log events dropped", dropped);
+            aerospike_helper_log_message(4 /* Aerospike::LOG_LEVEL_WARN */, __func__,
+                    __FILE__, __LINE__, message TSRMLS_CC);
+        }
+    }
+    if (events_p) {
+        efree(events_p);
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Passes a message of the PHP client to the log handler set with
+ * Aerospike::setLogHandler(), as a fifth argument after those of the C
+ * client's log events, or as the message of a single event to a handler
+ * taking arrays of events.
+ *
+ * @param level             The Aerospike::LOG_LEVEL_* of the message.
+ * @param func              The function name generating the message.
+ * @param file              The file name containing the func generating the message.
+ * @param line              The line number in file where the message was generated.
+ * @param message           The message.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_helper_log_message(int level, const char* func, const char* file,
+        uint32_t line, const char* message TSRMLS_DC)
+{
+    int16_t         iter = 0;
+    zval**          params[5];
+    zval*           z_level = NULL;
+    zval*           z_func = NULL;
+    zval*           z_file = NULL;
+    zval*           z_line = NULL;
+    zval*           z_message = NULL;
+    zval*           retval_p = NULL;
+    zval*           events_p = NULL;
+
+    if (!is_callback_registered) {
+        return;
+    }
+
+    if (is_callback_batched) {
+        ALLOC_INIT_ZVAL(events_p);
+        array_init(events_p);
+        aerospike_helper_log_event_add(events_p, level, func, file, line, message);
+        aerospike_helper_log_call_batch(events_p TSRMLS_CC);
+        return;
+    }
+
+    ALLOC_INIT_ZVAL(z_level);
+    ZVAL_LONG(z_level, level);
+    params[0] = &z_level;
+
+    ALLOC_INIT_ZVAL(z_func);
+    ZVAL_STRING(z_func, func, 1);
+    params[1] = &z_func;
+
+    ALLOC_INIT_ZVAL(z_file);
+    ZVAL_STRING(z_file, file, 1);
+    params[2] = &z_file;
+
+    ALLOC_INIT_ZVAL(z_line);
+    ZVAL_LONG(z_line, line);
+    params[3] = &z_line;
+
+    ALLOC_INIT_ZVAL(z_message);
+    ZVAL_STRING(z_message, message, 1);
+    params[4] = &z_message;
+
+    func_call_info.param_count = 5;
+    func_call_info.params = params;
+    func_call_info.retval_ptr_ptr = &retval_p;
+
+    if (zend_call_function(&func_call_info, &func_call_info_cache TSRMLS_CC) == SUCCESS &&
+            retval_p) {
+        zval_ptr_dtor(&retval_p);
+    }
+
+    for (iter = 0; iter < 5; iter++) {
+        zval_ptr_dtor(params[iter]);
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Records the error of the last operation in the Aerospike object, from where
+ * Aerospike::error() and Aerospike::errorno() read it. The message is copied
+ * only when it differs from the one already held, so a run of successful
+ * calls costs a single comparison.
  *
- * @param ce_p              The zend_class_entry pointer for the Aerospike class.
  * @param object_p          The Aerospike object.
- * @param error_p           The as_error containing the recent error details.
- * @param reset_flag        The flag indicating whether to set/reset the class error.
  *
  *******************************************************************************************************
  */
 extern void
-aerospike_helper_set_error(zend_class_entry *ce_p, zval *object_p TSRMLS_DC)
+aerospike_helper_set_error(zval *object_p TSRMLS_DC)
 {
-    zval*    err_code_p = NULL;
-    zval*    err_msg_p = NULL;
-    aerospike_global_error error_t = AEROSPIKE_G(error_g);
+    Aerospike_object*           aerospike_obj_p = NULL;
+    aerospike_global_error*     error_t_p = &AEROSPIKE_G(error_g);
+    const char*                 err_msg_p = DEFAULT_ERROR;
 
-    MAKE_STD_ZVAL(err_code_p);
-    MAKE_STD_ZVAL(err_msg_p);
+    if (!object_p ||
+            !(aerospike_obj_p = (Aerospike_object *) zend_object_store_get_object(object_p TSRMLS_CC))) {
+        return;
+    }
 
-    if (error_t.reset) {
-        ZVAL_STRINGL(err_msg_p, DEFAULT_ERROR, strlen(DEFAULT_ERROR), 1);
-        ZVAL_LONG(err_code_p, DEFAULT_ERRORNO);
+    if (error_t_p->reset) {
+        aerospike_obj_p->error_code = DEFAULT_ERRORNO;
     } else {
-        ZVAL_STRINGL(err_msg_p, error_t.error.message, strlen(error_t.error.message), 1);
-        ZVAL_LONG(err_code_p, error_t.error.code);
+        aerospike_obj_p->error_code = error_t_p->error.code;
+        err_msg_p = error_t_p->error.message;
     }
 
-    zend_update_property(ce_p, object_p, "error", strlen("error"), err_msg_p TSRMLS_CC);
-    zend_update_property(ce_p, object_p, "errorno", strlen("errorno"), err_code_p TSRMLS_CC);
-
-    zval_ptr_dtor(&err_code_p);
-    zval_ptr_dtor(&err_msg_p);
+    if (strcmp(aerospike_obj_p->error_msg, err_msg_p)) {
+        strncpy(aerospike_obj_p->error_msg, err_msg_p, AS_ERROR_MESSAGE_MAX_SIZE - 1);
+        aerospike_obj_p->error_msg[AS_ERROR_MESSAGE_MAX_SIZE - 1] = '\0';
+    }
 }
 
 /*
@@ -159,6 +461,8 @@ do {                                                                          \
         as_object_p->as_ref_p->as_p = NULL;                                   \
         as_object_p->as_ref_p->ref_as_p = 0;                                  \
         as_object_p->as_ref_p->ref_hosts_entry = 0;                           \
+        aerospike_index_cache_init(&as_object_p->as_ref_p->sindex_cache);     \
+        aerospike_record_cache_init(&as_object_p->as_ref_p->record_cache, conf); \
     }                                                                         \
     as_object_p->as_ref_p->as_p = aerospike_new(conf);                        \
     as_object_p->as_ref_p->ref_as_p = 1;                                      \
@@ -378,6 +682,62 @@ aerospike_helper_free_static_pool(as_static_pool *static_pool)
     for (iter = 0; iter < static_pool->current_map_id; iter++) {
         as_hashmap_destroy(&static_pool->alloc_map[iter]);
     }
+
+    /* the pool may be reused, as by the UDF calls of Aerospike::prepareApply() */
+    static_pool->current_str_id = 0;
+    static_pool->current_int_id = 0;
+    static_pool->current_bytes_id = 0;
+    static_pool->current_list_id = 0;
+    static_pool->current_map_id = 0;
+}
+
+/*
+ *******************************************************************************************************
+ * Sets the record limit of a scan or query callback from the
+ * Aerospike::OPT_MAX_RECORDS option, which set_policy() has already
+ * validated.
+ *
+ * @param user_func_p       The userland_callback of the scan or query.
+ * @param options_p         The optional policy.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_helper_set_max_records(userland_callback* user_func_p, zval* options_p)
+{
+    zval**                  max_records_pp = NULL;
+
+    user_func_p->max_records = 0;
+    user_func_p->records_count = 0;
+    if (options_p && (SUCCESS == zend_hash_index_find(Z_ARRVAL_P(options_p),
+                    OPT_MAX_RECORDS, (void **) &max_records_pp)) &&
+            (Z_TYPE_PP(max_records_pp) == IS_LONG)) {
+        user_func_p->max_records = (uint64_t) Z_LVAL_PP(max_records_pp);
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Fails a scan or query which does not hand its records to a userland
+ * callback, and so can not stop after Aerospike::OPT_MAX_RECORDS of them,
+ * when given that option.
+ *
+ * @param options_p         The optional policy.
+ * @param error_p           The as_error to be set if the option is given.
+ *
+ * @return AEROSPIKE_OK if the option is not given. Otherwise AEROSPIKE_ERR_PARAM.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_helper_reject_max_records(zval* options_p, as_error* error_p)
+{
+    if (options_p && (Z_TYPE_P(options_p) == IS_ARRAY) &&
+            zend_hash_index_exists(Z_ARRVAL_P(options_p), OPT_MAX_RECORDS)) {
+        DEBUG_PHP_EXT_DEBUG("OPT_MAX_RECORDS only applies to scan() and query()");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                "OPT_MAX_RECORDS only applies to scan() and query()");
+        return AEROSPIKE_ERR_PARAM;
+    }
+    return AEROSPIKE_OK;
 }
 
 /*
@@ -408,11 +768,16 @@ aerospike_helper_record_stream_callback(const as_val* p_val, void* udata)
     bool                    do_continue = true;
     foreach_callback_udata  foreach_record_callback_udata;
     zval                    *outer_container_p = NULL;
+    uint32_t                i;
     TSRMLS_FETCH();
     if (!p_val) {
         DEBUG_PHP_EXT_INFO("callback is null; stream complete.");
         return true;
     }
+    user_func_p = (userland_callback *) udata;
+    if (USERLAND_CALLBACK_LIMIT_REACHED(user_func_p)) {
+        return false;
+    }
     as_record* current_as_rec = as_record_fromval(p_val);
     if (!current_as_rec) {
         DEBUG_PHP_EXT_WARNING("stream returned a non-as_record object to the callback.");
@@ -430,6 +795,10 @@ aerospike_helper_record_stream_callback(const as_val* p_val, void* udata)
         zval_ptr_dtor(&record_p);
         return true;
     }
+    for (i = 0; i < user_func_p->hidden_bins_count; i++) {
+        zend_hash_del(Z_ARRVAL_P(record_p), user_func_p->hidden_bins_pp[i],
+                strlen(user_func_p->hidden_bins_pp[i]) + 1);
+    }
 
     MAKE_STD_ZVAL(outer_container_p);
     array_init(outer_container_p);
@@ -452,7 +821,6 @@ aerospike_helper_record_stream_callback(const as_val* p_val, void* udata)
     /*
      * Call the userland function with the array representing the record.
      */
-    user_func_p = (userland_callback *) udata;
     fci_p = user_func_p->fci_p;
     fcc_p = user_func_p->fcc_p;
     args[0] = &outer_container_p;
@@ -476,6 +844,15 @@ aerospike_helper_record_stream_callback(const as_val* p_val, void* udata)
         }
         zval_ptr_dtor(&retval);
     }
+
+    /*
+     * Returning false once the limit is reached aborts the streams of all
+     * the nodes, instead of draining them into the void.
+     */
+    user_func_p->records_count++;
+    if (USERLAND_CALLBACK_LIMIT_REACHED(user_func_p)) {
+        do_continue = false;
+    }
     return do_continue;
 }
 
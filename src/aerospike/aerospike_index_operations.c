@@ -5,6 +5,33 @@
 #include "aerospike_common.h"
 #include "aerospike_general_constants.h"
 #include "aerospike/aerospike_index.h"
+#include "aerospike/aerospike_info.h"
+
+#define INDEX_TASK_REQUEST_MAX_LEN 256
+#define INDEX_LOAD_PCT "load_pct="
+#define SINDEX_CACHE_MIN_RELOAD_SEC 1
+
+/*
+ * Info protocol of the secondary indexes of a namespace, and the keys of the
+ * index arrays returned by Aerospike::indexes().
+ */
+#define INDEX_INFO_REQUEST "sindex"
+#define INDEX_INFO_ENTRY_DELIMITER ";"
+#define INDEX_INFO_FIELD_DELIMITER ":"
+#define INDEX_INFO_NS "ns="
+#define INDEX_INFO_SET "set="
+#define INDEX_INFO_NAME "indexname="
+#define INDEX_INFO_BINS "bins="
+#define INDEX_INFO_BIN "bin="
+#define INDEX_INFO_TYPE "type="
+#define INDEX_INFO_NO_SET "NULL"
+#define INDEX_INFO_TYPE_NUMERIC "NUMERIC"
+#define INDEX_INFO_TYPE_STRING "STRING"
+#define INDEX_NS "ns"
+#define INDEX_SET "set"
+#define INDEX_NAME "name"
+#define INDEX_BIN "bin"
+#define INDEX_TYPE "type"
 
 /*
  *******************************************************************************************************
@@ -21,13 +48,17 @@
  * @param name_p                The index name for which index is to be
  *                              created.
  * @param options_p             The user's optional policy options to be used if set, else defaults.
+ * @param block                 Whether to wait until the index is built on
+ *                              every node of the cluster.
+ * @param task_p                The task handle to be populated for
+ *                              Aerospike::taskStatus() if not waiting, or NULL.
  *
  *******************************************************************************************************
  */
 extern as_status
 aerospike_index_create_php(aerospike* as_object_p, as_error *error_p,
         char* ns_p, char* set_p, char* bin_p, uint32_t type,
-        char *name_p, zval* options_p TSRMLS_DC)
+        char *name_p, zval* options_p, bool block, zval* task_p TSRMLS_DC)
 {
     as_status                   status = AEROSPIKE_OK;
     as_policy_info              info_policy;
@@ -55,12 +86,18 @@ aerospike_index_create_php(aerospike* as_object_p, as_error *error_p,
                                              type))) {
         DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
         goto exit;
-    } else if (AEROSPIKE_OK !=
-            (status = aerospike_index_create_wait(error_p, &task, 0))) {
+    } else if (block && (AEROSPIKE_OK !=
+            (status = aerospike_index_create_wait(error_p, &task, 0)))) {
         DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
         goto exit;
     }
 
+    if (task_p) {
+        add_assoc_string(task_p, TASK_TYPE, TASK_TYPE_INDEX, 1);
+        add_assoc_string(task_p, TASK_NS, ns_p, 1);
+        add_assoc_string(task_p, TASK_NAME, name_p, 1);
+    }
+
 exit:
     return(status);
 }
@@ -112,3 +149,385 @@ aerospike_index_remove_php(aerospike* as_object_p, as_error *error_p,
 exit:
     return(status);
 }
+
+/*
+ *******************************************************************************************************
+ * Gets the build progress of a secondary index on every node of the cluster,
+ * from the load_pct statistic of the index.
+ *
+ * @param as_object_p           The C client's aerospike object.
+ * @param error_p               The as_error to be populated by the function
+ *                              with the encountered error if any.
+ * @param ns_p                  The namespace of the index.
+ * @param name_p                The index name.
+ * @param status_p              The task status array to be populated.
+ * @param options_p             The user's optional policy options to be used if set, else defaults.
+ *
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_index_task_status(aerospike* as_object_p, as_error* error_p,
+        char* ns_p, char* name_p, zval* status_p, zval* options_p TSRMLS_DC)
+{
+    char                        request[INDEX_TASK_REQUEST_MAX_LEN];
+
+    snprintf(request, INDEX_TASK_REQUEST_MAX_LEN, "sindex/%s/%s", ns_p, name_p);
+    return aerospike_info_task_status(as_object_p, error_p, request, NULL, NULL,
+            INDEX_LOAD_PCT, status_p, options_p TSRMLS_CC);
+}
+
+/*
+ *******************************************************************************************************
+ * Initializes an empty secondary index cache.
+ *
+ * @param cache_p               The cache to be initialized.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_index_cache_init(aerospike_sindex_cache* cache_p)
+{
+    pthread_rwlock_init(&cache_p->lock, NULL);
+    cache_p->sindexes_p = NULL;
+    cache_p->count = 0;
+    cache_p->refreshed_at = 0;
+}
+
+/*
+ *******************************************************************************************************
+ * Releases the secondary indexes held by a cache.
+ *
+ * @param cache_p               The cache to be destroyed.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_index_cache_destroy(aerospike_sindex_cache* cache_p)
+{
+    if (cache_p->sindexes_p) {
+        free(cache_p->sindexes_p);
+        cache_p->sindexes_p = NULL;
+    }
+    cache_p->count = 0;
+    cache_p->refreshed_at = 0;
+    pthread_rwlock_destroy(&cache_p->lock);
+}
+
+/*
+ *******************************************************************************************************
+ * Marks a secondary index cache as stale, so that it is reloaded on its next
+ * use. Called after an index is created or dropped through this client.
+ *
+ * @param cache_p               The cache to be invalidated.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_index_cache_invalidate(aerospike_sindex_cache* cache_p)
+{
+    pthread_rwlock_wrlock(&cache_p->lock);
+    cache_p->refreshed_at = 0;
+    pthread_rwlock_unlock(&cache_p->lock);
+}
+
+/*
+ *******************************************************************************************************
+ * Copies the value of a field of a sindex info entry, if it has the given key.
+ *
+ * @return true if the field has the key.
+ *******************************************************************************************************
+ */
+static bool
+aerospike_index_cache_field(char* field_p, const char* key_p, char* value_p,
+        size_t value_size)
+{
+    size_t                      key_len = strlen(key_p);
+
+    if (strncmp(field_p, key_p, key_len) != 0) {
+        return false;
+    }
+    strncpy(value_p, field_p + key_len, value_size - 1);
+    value_p[value_size - 1] = '\0';
+    return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Parses a sindex info entry, such as
+ * ns=test:set=demo:indexname=idx:num_bins=1:bins=bin2:type=NUMERIC:...
+ *
+ * @param entry_p               The entry, modified by the parsing.
+ * @param sindex_p              The index to be populated.
+ *
+ * @return true if the entry is an index on a string or integer bin.
+ *******************************************************************************************************
+ */
+static bool
+aerospike_index_cache_parse(char* entry_p, aerospike_sindex* sindex_p)
+{
+    char*                       field_p = NULL;
+    char*                       save_p = NULL;
+    char                        type[16] = {0};
+
+    memset(sindex_p, 0, sizeof(aerospike_sindex));
+    for (field_p = strtok_r(entry_p, INDEX_INFO_FIELD_DELIMITER, &save_p);
+            field_p;
+            field_p = strtok_r(NULL, INDEX_INFO_FIELD_DELIMITER, &save_p)) {
+        if (!aerospike_index_cache_field(field_p, INDEX_INFO_NS,
+                    sindex_p->ns, sizeof(sindex_p->ns)) &&
+                !aerospike_index_cache_field(field_p, INDEX_INFO_SET,
+                    sindex_p->set, sizeof(sindex_p->set)) &&
+                !aerospike_index_cache_field(field_p, INDEX_INFO_NAME,
+                    sindex_p->name, sizeof(sindex_p->name)) &&
+                !aerospike_index_cache_field(field_p, INDEX_INFO_BINS,
+                    sindex_p->bin, sizeof(sindex_p->bin)) &&
+                !aerospike_index_cache_field(field_p, INDEX_INFO_BIN,
+                    sindex_p->bin, sizeof(sindex_p->bin))) {
+            aerospike_index_cache_field(field_p, INDEX_INFO_TYPE, type, sizeof(type));
+        }
+    }
+
+    if (strcmp(sindex_p->set, INDEX_INFO_NO_SET) == 0) {
+        sindex_p->set[0] = '\0';
+    }
+    if (strcasecmp(type, INDEX_INFO_TYPE_NUMERIC) == 0) {
+        sindex_p->type = INDEX_TYPE_INTEGER;
+    } else if (strcasecmp(type, INDEX_INFO_TYPE_STRING) == 0) {
+        sindex_p->type = INDEX_TYPE_STRING;
+    } else {
+        return false;
+    }
+    return (sindex_p->ns[0] != '\0' && sindex_p->bin[0] != '\0');
+}
+
+/*
+ *******************************************************************************************************
+ * Callback for aerospike_info_foreach on the sindex info command. The index
+ * metadata is replicated to every node, so the first response is parsed into
+ * the array of indexes and the other nodes are skipped.
+ *
+ * @return false to stop once the indexes are parsed.
+ *******************************************************************************************************
+ */
+static bool
+aerospike_index_cache_callback(const as_error* err, const as_node* node,
+        char* request, char* response, void* udata)
+{
+    aerospike_sindex_cache*     parsed_p = (aerospike_sindex_cache *) udata;
+    char*                       entries_p = NULL;
+    char*                       entry_p = NULL;
+    char*                       save_p = NULL;
+    uint32_t                    max_count = 1;
+
+    if (!response) {
+        return true;
+    }
+
+    if ((entries_p = strchr(response, '\t'))) {
+        entries_p++;
+    } else {
+        entries_p = response;
+    }
+    entries_p[strcspn(entries_p, "\n")] = '\0';
+
+    for (entry_p = entries_p; *entry_p; entry_p++) {
+        if (*entry_p == INDEX_INFO_ENTRY_DELIMITER[0]) {
+            max_count++;
+        }
+    }
+    parsed_p->sindexes_p = (aerospike_sindex *) malloc(max_count * sizeof(aerospike_sindex));
+    parsed_p->count = 0;
+    if (!parsed_p->sindexes_p) {
+        return false;
+    }
+
+    for (entry_p = strtok_r(entries_p, INDEX_INFO_ENTRY_DELIMITER, &save_p);
+            entry_p;
+            entry_p = strtok_r(NULL, INDEX_INFO_ENTRY_DELIMITER, &save_p)) {
+        if (aerospike_index_cache_parse(entry_p,
+                    &parsed_p->sindexes_p[parsed_p->count])) {
+            parsed_p->count++;
+        }
+    }
+    parsed_p->refreshed_at = time(NULL);
+    return false;
+}
+
+/*
+ *******************************************************************************************************
+ * Reloads a secondary index cache with the sindex info command, if it is
+ * older than aerospike.sindex_cache_ttl seconds or if forced.
+ *
+ * @param as_object_p           The C client's aerospike object.
+ * @param error_p               The as_error to be populated by the function
+ *                              with the encountered error if any.
+ * @param cache_p               The cache to be refreshed.
+ * @param force                 Whether to reload a cache which is not stale.
+ * @param options_p             The user's optional policy options to be used if set, else defaults.
+ *
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_index_cache_refresh(aerospike* as_object_p, as_error* error_p,
+        aerospike_sindex_cache* cache_p, bool force, zval* options_p TSRMLS_DC)
+{
+    as_policy_info              info_policy;
+    aerospike_sindex_cache      parsed;
+    time_t                      now = time(NULL);
+    long                        ttl = SINDEX_CACHE_TTL_PHP_INI;
+    bool                        is_fresh = false;
+
+    memset(&parsed, 0, sizeof(parsed));
+
+    pthread_rwlock_rdlock(&cache_p->lock);
+    is_fresh = (cache_p->refreshed_at != 0) && (now - cache_p->refreshed_at < ttl);
+    pthread_rwlock_unlock(&cache_p->lock);
+    if (is_fresh && !force) {
+        goto exit;
+    }
+
+    set_policy(NULL, NULL, NULL, NULL, &info_policy, NULL, NULL, NULL,
+            options_p, error_p TSRMLS_CC);
+    if (AEROSPIKE_OK != (error_p->code)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+        goto exit;
+    }
+
+    aerospike_info_foreach(as_object_p, error_p, &info_policy,
+            INDEX_INFO_REQUEST, aerospike_index_cache_callback, &parsed);
+    if (parsed.refreshed_at == 0) {
+        if (AEROSPIKE_OK == error_p->code) {
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+                    "Unable to load the secondary indexes");
+        }
+        DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+        goto exit;
+    }
+    /*
+     * The callback stops the iteration once the indexes are parsed.
+     */
+    PHP_EXT_SET_AS_ERR(error_p, DEFAULT_ERRORNO, DEFAULT_ERROR);
+
+    pthread_rwlock_wrlock(&cache_p->lock);
+    if (cache_p->sindexes_p) {
+        free(cache_p->sindexes_p);
+    }
+    cache_p->sindexes_p = parsed.sindexes_p;
+    cache_p->count = parsed.count;
+    cache_p->refreshed_at = parsed.refreshed_at;
+    parsed.sindexes_p = NULL;
+    pthread_rwlock_unlock(&cache_p->lock);
+
+exit:
+    if (parsed.sindexes_p) {
+        free(parsed.sindexes_p);
+    }
+    return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Checks whether a secondary index cache may be reloaded on a lookup miss,
+ * which it may once it is at least SINDEX_CACHE_MIN_RELOAD_SEC old, so that
+ * queries on a bin without an index do not each send the sindex info
+ * command.
+ *
+ * @param cache_p               The cache of the secondary indexes.
+ *
+ * @return true if the cache may be reloaded.
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_index_cache_is_reloadable(aerospike_sindex_cache* cache_p)
+{
+    bool                        is_reloadable = false;
+
+    pthread_rwlock_rdlock(&cache_p->lock);
+    is_reloadable = (cache_p->refreshed_at == 0) ||
+        (time(NULL) - cache_p->refreshed_at >= SINDEX_CACHE_MIN_RELOAD_SEC);
+    pthread_rwlock_unlock(&cache_p->lock);
+    return is_reloadable;
+}
+
+/*
+ *******************************************************************************************************
+ * Checks whether a secondary index can serve a query on a bin. An index on
+ * the whole namespace serves every set.
+ *
+ * @param cache_p               The cache of the secondary indexes.
+ * @param ns_p                  The namespace of the query.
+ * @param set_p                 The set of the query.
+ * @param bin_p                 The bin of the predicate.
+ * @param type                  The INDEX_TYPE_* of the predicate value, or -1
+ *                              to accept any type.
+ *
+ * @return true if an index matches, or if the cache is not loaded.
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_index_cache_lookup(aerospike_sindex_cache* cache_p, char* ns_p,
+        char* set_p, char* bin_p, int type)
+{
+    aerospike_sindex*           sindex_p = NULL;
+    uint32_t                    i;
+    bool                        is_found = false;
+
+    pthread_rwlock_rdlock(&cache_p->lock);
+    if (cache_p->refreshed_at == 0) {
+        is_found = true;
+    }
+    for (i = 0; !is_found && i < cache_p->count; i++) {
+        sindex_p = &cache_p->sindexes_p[i];
+        if ((strcmp(sindex_p->ns, ns_p) == 0) &&
+                (strcmp(sindex_p->bin, bin_p) == 0) &&
+                (sindex_p->set[0] == '\0' || !set_p || set_p[0] == '\0' ||
+                 strcmp(sindex_p->set, set_p) == 0) &&
+                (type < 0 || sindex_p->type == (uint32_t) type)) {
+            is_found = true;
+        }
+    }
+    pthread_rwlock_unlock(&cache_p->lock);
+    return is_found;
+}
+
+/*
+ *******************************************************************************************************
+ * Appends the cached secondary indexes to an array, each as an array of its
+ * ns, set, name, bin and type.
+ *
+ * @param cache_p               The cache of the secondary indexes.
+ * @param ns_p                  The namespace to list the indexes of, or NULL
+ *                              for every namespace.
+ * @param indexes_p             The array to be populated.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_index_cache_list(aerospike_sindex_cache* cache_p, char* ns_p,
+        zval* indexes_p)
+{
+    aerospike_sindex*           sindex_p = NULL;
+    zval*                       index_p = NULL;
+    uint32_t                    i;
+
+    pthread_rwlock_rdlock(&cache_p->lock);
+    for (i = 0; i < cache_p->count; i++) {
+        sindex_p = &cache_p->sindexes_p[i];
+        if (ns_p && strcmp(sindex_p->ns, ns_p) != 0) {
+            continue;
+        }
+        MAKE_STD_ZVAL(index_p);
+        array_init(index_p);
+        add_assoc_string(index_p, INDEX_NS, sindex_p->ns, 1);
+        if (sindex_p->set[0] != '\0') {
+            add_assoc_string(index_p, INDEX_SET, sindex_p->set, 1);
+        } else {
+            add_assoc_null(index_p, INDEX_SET);
+        }
+        add_assoc_string(index_p, INDEX_NAME, sindex_p->name, 1);
+        add_assoc_string(index_p, INDEX_BIN, sindex_p->bin, 1);
+        add_assoc_long(index_p, INDEX_TYPE, sindex_p->type);
+        add_next_index_zval(indexes_p, index_p);
+    }
+    pthread_rwlock_unlock(&cache_p->lock);
+}
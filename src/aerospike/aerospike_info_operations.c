@@ -5,6 +5,8 @@
 #include "aerospike/as_record.h"
 #include "aerospike/aerospike_info.h"
 #include <arpa/inet.h>
+#include <errno.h>
+#include <inttypes.h>
 
 #include "aerospike_common.h"
 #include "aerospike_policy.h"
@@ -14,6 +16,26 @@
 #define INFO_RESPONSE_END "\n"
 #define HOST_DELIMITER ";"
 #define IP_PORT_DELIMITER ":"
+#define INFO_ENTRY_DELIMITER ";"
+#define INFO_FIELD_DELIMITER ":"
+#define INFO_KEY_VALUE_DELIMITER '='
+
+/*
+ * Info protocol of the jobs of a node (server >= 3.6), their fields, and the
+ * keys of the job info returned by Aerospike::jobInfo().
+ */
+#define JOB_MODULE_SCAN "scan"
+#define JOB_MODULE_QUERY "query"
+#define JOB_REQUEST_MAX_LEN 256
+#define JOB_TRID "trid"
+#define JOB_STATUS "status"
+#define JOB_PROGRESS "job-progress"
+#define JOB_STATUS_ACTIVE "active"
+#define JOB_STATUS_ABORTED "abort"
+#define JOB_RESPONSE_OK "ok"
+#define JOB_INFO_STATUS "status"
+#define JOB_INFO_PROGRESS_PCT "progress_pct"
+#define JOB_INFO_NODES "nodes"
 
 /*
  *******************************************************************************************************
@@ -41,6 +63,7 @@ aerospike_info_specific_host(aerospike* as_object_p,
     char*                       address = (char *) as_object_p->config.hosts[0].addr;
     long                        port_no = as_object_p->config.hosts[0].port;
     char*                       response_p = NULL;
+    uint64_t                    started_at = 0;
 
     set_policy(NULL, NULL, NULL, NULL, &info_policy, NULL, NULL, NULL,
             options_p, error_p TSRMLS_CC);
@@ -78,9 +101,12 @@ aerospike_info_specific_host(aerospike* as_object_p,
         port_no = Z_LVAL_PP(port);
     }
 
-    if (AEROSPIKE_OK != aerospike_info_host(as_object_p, error_p, &info_policy,
-                (const char *) address, (uint16_t) port_no, request_str_p,
-                &response_p)) {
+    started_at = aerospike_latency_now();
+    aerospike_info_host(as_object_p, error_p, &info_policy,
+            (const char *) address, (uint16_t) port_no, request_str_p,
+            &response_p);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_INFO, NULL, started_at);
+    if (AEROSPIKE_OK != error_p->code) {
             DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
             goto exit;
     }
@@ -95,6 +121,197 @@ exit:
     return error_p->code;
 }
 
+/*
+ *******************************************************************************************************
+ * Helper function to add a single info value to an array, converting it to
+ * the closest PHP type: integers and doubles become numbers, "true" and
+ * "false" become booleans, everything else is kept as a string.
+ *
+ * @param array_p               The array zval to which the value is added.
+ * @param key_p                 The key under which to add the value. If NULL,
+ *                              the value is appended to the array.
+ * @param value_p               The NULL terminated value string.
+ *
+ *******************************************************************************************************
+ */
+static void
+aerospike_info_add_typed_value(zval* array_p, char* key_p, char* value_p)
+{
+    char*                       end_p = NULL;
+    long                        lval = 0;
+    double                      dval = 0;
+    zval*                       value_zval_p = NULL;
+
+    MAKE_STD_ZVAL(value_zval_p);
+
+    if (*value_p == '\0') {
+        ZVAL_STRINGL(value_zval_p, "", 0, 1);
+    } else if (0 == strcmp(value_p, "true")) {
+        ZVAL_BOOL(value_zval_p, 1);
+    } else if (0 == strcmp(value_p, "false")) {
+        ZVAL_BOOL(value_zval_p, 0);
+    } else {
+        errno = 0;
+        lval = strtol(value_p, &end_p, 10);
+        if (*end_p == '\0' && errno != ERANGE) {
+            ZVAL_LONG(value_zval_p, lval);
+        } else {
+            errno = 0;
+            dval = strtod(value_p, &end_p);
+            if (*end_p == '\0' && errno != ERANGE &&
+                    strpbrk(value_p, ".eE") && !strpbrk(value_p, "xXnN")) {
+                ZVAL_DOUBLE(value_zval_p, dval);
+            } else {
+                ZVAL_STRINGL(value_zval_p, value_p, strlen(value_p), 1);
+            }
+        }
+    }
+
+    if (key_p) {
+        add_assoc_zval(array_p, key_p, value_zval_p);
+    } else {
+        add_next_index_zval(array_p, value_zval_p);
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Helper function to check whether an info entry is a record made up only of
+ * colon separated key=value fields, such as the entries returned by the sets
+ * and sindex commands (ns=test:set=demo:objects=10).
+ *
+ * @param entry_p               The NULL terminated info entry.
+ *
+ * @return true if every colon separated field contains a key=value pair.
+ *******************************************************************************************************
+ */
+static bool
+aerospike_info_is_record_entry(char* entry_p)
+{
+    char*                       field_p = entry_p;
+    char*                       next_p = NULL;
+
+    if (!strstr(entry_p, INFO_FIELD_DELIMITER)) {
+        return false;
+    }
+
+    while (field_p) {
+        next_p = strstr(field_p, INFO_FIELD_DELIMITER);
+        if (field_p == next_p) {
+            return false;
+        }
+        if (!memchr(field_p, INFO_KEY_VALUE_DELIMITER,
+                    next_p ? (size_t) (next_p - field_p) : strlen(field_p))) {
+            return false;
+        }
+        field_p = next_p ? next_p + 1 : NULL;
+    }
+    return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Parses a raw info response into a nested PHP array.
+ * The response is split into semicolon separated entries:
+ * - key=value entries (statistics, namespace/<ns>, get-config) are added to
+ *   the array as typed values keyed by name.
+ * - colon separated key=value records (sets, sindex) are added as nested
+ *   arrays appended to the array in the order returned by the server.
+ * - plain entries (namespaces, sets of names) are appended as typed values.
+ *
+ * @param response_p            The NULL terminated info response. It is
+ *                              modified in place by the parser.
+ * @param parsed_p              The array zval to be populated with the
+ *                              parsed entries.
+ *
+ *******************************************************************************************************
+ */
+static void
+aerospike_info_parse_response(char* response_p, zval* parsed_p)
+{
+    char*                       entry_p = NULL;
+    char*                       entry_saved_p = NULL;
+    char*                       field_p = NULL;
+    char*                       field_saved_p = NULL;
+    char*                       value_p = NULL;
+    char*                       end_p = NULL;
+    zval*                       record_p = NULL;
+
+    /*
+     * The response is of the form "request\tvalue\n", strip the echoed
+     * request and the trailing newline.
+     */
+    if ((value_p = strstr(response_p, INFO_REQUEST_RESPONSE_DELIMITER))) {
+        response_p = value_p + 1;
+    }
+    if ((end_p = strstr(response_p, INFO_RESPONSE_END))) {
+        *end_p = '\0';
+    }
+
+    for (entry_p = strtok_r(response_p, INFO_ENTRY_DELIMITER, &entry_saved_p);
+            entry_p != NULL;
+            entry_p = strtok_r(NULL, INFO_ENTRY_DELIMITER, &entry_saved_p)) {
+        if (aerospike_info_is_record_entry(entry_p)) {
+            MAKE_STD_ZVAL(record_p);
+            array_init(record_p);
+            for (field_p = strtok_r(entry_p, INFO_FIELD_DELIMITER, &field_saved_p);
+                    field_p != NULL;
+                    field_p = strtok_r(NULL, INFO_FIELD_DELIMITER, &field_saved_p)) {
+                value_p = strchr(field_p, INFO_KEY_VALUE_DELIMITER);
+                *value_p = '\0';
+                aerospike_info_add_typed_value(record_p, field_p, value_p + 1);
+            }
+            add_next_index_zval(parsed_p, record_p);
+        } else if ((value_p = strchr(entry_p, INFO_KEY_VALUE_DELIMITER))) {
+            *value_p = '\0';
+            aerospike_info_add_typed_value(parsed_p, entry_p, value_p + 1);
+        } else {
+            aerospike_info_add_typed_value(parsed_p, NULL, entry_p);
+        }
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Wrapper function to perform an aerospike_info_host within the C client and
+ * return the response parsed into a nested array of typed values.
+ *
+ * @param as_object_p           The C client's aerospike object.
+ * @param error_p               The as_error to be populated by the function
+ *                              with the encountered error if any.
+ * @param request_str_p         The request string for info.
+ * @param response_p            The response zval to be initialized as an array
+ *                              and populated with the parsed info response.
+ * @param host                  The optional host array containing a single addr and port.
+ * @param options_p             The user's optional policy options to be used if set, else defaults.
+ *
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_info_specific_host_parsed(aerospike* as_object_p,
+        as_error* error_p, char* request_str_p,
+        zval* response_p, zval* host, zval* options_p TSRMLS_DC)
+{
+    zval*                       raw_response_p = NULL;
+
+    MAKE_STD_ZVAL(raw_response_p);
+    ZVAL_NULL(raw_response_p);
+
+    if (AEROSPIKE_OK !=
+            aerospike_info_specific_host(as_object_p, error_p,
+                    request_str_p, raw_response_p, host, options_p TSRMLS_CC)) {
+        DEBUG_PHP_EXT_DEBUG("infoParsed: info call returned an error");
+        goto exit;
+    }
+
+    array_init(response_p);
+    aerospike_info_parse_response(Z_STRVAL_P(raw_response_p), response_p);
+
+exit:
+    zval_ptr_dtor(&raw_response_p);
+    return error_p->code;
+}
+
 /*
  *******************************************************************************************************
  * Helper function to get all nodes within the cluster.
@@ -394,6 +611,7 @@ aerospike_info_request_multiple_nodes(aerospike* as_object_p,
     foreach_callback_info_udata     info_callback_udata;
     as_policy_info                  info_policy;
     HashTable*                      host_lookup_p = NULL;
+    uint64_t                        started_at = 0;
 
     if ((!request_str_p)) {
         PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
@@ -435,10 +653,12 @@ aerospike_info_request_multiple_nodes(aerospike* as_object_p,
     info_callback_udata.udata_p = return_value_p;
     info_callback_udata.host_lookup_p = host_lookup_p;
 
-    if (AEROSPIKE_OK != aerospike_info_foreach(as_object_p, error_p,
-                &info_policy, request_str_p,
-                (aerospike_info_foreach_callback) aerospike_info_callback,
-                &info_callback_udata)) {
+    started_at = aerospike_latency_now();
+    aerospike_info_foreach(as_object_p, error_p, &info_policy, request_str_p,
+            (aerospike_info_foreach_callback) aerospike_info_callback,
+            &info_callback_udata);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_INFO, NULL, started_at);
+    if (AEROSPIKE_OK != error_p->code) {
         DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
         goto exit;
     }
@@ -451,3 +671,470 @@ exit:
     }
     return error_p->code;
 }
+
+/*
+ *******************************************************************************************************
+ * State of an info request on the jobs of every node of the cluster.
+ *******************************************************************************************************
+ */
+typedef struct foreach_callback_jobs_udata_t {
+    zval*       jobs_p;
+    uint64_t    job_id;
+    uint32_t    nodes_ok;
+} foreach_callback_jobs_udata;
+
+/*
+ *******************************************************************************************************
+ * Helper function to check whether a module is one of the job modules
+ * Aerospike::JOB_SCAN and Aerospike::JOB_QUERY.
+ *******************************************************************************************************
+ */
+static bool
+aerospike_info_is_job_module(char* module_p)
+{
+    return module_p && ((0 == strcmp(module_p, JOB_MODULE_SCAN)) ||
+            (0 == strcmp(module_p, JOB_MODULE_QUERY)));
+}
+
+/*
+ *******************************************************************************************************
+ * Helper function to compare the trid of a parsed job to a job id. The trid
+ * is a string if it does not fit into a PHP integer.
+ *******************************************************************************************************
+ */
+static bool
+aerospike_info_is_job(zval* trid_p, uint64_t job_id)
+{
+    if (Z_TYPE_P(trid_p) == IS_LONG) {
+        return (uint64_t) Z_LVAL_P(trid_p) == job_id;
+    }
+    if (Z_TYPE_P(trid_p) == IS_STRING) {
+        return strtoull(Z_STRVAL_P(trid_p), NULL, 10) == job_id;
+    }
+    return false;
+}
+
+/*
+ *******************************************************************************************************
+ * Callback for aerospike_info_foreach on a jobs listing. Parses the jobs of
+ * the node and appends the ones matching the job id, if any, to the array of
+ * the node keyed by its node ID.
+ *
+ * @return true to continue with the next node.
+ *******************************************************************************************************
+ */
+static bool
+aerospike_info_jobs_callback(const as_error* err, const as_node* node,
+        char* request, char* response, void* udata)
+{
+    foreach_callback_jobs_udata*    jobs_udata_p = (foreach_callback_jobs_udata *) udata;
+    char*                           response_copy_p = NULL;
+    zval*                           parsed_p = NULL;
+    zval*                           node_jobs_p = NULL;
+    zval**                          node_jobs_pp = NULL;
+    zval**                          job_pp = NULL;
+    zval**                          trid_pp = NULL;
+    HashPosition                    pos;
+
+    if (!node || !response) {
+        return true;
+    }
+
+    if (SUCCESS == zend_hash_find(Z_ARRVAL_P(jobs_udata_p->jobs_p), node->name,
+                strlen(node->name) + 1, (void **) &node_jobs_pp)) {
+        node_jobs_p = *node_jobs_pp;
+    } else {
+        MAKE_STD_ZVAL(node_jobs_p);
+        array_init(node_jobs_p);
+        add_assoc_zval(jobs_udata_p->jobs_p, (char *) node->name, node_jobs_p);
+    }
+
+    response_copy_p = estrdup(response);
+    MAKE_STD_ZVAL(parsed_p);
+    array_init(parsed_p);
+    aerospike_info_parse_response(response_copy_p, parsed_p);
+
+    foreach_hashtable(Z_ARRVAL_P(parsed_p), pos, job_pp) {
+        if ((Z_TYPE_PP(job_pp) != IS_ARRAY) ||
+                (SUCCESS != zend_hash_find(Z_ARRVAL_PP(job_pp), JOB_TRID,
+                    sizeof(JOB_TRID), (void **) &trid_pp))) {
+            continue;
+        }
+        if (jobs_udata_p->job_id && !aerospike_info_is_job(*trid_pp, jobs_udata_p->job_id)) {
+            continue;
+        }
+        Z_ADDREF_PP(job_pp);
+        add_next_index_zval(node_jobs_p, *job_pp);
+    }
+
+    zval_ptr_dtor(&parsed_p);
+    efree(response_copy_p);
+    return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Callback for aerospike_info_foreach on a job command, such as kill-job.
+ * Counts the nodes which acknowledged the command. A node which does not know
+ * the job, for example because its part of the job is already over, replies
+ * with an error.
+ *
+ * @return true to continue with the next node.
+ *******************************************************************************************************
+ */
+static bool
+aerospike_info_job_command_callback(const as_error* err, const as_node* node,
+        char* request, char* response, void* udata)
+{
+    foreach_callback_jobs_udata*    jobs_udata_p = (foreach_callback_jobs_udata *) udata;
+    char*                           value_p = NULL;
+
+    if (!response) {
+        return true;
+    }
+    if ((value_p = strstr(response, INFO_REQUEST_RESPONSE_DELIMITER))) {
+        value_p++;
+    } else {
+        value_p = response;
+    }
+    if (0 == strncasecmp(value_p, JOB_RESPONSE_OK, sizeof(JOB_RESPONSE_OK) - 1)) {
+        jobs_udata_p->nodes_ok++;
+    }
+    return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Sends an info request on jobs to every node of the cluster.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the
+ *                                  encountered error.
+ * @param request_p                 The jobs request string.
+ * @param callback                  The callback for the response of each node.
+ * @param jobs_udata_p              The state of the request.
+ * @param options_p                 Options array with read timeout.
+ *
+ *******************************************************************************************************
+ */
+static as_status
+aerospike_info_jobs_request(aerospike* as_object_p, as_error* error_p,
+        char* request_p, aerospike_info_foreach_callback callback,
+        foreach_callback_jobs_udata* jobs_udata_p, zval* options_p TSRMLS_DC)
+{
+    as_policy_info                  info_policy;
+
+    set_policy(NULL, NULL, NULL, NULL, &info_policy, NULL, NULL, NULL,
+            options_p, error_p TSRMLS_CC);
+    if (AEROSPIKE_OK != (error_p->code)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+        goto exit;
+    }
+
+    if (AEROSPIKE_OK != aerospike_info_foreach(as_object_p, error_p,
+                &info_policy, request_p, callback, jobs_udata_p)) {
+        DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+        goto exit;
+    }
+exit:
+    return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Lists the scan and query jobs running or recently finished on every node.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the
+ *                                  encountered error.
+ * @param module_p                  One of "scan" and "query", or NULL for both.
+ * @param job_id                    The job to be listed, or 0 for every job.
+ * @param jobs_p                    The array to be populated with the jobs of
+ *                                  each node keyed by node ID.
+ * @param options_p                 Options array with read timeout.
+ *
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_info_jobs_list(aerospike* as_object_p, as_error* error_p,
+        char* module_p, uint64_t job_id, zval* jobs_p, zval* options_p TSRMLS_DC)
+{
+    foreach_callback_jobs_udata     jobs_udata;
+    char                            request[JOB_REQUEST_MAX_LEN];
+    char*                           modules[] = {JOB_MODULE_SCAN, JOB_MODULE_QUERY};
+    int                             i;
+
+    if (module_p && !aerospike_info_is_job_module(module_p)) {
+        DEBUG_PHP_EXT_DEBUG("Job module must be one of Aerospike::JOB_SCAN and Aerospike::JOB_QUERY");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                "Job module must be one of Aerospike::JOB_SCAN and Aerospike::JOB_QUERY");
+        goto exit;
+    }
+
+    jobs_udata.jobs_p = jobs_p;
+    jobs_udata.job_id = job_id;
+    jobs_udata.nodes_ok = 0;
+
+    for (i = 0; i < 2; i++) {
+        if (module_p && strcmp(module_p, modules[i])) {
+            continue;
+        }
+        snprintf(request, JOB_REQUEST_MAX_LEN, "jobs:module=%s", modules[i]);
+        if (AEROSPIKE_OK != aerospike_info_jobs_request(as_object_p, error_p,
+                    request, aerospike_info_jobs_callback, &jobs_udata,
+                    options_p TSRMLS_CC)) {
+            goto exit;
+        }
+    }
+exit:
+    return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Gets the status of a scan or query job, summarized over the nodes of the
+ * cluster: the job is in progress while any node is still running it, and
+ * aborted if any node aborted it. The progress is the average progress over
+ * the nodes running the job.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the
+ *                                  encountered error.
+ * @param module_p                  One of "scan" and "query".
+ * @param job_id                    The job id.
+ * @param info_p                    The array to be populated with the status,
+ *                                  progress_pct and per node status of the job.
+ * @param options_p                 Options array with read timeout.
+ *
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_info_job_get(aerospike* as_object_p, as_error* error_p,
+        char* module_p, uint64_t job_id, zval* info_p, zval* options_p TSRMLS_DC)
+{
+    zval*                           nodes_p = NULL;
+    zval**                          node_jobs_pp = NULL;
+    zval**                          job_pp = NULL;
+    zval**                          field_pp = NULL;
+    HashPosition                    nodes_pos;
+    HashPosition                    jobs_pos;
+    long                            status = AS_SCAN_STATUS_UNDEF;
+    double                          progress = 0;
+    uint32_t                        jobs_count = 0;
+
+    if (!aerospike_info_is_job_module(module_p)) {
+        DEBUG_PHP_EXT_DEBUG("Job module must be one of Aerospike::JOB_SCAN and Aerospike::JOB_QUERY");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                "Job module must be one of Aerospike::JOB_SCAN and Aerospike::JOB_QUERY");
+        goto exit;
+    }
+
+    MAKE_STD_ZVAL(nodes_p);
+    array_init(nodes_p);
+    if (AEROSPIKE_OK != aerospike_info_jobs_list(as_object_p, error_p,
+                module_p, job_id, nodes_p, options_p TSRMLS_CC)) {
+        zval_ptr_dtor(&nodes_p);
+        goto exit;
+    }
+
+    foreach_hashtable(Z_ARRVAL_P(nodes_p), nodes_pos, node_jobs_pp) {
+        foreach_hashtable(Z_ARRVAL_PP(node_jobs_pp), jobs_pos, job_pp) {
+            jobs_count++;
+            if ((SUCCESS == zend_hash_find(Z_ARRVAL_PP(job_pp), JOB_PROGRESS,
+                            sizeof(JOB_PROGRESS), (void **) &field_pp)) &&
+                    ((Z_TYPE_PP(field_pp) == IS_LONG) || (Z_TYPE_PP(field_pp) == IS_DOUBLE))) {
+                progress += (Z_TYPE_PP(field_pp) == IS_LONG) ?
+                    (double) Z_LVAL_PP(field_pp) : Z_DVAL_PP(field_pp);
+            }
+            if ((SUCCESS != zend_hash_find(Z_ARRVAL_PP(job_pp), JOB_STATUS,
+                            sizeof(JOB_STATUS), (void **) &field_pp)) ||
+                    (Z_TYPE_PP(field_pp) != IS_STRING)) {
+                continue;
+            }
+            if (0 == strncmp(Z_STRVAL_PP(field_pp), JOB_STATUS_ACTIVE,
+                        sizeof(JOB_STATUS_ACTIVE) - 1)) {
+                status = AS_SCAN_STATUS_INPROGRESS;
+            } else if (strstr(Z_STRVAL_PP(field_pp), JOB_STATUS_ABORTED)) {
+                if (status != AS_SCAN_STATUS_INPROGRESS) {
+                    status = AS_SCAN_STATUS_ABORTED;
+                }
+            } else if (status == AS_SCAN_STATUS_UNDEF) {
+                status = AS_SCAN_STATUS_COMPLETED;
+            }
+        }
+    }
+
+    add_assoc_long(info_p, JOB_INFO_STATUS, status);
+    add_assoc_long(info_p, JOB_INFO_PROGRESS_PCT,
+            jobs_count ? (long) (progress / jobs_count) : 0);
+    add_assoc_zval(info_p, JOB_INFO_NODES, nodes_p);
+exit:
+    return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Sends a command on a scan or query job to every node of the cluster.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the
+ *                                  encountered error.
+ * @param module_p                  One of "scan" and "query".
+ * @param job_id                    The job id.
+ * @param command_p                 The command and its arguments, such as
+ *                                  "kill-job" or "set-priority;value=1".
+ * @param options_p                 Options array with read timeout.
+ *
+ * @return AEROSPIKE_ERR_REQUEST_INVALID if no node knows the job.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_info_job_command(aerospike* as_object_p, as_error* error_p,
+        char* module_p, uint64_t job_id, char* command_p, zval* options_p TSRMLS_DC)
+{
+    foreach_callback_jobs_udata     jobs_udata;
+    char                            request[JOB_REQUEST_MAX_LEN];
+
+    if (!aerospike_info_is_job_module(module_p)) {
+        DEBUG_PHP_EXT_DEBUG("Job module must be one of Aerospike::JOB_SCAN and Aerospike::JOB_QUERY");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                "Job module must be one of Aerospike::JOB_SCAN and Aerospike::JOB_QUERY");
+        goto exit;
+    }
+
+    jobs_udata.jobs_p = NULL;
+    jobs_udata.job_id = job_id;
+    jobs_udata.nodes_ok = 0;
+
+    snprintf(request, JOB_REQUEST_MAX_LEN, "jobs:module=%s;cmd=%s;trid=%" PRIu64,
+            module_p, command_p, job_id);
+    if (AEROSPIKE_OK != aerospike_info_jobs_request(as_object_p, error_p,
+                request, aerospike_info_job_command_callback, &jobs_udata,
+                options_p TSRMLS_CC)) {
+        goto exit;
+    }
+
+    if (!jobs_udata.nodes_ok) {
+        DEBUG_PHP_EXT_DEBUG("No node of the cluster has the job");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_REQUEST_INVALID,
+                "No node of the cluster has the job");
+    }
+exit:
+    return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * State of an info request on the progress of a task on every node.
+ *******************************************************************************************************
+ */
+typedef struct foreach_callback_task_udata_t {
+    zval*                           nodes_p;
+    aerospike_info_task_match_fn    match_fn;
+    void*                           match_udata_p;
+    char*                           progress_key_p;
+    long                            progress_pct;
+} foreach_callback_task_udata;
+
+/*
+ *******************************************************************************************************
+ * Callback for aerospike_info_foreach on the progress of a task. The progress
+ * of the node is the integer value following the progress key in its
+ * response if there is one, otherwise 100 if the match function accepts the
+ * response and 0 if not.
+ *
+ * @return true to continue with the next node.
+ *******************************************************************************************************
+ */
+static bool
+aerospike_info_task_callback(const as_error* err, const as_node* node,
+        char* request, char* response, void* udata)
+{
+    foreach_callback_task_udata*    task_udata_p = (foreach_callback_task_udata *) udata;
+    char*                           value_p = NULL;
+    long                            progress_pct = 0;
+
+    if (!node) {
+        return true;
+    }
+
+    if (response) {
+        if (task_udata_p->progress_key_p) {
+            if ((value_p = strstr(response, task_udata_p->progress_key_p))) {
+                progress_pct = strtol(value_p + strlen(task_udata_p->progress_key_p), NULL, 10);
+            }
+        } else if (task_udata_p->match_fn(response, task_udata_p->match_udata_p)) {
+            progress_pct = 100;
+        }
+    }
+
+    if (progress_pct < task_udata_p->progress_pct) {
+        task_udata_p->progress_pct = progress_pct;
+    }
+    add_assoc_long(task_udata_p->nodes_p, (char *) node->name, progress_pct);
+    return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Gets the progress of a task, such as an index build or a UDF module
+ * registration, on every node of the cluster. The task is done once it is
+ * done on every node.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the
+ *                                  encountered error.
+ * @param request_p                 The info request on the task.
+ * @param match_fn                  The function checking whether the response
+ *                                  of a node shows the task is done on it, if
+ *                                  progress_key_p is NULL.
+ * @param match_udata_p             The user data of match_fn.
+ * @param progress_key_p            The key of the progress percentage of the
+ *                                  task in the response, or NULL.
+ * @param status_p                  The array to be populated with done,
+ *                                  progress_pct and the progress of each node.
+ * @param options_p                 Options array with read timeout.
+ *
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_info_task_status(aerospike* as_object_p, as_error* error_p,
+        char* request_p, aerospike_info_task_match_fn match_fn, void* match_udata_p,
+        char* progress_key_p, zval* status_p, zval* options_p TSRMLS_DC)
+{
+    foreach_callback_task_udata     task_udata;
+    as_policy_info                  info_policy;
+    zval*                           nodes_p = NULL;
+
+    set_policy(NULL, NULL, NULL, NULL, &info_policy, NULL, NULL, NULL,
+            options_p, error_p TSRMLS_CC);
+    if (AEROSPIKE_OK != (error_p->code)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+        goto exit;
+    }
+
+    MAKE_STD_ZVAL(nodes_p);
+    array_init(nodes_p);
+    task_udata.nodes_p = nodes_p;
+    task_udata.match_fn = match_fn;
+    task_udata.match_udata_p = match_udata_p;
+    task_udata.progress_key_p = progress_key_p;
+    task_udata.progress_pct = 100;
+
+    if (AEROSPIKE_OK != aerospike_info_foreach(as_object_p, error_p,
+                &info_policy, request_p, aerospike_info_task_callback,
+                &task_udata)) {
+        DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+        zval_ptr_dtor(&nodes_p);
+        goto exit;
+    }
+
+    if (0 == zend_hash_num_elements(Z_ARRVAL_P(nodes_p))) {
+        task_udata.progress_pct = 0;
+    }
+    add_assoc_bool(status_p, TASK_STATUS_DONE, task_udata.progress_pct >= 100);
+    add_assoc_long(status_p, TASK_STATUS_PROGRESS_PCT, task_udata.progress_pct);
+    add_assoc_zval(status_p, TASK_STATUS_NODES, nodes_p);
+exit:
+    return error_p->code;
+}
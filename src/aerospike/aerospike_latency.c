@@ -0,0 +1,697 @@
+#include "php.h"
+#include "ext/standard/info.h"
+#include <stdio.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "aerospike/aerospike.h"
+#include "aerospike/as_cluster.h"
+#include "aerospike/as_buffer.h"
+#include "aerospike/as_key.h"
+#include "aerospike/as_msgpack.h"
+#include "aerospike/as_node.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_serializer.h"
+#include "aerospike_common.h"
+
+/*
+ * Latencies are counted in microseconds, in log-linear buckets: values below
+ * 2^LATENCY_SUB_BITS have a bucket each, and each power of two above is split
+ * in 2^LATENCY_SUB_BITS buckets, bounding the error of a percentile to 1/16th
+ * of its value. Latencies above LATENCY_MAX_US are counted as LATENCY_MAX_US.
+ */
+#define LATENCY_SUB_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_US 0xFFFFFFFFULL
+#define LATENCY_BUCKETS ((32 - LATENCY_SUB_BITS) * LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS)
+#define LATENCY_MAX_NODES 128
+
+#define LATENCY_COUNT "count"
+#define LATENCY_MEAN "mean"
+#define LATENCY_MAX "max"
+#define LATENCY_P50 "p50"
+#define LATENCY_P99 "p99"
+#define LATENCY_P999 "p999"
+#define LATENCY_OPERATIONS "operations"
+#define LATENCY_NODES "nodes"
+
+#define CALL_TRACE_OPERATION "operation"
+#define CALL_TRACE_NS "ns"
+#define CALL_TRACE_SET "set"
+#define CALL_TRACE_STATUS "status"
+#define CALL_TRACE_MARSHAL "marshal_us"
+#define CALL_TRACE_NETWORK "network_us"
+#define CALL_TRACE_UNMARSHAL "unmarshal_us"
+#define CALL_TRACE_BYTES_SENT "bytes_sent"
+#define CALL_TRACE_BYTES_RECEIVED "bytes_received"
+
+/*
+ * Header of the bin operations of the wire protocol, added to the size of
+ * each bin name and value to estimate the bytes of a record.
+ */
+#define CALL_TRACE_BIN_OVERHEAD 8
+
+#define SLOW_LOG_MESSAGE_MAX_SIZE 512
+#define SLOW_LOG_LEVEL 4                            /* Aerospike::LOG_LEVEL_WARN */
+
+/*
+ *******************************************************************************************************
+ * Histogram of the latencies of an operation type.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_latency_histogram_t {
+    uint64_t            count;
+    uint64_t            sum;
+    uint64_t            max;
+    uint64_t            buckets[LATENCY_BUCKETS];
+} aerospike_latency_histogram;
+
+/*
+ *******************************************************************************************************
+ * Histograms of the operations served by a cluster node.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_latency_node_t {
+    char                        name[AS_NODE_NAME_MAX_SIZE];
+    aerospike_latency_histogram histograms[AEROSPIKE_LATENCY_OPERATIONS];
+} aerospike_latency_node;
+
+static const char* aerospike_latency_operation_names[AEROSPIKE_LATENCY_OPERATIONS] = {
+    "get", "put", "operate", "batch", "scan", "query", "udf", "info"
+};
+
+/*
+ * The histograms are kept per process, for all the connections it opens, and
+ * updated with atomic additions so that the threads of a ZTS build share them.
+ * The nodes are an open addressing table of their names, whose slots are
+ * published once by compare-and-swap, so that they are found without a lock.
+ */
+static aerospike_latency_histogram aerospike_latency_histograms[AEROSPIKE_LATENCY_OPERATIONS];
+static aerospike_latency_node* volatile aerospike_latency_nodes[LATENCY_MAX_NODES];
+
+/*
+ *******************************************************************************************************
+ * Returns the current time in microseconds, to be passed to
+ * aerospike_latency_record() once the operation completes.
+ *******************************************************************************************************
+ */
+extern uint64_t
+aerospike_latency_now(void)
+{
+    struct timespec     now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+/*
+ *******************************************************************************************************
+ * Returns the bucket counting a latency.
+ *******************************************************************************************************
+ */
+static uint32_t
+aerospike_latency_bucket(uint64_t latency_us)
+{
+    uint32_t            shift = 0;
+
+    if (latency_us >= LATENCY_SUB_BUCKETS) {
+        shift = (63 - __builtin_clzll(latency_us)) - LATENCY_SUB_BITS;
+    }
+    return (shift * LATENCY_SUB_BUCKETS) + (uint32_t) (latency_us >> shift);
+}
+
+/*
+ *******************************************************************************************************
+ * Returns the highest latency counted by a bucket.
+ *******************************************************************************************************
+ */
+static uint64_t
+aerospike_latency_bucket_max(uint32_t bucket)
+{
+    uint32_t            shift = 0;
+
+    if (bucket >= 2 * LATENCY_SUB_BUCKETS) {
+        shift = (bucket / LATENCY_SUB_BUCKETS) - 1;
+    }
+    return ((uint64_t) (bucket - (shift * LATENCY_SUB_BUCKETS) + 1) << shift) - 1;
+}
+
+/*
+ *******************************************************************************************************
+ * Counts a latency in a histogram.
+ *******************************************************************************************************
+ */
+static void
+aerospike_latency_histogram_add(aerospike_latency_histogram* histogram_p,
+        uint64_t latency_us)
+{
+    uint64_t            max = histogram_p->max;
+
+    __sync_fetch_and_add(&histogram_p->count, 1);
+    __sync_fetch_and_add(&histogram_p->sum, latency_us);
+    __sync_fetch_and_add(&histogram_p->buckets[aerospike_latency_bucket(latency_us)], 1);
+    while (latency_us > max &&
+            !__sync_bool_compare_and_swap(&histogram_p->max, max, latency_us)) {
+        max = histogram_p->max;
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Returns the histograms of a node, created on its first operation, or NULL
+ * once LATENCY_MAX_NODES nodes are tracked. The slot of a node is looked up
+ * from the hash of its name, and the next ones probed on a collision.
+ *******************************************************************************************************
+ */
+static aerospike_latency_node*
+aerospike_latency_node_get(const char* name_p)
+{
+    aerospike_latency_node*     node_p = NULL;
+    aerospike_latency_node*     new_node_p = NULL;
+    const char*                 c_p = NULL;
+    uint32_t                    hash = 2166136261U;
+    uint32_t                    i = 0;
+    uint32_t                    slot = 0;
+
+    for (c_p = name_p; *c_p; c_p++) {
+        hash = (hash ^ (uint8_t) *c_p) * 16777619U;
+    }
+
+    for (i = 0; i < LATENCY_MAX_NODES; i++) {
+        slot = (hash + i) % LATENCY_MAX_NODES;
+        while (!(node_p = aerospike_latency_nodes[slot])) {
+            if (!new_node_p) {
+                if (!(new_node_p = (aerospike_latency_node *) calloc(1, sizeof(aerospike_latency_node)))) {
+                    return NULL;
+                }
+                strncpy(new_node_p->name, name_p, AS_NODE_NAME_MAX_SIZE - 1);
+            }
+            if (__sync_bool_compare_and_swap(&aerospike_latency_nodes[slot], NULL, new_node_p)) {
+                return new_node_p;
+            }
+        }
+        if (0 == strncmp(node_p->name, name_p, AS_NODE_NAME_MAX_SIZE)) {
+            break;
+        }
+        node_p = NULL;
+    }
+    free(new_node_p);
+    return node_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Returns the reserved master node of a key, to be released with
+ * as_node_release(), or NULL. This is the lookup made by the C client to
+ * route the command, as_node_get(cluster, ns, digest, write, replica) of
+ * aerospike/as_cluster.h, whose replica argument came with the shared memory
+ * cluster tending of the 3.0 client used by aerospike.shm.use.
+ *******************************************************************************************************
+ */
+static as_node*
+aerospike_latency_key_node(aerospike* as_object_p, aerospike_latency_operation operation,
+        as_key* key_p)
+{
+    if (!key_p || !as_object_p || !as_object_p->cluster || !as_key_digest(key_p)) {
+        return NULL;
+    }
+    return as_node_get(as_object_p->cluster, key_p->ns,
+            (const cf_digest *) as_key_digest(key_p)->value,
+            operation != AEROSPIKE_LATENCY_GET, AS_POLICY_REPLICA_MASTER);
+}
+
+/*
+ *******************************************************************************************************
+ * Records the latency of an operation, whether it succeeded or not.
+ *
+ * @param as_object_p           The C client's aerospike object.
+ * @param operation             The type of the operation.
+ * @param key_p                 The key of a single record operation, whose
+ *                              master node is also credited with the
+ *                              latency, or NULL.
+ * @param started_at            The aerospike_latency_now() of the start of
+ *                              the operation.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_latency_record(aerospike* as_object_p, aerospike_latency_operation operation,
+        as_key* key_p, uint64_t started_at)
+{
+    uint64_t                    latency_us = aerospike_latency_now() - started_at;
+    as_node*                    node_p = NULL;
+    aerospike_latency_node*     latency_node_p = NULL;
+
+    if (latency_us > LATENCY_MAX_US) {
+        latency_us = LATENCY_MAX_US;
+    }
+    aerospike_latency_histogram_add(&aerospike_latency_histograms[operation], latency_us);
+
+    if ((node_p = aerospike_latency_key_node(as_object_p, operation, key_p))) {
+        if ((latency_node_p = aerospike_latency_node_get(node_p->name))) {
+            aerospike_latency_histogram_add(&latency_node_p->histograms[operation],
+                    latency_us);
+        }
+        as_node_release(node_p);
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Records the latency of the part of an operation made on a single node, such
+ * as the scan of a node by aerospike_scan_node(). Only the node is credited,
+ * the whole operation being recorded by aerospike_latency_record().
+ *
+ * @param operation             The type of the operation.
+ * @param node_name_p           The name of the node.
+ * @param started_at            The aerospike_latency_now() of the start of
+ *                              the operation on the node.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_latency_record_node(aerospike_latency_operation operation,
+        const char* node_name_p, uint64_t started_at)
+{
+    uint64_t                    latency_us = aerospike_latency_now() - started_at;
+    aerospike_latency_node*     latency_node_p = NULL;
+
+    if (latency_us > LATENCY_MAX_US) {
+        latency_us = LATENCY_MAX_US;
+    }
+    if ((latency_node_p = aerospike_latency_node_get(node_name_p))) {
+        aerospike_latency_histogram_add(&latency_node_p->histograms[operation],
+                latency_us);
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Returns the latency under which a fraction of the counted latencies are.
+ *******************************************************************************************************
+ */
+static uint64_t
+aerospike_latency_percentile(aerospike_latency_histogram* histogram_p,
+        uint64_t count, double fraction)
+{
+    uint64_t            rank = (uint64_t) ((fraction * count) + 0.999999);
+    uint64_t            seen = 0;
+    uint64_t            max = 0;
+    uint32_t            i = 0;
+
+    for (i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += histogram_p->buckets[i];
+        if (seen >= rank) {
+            max = aerospike_latency_bucket_max(i);
+            return max < histogram_p->max ? max : histogram_p->max;
+        }
+    }
+    return histogram_p->max;
+}
+
+/*
+ *******************************************************************************************************
+ * Adds the summary of a histogram to an array, keyed by operation name.
+ *******************************************************************************************************
+ */
+static void
+aerospike_latency_histogram_summary(aerospike_latency_histogram* histogram_p,
+        const char* name_p, zval* summaries_p)
+{
+    zval*               summary_p = NULL;
+    uint64_t            count = histogram_p->count;
+
+    if (!count) {
+        return;
+    }
+
+    MAKE_STD_ZVAL(summary_p);
+    array_init(summary_p);
+    add_assoc_long(summary_p, LATENCY_COUNT, (long) count);
+    add_assoc_long(summary_p, LATENCY_MEAN, (long) (histogram_p->sum / count));
+    add_assoc_long(summary_p, LATENCY_P50, (long) aerospike_latency_percentile(histogram_p, count, 0.5));
+    add_assoc_long(summary_p, LATENCY_P99, (long) aerospike_latency_percentile(histogram_p, count, 0.99));
+    add_assoc_long(summary_p, LATENCY_P999, (long) aerospike_latency_percentile(histogram_p, count, 0.999));
+    add_assoc_long(summary_p, LATENCY_MAX, (long) histogram_p->max);
+    add_assoc_zval(summaries_p, (char *) name_p, summary_p);
+}
+
+/*
+ *******************************************************************************************************
+ * Sets an array to the latency statistics of the process, in microseconds,
+ * for each operation type and for each node.
+ *
+ * @param stats_p               The zval to be set to the statistics.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_latency_stats(zval* stats_p TSRMLS_DC)
+{
+    zval*                       operations_p = NULL;
+    zval*                       nodes_p = NULL;
+    zval*                       node_operations_p = NULL;
+    aerospike_latency_node*     node_p = NULL;
+    uint32_t                    i = 0;
+    uint32_t                    operation = 0;
+
+    array_init(stats_p);
+
+    MAKE_STD_ZVAL(operations_p);
+    array_init(operations_p);
+    for (operation = 0; operation < AEROSPIKE_LATENCY_OPERATIONS; operation++) {
+        aerospike_latency_histogram_summary(&aerospike_latency_histograms[operation],
+                aerospike_latency_operation_names[operation], operations_p);
+    }
+    add_assoc_zval(stats_p, LATENCY_OPERATIONS, operations_p);
+
+    MAKE_STD_ZVAL(nodes_p);
+    array_init(nodes_p);
+    for (i = 0; i < LATENCY_MAX_NODES; i++) {
+        if (!(node_p = aerospike_latency_nodes[i])) {
+            continue;
+        }
+        MAKE_STD_ZVAL(node_operations_p);
+        array_init(node_operations_p);
+        for (operation = 0; operation < AEROSPIKE_LATENCY_OPERATIONS; operation++) {
+            aerospike_latency_histogram_summary(&node_p->histograms[operation],
+                    aerospike_latency_operation_names[operation], node_operations_p);
+        }
+        add_assoc_zval(nodes_p, node_p->name, node_operations_p);
+    }
+    add_assoc_zval(stats_p, LATENCY_NODES, nodes_p);
+}
+
+/*
+ *******************************************************************************************************
+ * Prints the latency statistics of the process in phpinfo().
+ *******************************************************************************************************
+ */
+extern void
+aerospike_latency_info(TSRMLS_D)
+{
+    aerospike_latency_histogram*    histogram_p = NULL;
+    uint64_t                        count = 0;
+    uint32_t                        operation = 0;
+    char                            values[6][24];
+
+    php_info_print_table_start();
+    php_info_print_table_colspan_header(7, "aerospike latency (usec)");
+    php_info_print_table_header(7, "operation", LATENCY_COUNT, LATENCY_MEAN,
+            LATENCY_P50, LATENCY_P99, LATENCY_P999, LATENCY_MAX);
+    for (operation = 0; operation < AEROSPIKE_LATENCY_OPERATIONS; operation++) {
+        histogram_p = &aerospike_latency_histograms[operation];
+        if (!(count = histogram_p->count)) {
+            continue;
+        }
+        snprintf(values[0], sizeof(values[0]), "%llu", (unsigned long long) count);
+        snprintf(values[1], sizeof(values[1]), "%llu", (unsigned long long) (histogram_p->sum / count));
+        snprintf(values[2], sizeof(values[2]), "%llu",
+                (unsigned long long) aerospike_latency_percentile(histogram_p, count, 0.5));
+        snprintf(values[3], sizeof(values[3]), "%llu",
+                (unsigned long long) aerospike_latency_percentile(histogram_p, count, 0.99));
+        snprintf(values[4], sizeof(values[4]), "%llu",
+                (unsigned long long) aerospike_latency_percentile(histogram_p, count, 0.999));
+        snprintf(values[5], sizeof(values[5]), "%llu", (unsigned long long) histogram_p->max);
+        php_info_print_table_row(7, aerospike_latency_operation_names[operation],
+                values[0], values[1], values[2], values[3], values[4], values[5]);
+    }
+    php_info_print_table_end();
+}
+
+/*
+ *******************************************************************************************************
+ * Whether the calls are traced, for Aerospike::lastCallTrace() or for the
+ * slow operation log.
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_call_trace_is_enabled(TSRMLS_D)
+{
+    return (CALL_TRACE_SIZE_PHP_INI) > 0 || (SLOW_LOG_THRESHOLD_PHP_INI) > 0 ||
+        (SLOW_LOG_SAMPLE_RATE_PHP_INI) > 0;
+}
+
+/*
+ *******************************************************************************************************
+ * Estimates the bytes of the bins of a record on the wire, serializing each
+ * value as msgpack.
+ *******************************************************************************************************
+ */
+static uint64_t
+aerospike_call_trace_record_size(const as_record* record_p)
+{
+    as_serializer       serializer;
+    as_buffer           buffer;
+    uint64_t            size = 0;
+    uint16_t            i = 0;
+
+    if (!record_p) {
+        return 0;
+    }
+
+    as_msgpack_init(&serializer);
+    for (i = 0; i < record_p->bins.size; i++) {
+        size += CALL_TRACE_BIN_OVERHEAD + strlen(record_p->bins.entries[i].name);
+        if (!record_p->bins.entries[i].valuep) {
+            continue;
+        }
+        as_buffer_init(&buffer);
+        if (0 == as_serializer_serialize(&serializer,
+                    (as_val *) record_p->bins.entries[i].valuep, &buffer)) {
+            size += buffer.size;
+        }
+        as_buffer_destroy(&buffer);
+    }
+    as_serializer_destroy(&serializer);
+    return size;
+}
+
+/*
+ *******************************************************************************************************
+ * Initializes the trace of a call on a key.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_call_trace_init(aerospike_call_trace* trace_p,
+        aerospike_latency_operation operation, as_key* key_p)
+{
+    memset(trace_p, 0, sizeof(aerospike_call_trace));
+    trace_p->operation = operation;
+    trace_p->name_p = aerospike_latency_operation_names[operation];
+    trace_p->key_p = key_p;
+    if (key_p) {
+        strncpy(trace_p->ns, key_p->ns, AS_NAMESPACE_MAX_SIZE - 1);
+        strncpy(trace_p->set, key_p->set, AS_SET_MAX_SIZE - 1);
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Reports a traced call to the slow operation log: appended to
+ * aerospike.slow_log.path if set, else passed to the log handler set with
+ * Aerospike::setLogHandler(), else written to the PHP error log.
+ *******************************************************************************************************
+ */
+static void
+aerospike_slow_log_write(aerospike* as_object_p, const aerospike_call_trace* trace_p,
+        uint64_t total_us, const char* reason_p TSRMLS_DC)
+{
+    char                digest[(AS_DIGEST_VALUE_SIZE * 2) + 1] = {0};
+    char                node[AS_NODE_NAME_MAX_SIZE] = "unknown";
+    char                message[SLOW_LOG_MESSAGE_MAX_SIZE];
+    char                when[32];
+    char*               path_p = SLOW_LOG_PATH_PHP_INI;
+    as_node*            node_p = NULL;
+    as_digest*          digest_p = NULL;
+    FILE*               file_p = NULL;
+    time_t              now = time(NULL);
+    struct tm           now_tm;
+    uint32_t            i = 0;
+
+    if (trace_p->key_p && (digest_p = as_key_digest(trace_p->key_p))) {
+        for (i = 0; i < AS_DIGEST_VALUE_SIZE; i++) {
+            snprintf(digest + (i * 2), 3, "%02x", digest_p->value[i]);
+        }
+    }
+    if ((node_p = aerospike_latency_key_node(as_object_p, trace_p->operation,
+                    trace_p->key_p))) {
+        strncpy(node, node_p->name, AS_NODE_NAME_MAX_SIZE - 1);
+        as_node_release(node_p);
+    }
+
+    snprintf(message, sizeof(message), "slow %s (%s): ns=%s set=%s digest=%s node=%s"
+            " status=%d total_us=%llu marshal_us=%llu network_us=%llu unmarshal_us=%llu"
+            " bytes_sent=%llu bytes_received=%llu",
+            trace_p->name_p, reason_p,
+            trace_p->ns, trace_p->set, digest, node, trace_p->status,
+            (unsigned long long) total_us,
+            (unsigned long long) trace_p->marshal_us,
+            (unsigned long long) trace_p->network_us,
+            (unsigned long long) trace_p->unmarshal_us,
+            (unsigned long long) trace_p->bytes_sent,
+            (unsigned long long) trace_p->bytes_received);
+
+    if (path_p && *path_p) {
+        if ((file_p = fopen(path_p, "a"))) {
+            localtime_r(&now, &now_tm);
+            strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &now_tm);
+            fprintf(file_p, "[%s] [%d] %s\n", when, (int) getpid(), message);
+            fclose(file_p);
+        }
+    } else if (is_callback_registered) {
+        aerospike_helper_log_message(SLOW_LOG_LEVEL, __func__, __FILE__,
+                __LINE__, message TSRMLS_CC);
+    } else {
+        php_log_err(message TSRMLS_CC);
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Reports a traced call to the slow operation log when it took over
+ * aerospike.slow_log.threshold milliseconds, or is one of the
+ * aerospike.slow_log.sample_rate calls sampled, and keeps it among the last
+ * aerospike.call_trace_size ones of the request, overwriting the oldest.
+ * The bytes of its records are only estimated if it is logged or kept.
+ *
+ * @param as_object_p           The C client's aerospike object.
+ * @param trace_p               The trace of the call.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_call_trace_add(aerospike* as_object_p, aerospike_call_trace* trace_p TSRMLS_DC)
+{
+    uint32_t            capacity = (uint32_t) (CALL_TRACE_SIZE_PHP_INI);
+    uint64_t            total_us = trace_p->marshal_us + trace_p->network_us +
+                                    trace_p->unmarshal_us;
+    long                threshold_ms = SLOW_LOG_THRESHOLD_PHP_INI;
+    long                sample_rate = SLOW_LOG_SAMPLE_RATE_PHP_INI;
+    const char*         reason_p = NULL;
+
+    if (threshold_ms > 0 && total_us >= (uint64_t) threshold_ms * 1000) {
+        reason_p = "threshold";
+    } else if (sample_rate > 0 &&
+            0 == (AEROSPIKE_G(slow_log_calls_g)++ % (uint64_t) sample_rate)) {
+        reason_p = "sample";
+    }
+    if (!reason_p && capacity == 0) {
+        return;
+    }
+
+    if (trace_p->sent_record_p) {
+        trace_p->bytes_sent = aerospike_call_trace_record_size(trace_p->sent_record_p);
+    }
+    if (trace_p->received_record_p) {
+        trace_p->bytes_received = aerospike_call_trace_record_size(trace_p->received_record_p);
+    }
+    if (reason_p) {
+        aerospike_slow_log_write(as_object_p, trace_p, total_us, reason_p TSRMLS_CC);
+    }
+    trace_p->key_p = NULL;
+    trace_p->sent_record_p = NULL;
+    trace_p->received_record_p = NULL;
+
+    if (capacity == 0) {
+        return;
+    }
+    if (AEROSPIKE_G(call_trace_capacity_g) != capacity) {
+        if (AEROSPIKE_G(call_traces_g)) {
+            pefree(AEROSPIKE_G(call_traces_g), 1);
+        }
+        AEROSPIKE_G(call_traces_g) = (aerospike_call_trace *)
+            pemalloc(capacity * sizeof(aerospike_call_trace), 1);
+        AEROSPIKE_G(call_trace_capacity_g) = capacity;
+        AEROSPIKE_G(call_trace_count_g) = 0;
+        AEROSPIKE_G(call_trace_next_g) = 0;
+    }
+
+    memcpy(&AEROSPIKE_G(call_traces_g)[AEROSPIKE_G(call_trace_next_g)], trace_p,
+            sizeof(aerospike_call_trace));
+    AEROSPIKE_G(call_trace_next_g) = (AEROSPIKE_G(call_trace_next_g) + 1) % capacity;
+    if (AEROSPIKE_G(call_trace_count_g) < capacity) {
+        AEROSPIKE_G(call_trace_count_g)++;
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Traces a call made of a single command, whose time is all spent in the C
+ * client, once it completes.
+ *
+ * @param as_object_p           The C client's aerospike object.
+ * @param operation             The type of the operation.
+ * @param name_p                The name of the method traced, or NULL for
+ *                              that of the operation.
+ * @param key_p                 The key of the record.
+ * @param status                The status of the command.
+ * @param started_at            The aerospike_latency_now() of the start of
+ *                              the command.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_call_trace_command(aerospike* as_object_p, aerospike_latency_operation operation,
+        const char* name_p, as_key* key_p, as_status status, uint64_t started_at TSRMLS_DC)
+{
+    aerospike_call_trace    trace;
+
+    if (!aerospike_call_trace_is_enabled(TSRMLS_C)) {
+        return;
+    }
+    aerospike_call_trace_init(&trace, operation, key_p);
+    if (name_p) {
+        trace.name_p = name_p;
+    }
+    trace.status = status;
+    trace.network_us = aerospike_latency_now() - started_at;
+    aerospike_call_trace_add(as_object_p, &trace TSRMLS_CC);
+}
+
+/*
+ *******************************************************************************************************
+ * Drops the kept traces at the end of a request, so that the next request,
+ * which may be another user's, does not see them. The ring is kept for reuse.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_call_trace_reset(TSRMLS_D)
+{
+    AEROSPIKE_G(call_trace_count_g) = 0;
+    AEROSPIKE_G(call_trace_next_g) = 0;
+}
+
+/*
+ *******************************************************************************************************
+ * Sets an array to the kept traces, the last call first.
+ *
+ * @param traces_p              The zval to be set to the traces.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_call_trace_list(zval* traces_p TSRMLS_DC)
+{
+    aerospike_call_trace*   trace_p = NULL;
+    zval*                   entry_p = NULL;
+    uint32_t                capacity = AEROSPIKE_G(call_trace_capacity_g);
+    uint32_t                i = 0;
+
+    array_init(traces_p);
+    for (i = 1; i <= AEROSPIKE_G(call_trace_count_g); i++) {
+        trace_p = &AEROSPIKE_G(call_traces_g)[(AEROSPIKE_G(call_trace_next_g) + capacity - i) % capacity];
+        MAKE_STD_ZVAL(entry_p);
+        array_init(entry_p);
+        add_assoc_string(entry_p, CALL_TRACE_OPERATION, (char *) trace_p->name_p, 1);
+        add_assoc_string(entry_p, CALL_TRACE_NS, trace_p->ns, 1);
+        add_assoc_string(entry_p, CALL_TRACE_SET, trace_p->set, 1);
+        add_assoc_long(entry_p, CALL_TRACE_STATUS, trace_p->status);
+        add_assoc_long(entry_p, CALL_TRACE_MARSHAL, (long) trace_p->marshal_us);
+        add_assoc_long(entry_p, CALL_TRACE_NETWORK, (long) trace_p->network_us);
+        add_assoc_long(entry_p, CALL_TRACE_UNMARSHAL, (long) trace_p->unmarshal_us);
+        add_assoc_long(entry_p, CALL_TRACE_BYTES_SENT, (long) trace_p->bytes_sent);
+        add_assoc_long(entry_p, CALL_TRACE_BYTES_RECEIVED, (long) trace_p->bytes_received);
+        add_next_index_zval(traces_p, entry_p);
+    }
+}
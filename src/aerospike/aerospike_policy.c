@@ -81,6 +81,147 @@ exit:
     return status;
 }
 
+/*
+ *******************************************************************************************************
+ * Class entry and handlers of the Aerospike\Policy class.
+ *******************************************************************************************************
+ */
+static zend_class_entry *Aerospike_policy_ce;
+static zend_object_handlers Aerospike_policy_handlers;
+
+/*
+ ********************************************************************
+ * Aerospike\Policy object freeing up on scope termination
+ ********************************************************************
+ */
+static void Aerospike_policy_object_free_storage(void *object TSRMLS_DC)
+{
+    Aerospike_policy_object   *intern_obj_p = (Aerospike_policy_object *) object;
+
+    if (intern_obj_p) {
+        if (intern_obj_p->options_p) {
+            zval_ptr_dtor(&intern_obj_p->options_p);
+        }
+        zend_object_std_dtor(&intern_obj_p->std TSRMLS_CC);
+        efree(intern_obj_p);
+    } else {
+        DEBUG_PHP_EXT_ERROR("invalid policy object");
+    }
+}
+
+/*
+ ********************************************************************
+ * Aerospike\Policy class new method
+ ********************************************************************
+ */
+static zend_object_value Aerospike_policy_object_new(zend_class_entry *ce TSRMLS_DC)
+{
+    zend_object_value retval = {0};
+    Aerospike_policy_object *intern_obj_p;
+
+    if (NULL != (intern_obj_p = ecalloc(1, sizeof(Aerospike_policy_object)))) {
+        zend_object_std_init(&(intern_obj_p->std), ce TSRMLS_CC);
+#if PHP_VERSION_ID < 50399
+        zend_hash_copy(intern_obj_p->std.properties, &ce->default_properties, (copy_ctor_func_t) zval_add_ref, NULL, sizeof(zval *));
+#else
+        object_properties_init((zend_object*) &(intern_obj_p->std), ce);
+#endif
+
+        retval.handle = zend_objects_store_put(intern_obj_p, NULL, (zend_objects_free_object_storage_t) Aerospike_policy_object_free_storage, NULL TSRMLS_CC);
+        retval.handlers = &Aerospike_policy_handlers;
+    } else {
+        DEBUG_PHP_EXT_ERROR("Could not allocate memory for policy object");
+    }
+    return (retval);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to register the Aerospike\Policy class. Its objects are only
+ * created by Aerospike::compilePolicy() and are immutable.
+ *
+ * @return AEROSPIKE_OK if the success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern
+as_status declare_policy_class_php(TSRMLS_D)
+{
+    zend_class_entry policy_ce = {0};
+
+    INIT_NS_CLASS_ENTRY(policy_ce, "Aerospike", "Policy", NULL);
+    if (!(Aerospike_policy_ce = zend_register_internal_class(&policy_ce TSRMLS_CC))) {
+        return AEROSPIKE_ERR;
+    }
+    Aerospike_policy_ce->create_object = Aerospike_policy_object_new;
+    memcpy(&Aerospike_policy_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+    Aerospike_policy_handlers.clone_obj = NULL;
+    Aerospike_policy_ce->ce_flags |= ZEND_ACC_FINAL_CLASS;
+    return AEROSPIKE_OK;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to fetch the compiled policy behind an options zval.
+ *
+ * @param options_p             The options passed by the user.
+ *
+ * @return The Aerospike\Policy object compiled by Aerospike::compilePolicy(),
+ *         or NULL if options_p is not such an object.
+ *******************************************************************************************************
+ */
+static Aerospike_policy_object*
+aerospike_policy_get_object(zval *options_p TSRMLS_DC)
+{
+    Aerospike_policy_object*    policy_p = NULL;
+
+    if (!options_p || (Z_TYPE_P(options_p) != IS_OBJECT) ||
+            !instanceof_function(Z_OBJCE_P(options_p), Aerospike_policy_ce TSRMLS_CC)) {
+        return NULL;
+    }
+    policy_p = (Aerospike_policy_object *) zend_object_store_get_object(options_p TSRMLS_CC);
+    if (!policy_p || !policy_p->type) {
+        return NULL;
+    }
+    return policy_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to check whether the options passed to a method are an
+ * Aerospike\Policy object, which the methods accepting one take in place
+ * of the options array.
+ *
+ * @param options_p             The options passed by the user.
+ *
+ * @return true if options_p is a compiled policy. Otherwise false.
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_policy_is_compiled(zval *options_p TSRMLS_DC)
+{
+    return (NULL != aerospike_policy_get_object(options_p TSRMLS_CC));
+}
+
+/*
+ *******************************************************************************************************
+ * Function to get the options array behind the options passed to a method,
+ * for the options (such as the generation value of OPT_POLICY_GEN) which
+ * are read directly by the operations rather than through set_policy().
+ *
+ * @param options_p             The options passed by the user.
+ *
+ * @return The options array compiled into an Aerospike\Policy object,
+ *         otherwise options_p itself.
+ *******************************************************************************************************
+ */
+extern zval*
+aerospike_policy_get_options(zval *options_p TSRMLS_DC)
+{
+    Aerospike_policy_object*    policy_p = aerospike_policy_get_object(options_p TSRMLS_CC);
+
+    return (policy_p ? policy_p->options_p : options_p);
+}
+
 /*
  *******************************************************************************************************
  * Function for checking and setting the default aerospike policies by reading
@@ -257,6 +398,7 @@ get_generation_value(zval* options_p, uint16_t* generation_value_p, as_error *er
     zval**                  gen_policy_pp = NULL;
     zval**                  gen_value_pp = NULL;
 
+    options_p = aerospike_policy_get_options(options_p TSRMLS_CC);
     if (options_p) {
         if (zend_hash_index_find(Z_ARRVAL_P(options_p), OPT_POLICY_GEN, (void **) &gen_policy_pp) == FAILURE) {
             //error_p->code = AEROSPIKE_ERR;
@@ -284,6 +426,93 @@ exit:
 
 
 
+/*
+ *******************************************************************************************************
+ * Function for setting the relevant aerospike policy from an Aerospike\Policy
+ * object, by copying the policy compiled by Aerospike::compilePolicy()
+ * instead of walking and validating the options array again.
+ * The compiled policy type must match the one policy the operation takes.
+ *
+ * @param read_policy_p         The as_policy_read to be passed in case of get.
+ * @param write_policy_p        The as_policy_write to be passed in case of put.
+ * @param operate_policy_p      The as_policy_operate to be passed in case of operate.
+ * @param remove_policy_p       The as_policy_remove to be passed in case of remove.
+ * @param serializer_policy_p   The serialization policy to be passed in case of put.
+ * @param batch_policy_p        The as_policy_batch to be passed in case of getMany
+ *                              and existsMany.
+ * @param apply_policy_p        The as_policy_apply to be passed in case of apply.
+ * @param policy_p              The compiled policy.
+ * @param error_p               The as_error to be populated by the function
+ *                              with the encountered error if any.
+ *
+ *******************************************************************************************************
+ */
+static void
+set_policy_compiled(as_policy_read *read_policy_p,
+                    as_policy_write *write_policy_p,
+                    as_policy_operate *operate_policy_p,
+                    as_policy_remove *remove_policy_p,
+                    uint32_t *serializer_policy_p,
+                    as_policy_batch *batch_policy_p,
+                    as_policy_apply *apply_policy_p,
+                    Aerospike_policy_object *policy_p,
+                    as_error *error_p)
+{
+    switch (policy_p->type) {
+        case POLICY_TYPE_READ:
+            if (!read_policy_p) {
+                goto mismatch;
+            }
+            *read_policy_p = policy_p->policy.read;
+            break;
+        case POLICY_TYPE_WRITE:
+            if (!write_policy_p) {
+                goto mismatch;
+            }
+            *write_policy_p = policy_p->policy.write;
+            if (serializer_policy_p) {
+                *serializer_policy_p = policy_p->serializer;
+            }
+            break;
+        case POLICY_TYPE_OPERATE:
+            if (!operate_policy_p) {
+                goto mismatch;
+            }
+            *operate_policy_p = policy_p->policy.operate;
+            if (serializer_policy_p) {
+                *serializer_policy_p = policy_p->serializer;
+            }
+            break;
+        case POLICY_TYPE_REMOVE:
+            if (!remove_policy_p) {
+                goto mismatch;
+            }
+            *remove_policy_p = policy_p->policy.remove;
+            break;
+        case POLICY_TYPE_BATCH:
+            if (!batch_policy_p) {
+                goto mismatch;
+            }
+            *batch_policy_p = policy_p->policy.batch;
+            break;
+        case POLICY_TYPE_APPLY:
+            if (!apply_policy_p) {
+                goto mismatch;
+            }
+            *apply_policy_p = policy_p->policy.apply;
+            break;
+        default:
+            goto mismatch;
+    }
+    PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_OK, DEFAULT_ERROR);
+    return;
+
+mismatch:
+    DEBUG_PHP_EXT_DEBUG("Unable to set policy: Aerospike\\Policy of another policy type");
+    PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+            "Unable to set policy: Aerospike\\Policy of another policy type");
+}
+
 /*
  *******************************************************************************************************
  * Function for setting the relevant aerospike policies by using the user's
@@ -336,6 +565,22 @@ set_policy_ex(as_config *as_config_p,
         goto exit;
     }
 
+    if (options_p && (Z_TYPE_P(options_p) == IS_OBJECT)) {
+        Aerospike_policy_object*    policy_p = aerospike_policy_get_object(options_p TSRMLS_CC);
+
+        if (!policy_p || as_config_p || info_policy_p || scan_policy_p ||
+                query_policy_p || as_scan_p || (read_policy_p && write_policy_p)) {
+            DEBUG_PHP_EXT_DEBUG("Unable to set policy: Invalid Policy Object");
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                    "Unable to set policy: Invalid Policy Object");
+            goto exit;
+        }
+        set_policy_compiled(read_policy_p, write_policy_p, operate_policy_p,
+                remove_policy_p, serializer_policy_p, batch_policy_p,
+                apply_policy_p, policy_p, error_p);
+        goto exit;
+    }
+
     /*
      * case: connect => (read_policy_p != NULL && write_policy_p != NULL)
      */
@@ -594,6 +839,55 @@ set_policy_ex(as_config *as_config_p,
                         goto exit;
                     }
                     break;
+                case OPT_MAX_RECORDS:
+                    /*
+                     * Enforced by the record stream callbacks of scan() and
+                     * query(), only validated here.
+                     */
+                    if ((!scan_policy_p && !query_policy_p) ||
+                            (Z_TYPE_PP(options_value) != IS_LONG) ||
+                            (Z_LVAL_PP(options_value) < 0)) {
+                        DEBUG_PHP_EXT_DEBUG("Unable to set policy: Invalid Value for OPT_MAX_RECORDS");
+                        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                                "Unable to set policy: Invalid Value for OPT_MAX_RECORDS");
+                        goto exit;
+                    }
+                    break;
+                case OPT_SCAN_SHARD:
+                    /*
+                     * Validated and enforced by aerospike_scan_run().
+                     */
+                    if (!scan_policy_p) {
+                        DEBUG_PHP_EXT_DEBUG("Unable to set policy: Invalid Value for OPT_SCAN_SHARD");
+                        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                                "Unable to set policy: Invalid Value for OPT_SCAN_SHARD");
+                        goto exit;
+                    }
+                    break;
+                case OPT_QUERY_SCAN_FALLBACK:
+                    /*
+                     * Enforced by aerospike_query_run(), only validated here.
+                     */
+                    if (!query_policy_p || (Z_TYPE_PP(options_value) != IS_BOOL)) {
+                        DEBUG_PHP_EXT_DEBUG("Unable to set policy: Invalid Value for OPT_QUERY_SCAN_FALLBACK");
+                        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                                "Unable to set policy: Invalid Value for OPT_QUERY_SCAN_FALLBACK");
+                        goto exit;
+                    }
+                    break;
+                case OPT_READ_CACHE:
+                    /*
+                     * Enforced by get() and getMany() through
+                     * aerospike_record_cache_is_enabled(), only validated here.
+                     */
+                    if (((!read_policy_p || write_policy_p) && !batch_policy_p) ||
+                            (Z_TYPE_PP(options_value) != IS_BOOL)) {
+                        DEBUG_PHP_EXT_DEBUG("Unable to set policy: Invalid Value for OPT_READ_CACHE");
+                        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                                "Unable to set policy: Invalid Value for OPT_READ_CACHE");
+                        goto exit;
+                    }
+                    break;
                 case OPT_POLICY_KEY:
                     if (Z_TYPE_PP(options_value) != IS_LONG) {
                         DEBUG_PHP_EXT_DEBUG("Unable to set policy: Invalid Value for OPT_POLICY_KEY");
@@ -744,6 +1038,85 @@ exit:
     return;
 }
 
+/*
+ *******************************************************************************************************
+ * Function for compiling the user's options into an Aerospike\Policy object
+ * of the given policy type. The options are validated and resolved against
+ * the INI defaults here once, exactly as set_policy() would on each call.
+ *
+ * @param policy_zval_p         The zval to be initialized as the Aerospike\Policy object.
+ * @param type                  One of the POLICY_TYPE_* values.
+ * @param options_p             The user's optional policy options, or NULL.
+ * @param error_p               The as_error to be populated by the function
+ *                              with the encountered error if any.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_policy_compile(zval *policy_zval_p,
+        long type,
+        zval *options_p,
+        as_error *error_p TSRMLS_DC)
+{
+    Aerospike_policy_object*    policy_p = NULL;
+
+    if ((type < POLICY_TYPE_READ) || (type > POLICY_TYPE_APPLY)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to compile policy: Invalid Policy Type");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                "Unable to compile policy: Invalid Policy Type");
+        goto exit;
+    }
+
+    object_init_ex(policy_zval_p, Aerospike_policy_ce);
+    policy_p = (Aerospike_policy_object *)
+        zend_object_store_get_object(policy_zval_p TSRMLS_CC);
+    policy_p->serializer = -1;
+
+    switch (type) {
+        case POLICY_TYPE_READ:
+            set_policy_ex(NULL, &policy_p->policy.read, NULL, NULL, NULL, NULL,
+                    NULL, NULL, NULL, NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
+            break;
+        case POLICY_TYPE_WRITE:
+            set_policy_ex(NULL, NULL, &policy_p->policy.write, NULL, NULL, NULL,
+                    NULL, NULL, &policy_p->serializer, NULL, NULL, NULL, options_p,
+                    error_p TSRMLS_CC);
+            break;
+        case POLICY_TYPE_OPERATE:
+            set_policy_ex(NULL, NULL, NULL, &policy_p->policy.operate, NULL, NULL,
+                    NULL, NULL, &policy_p->serializer, NULL, NULL, NULL, options_p,
+                    error_p TSRMLS_CC);
+            break;
+        case POLICY_TYPE_REMOVE:
+            set_policy_ex(NULL, NULL, NULL, NULL, &policy_p->policy.remove, NULL,
+                    NULL, NULL, NULL, NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
+            break;
+        case POLICY_TYPE_BATCH:
+            set_policy_ex(NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                    NULL, NULL, &policy_p->policy.batch, NULL, options_p, error_p TSRMLS_CC);
+            break;
+        case POLICY_TYPE_APPLY:
+            set_policy_ex(NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                    NULL, NULL, NULL, &policy_p->policy.apply, options_p, error_p TSRMLS_CC);
+            break;
+    }
+    if (AEROSPIKE_OK != error_p->code) {
+        zval_dtor(policy_zval_p);
+        ZVAL_NULL(policy_zval_p);
+        goto exit;
+    }
+
+    policy_p->type = type;
+    MAKE_STD_ZVAL(policy_p->options_p);
+    if (options_p) {
+        ZVAL_ZVAL(policy_p->options_p, options_p, 1, 0);
+    } else {
+        array_init(policy_p->options_p);
+    }
+exit:
+    return;
+}
+
 /*
  *******************************************************************************************************
  * Wrapper function for setting the relevant aerospike policies by using the user's
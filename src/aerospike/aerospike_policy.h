@@ -22,7 +22,26 @@ enum Aerospike_constants {
     OPT_POLICY_GEN,
     OPT_POLICY_REPLICA,       /* set to one of Aerospike::POLICY_REPLICA_* */
     OPT_POLICY_CONSISTENCY,   /* set to one of Aerospike::POLICY_CONSISTENCY_* */
-    OPT_POLICY_COMMIT_LEVEL   /* set to one of Aerospike::POLICY_COMMIT_LEVEL_* */
+    OPT_POLICY_COMMIT_LEVEL,  /* set to one of Aerospike::POLICY_COMMIT_LEVEL_* */
+    OPT_MAX_RECORDS,          /* integer value, stop a scan or query after this many records, default: 0 (no limit) */
+    OPT_SCAN_SHARD,           /* array(shard, shards), scan only the nodes of that shard of the cluster */
+    OPT_QUERY_SCAN_FALLBACK,  /* boolean value, run a query on a bin without an index as a scan, default: false */
+    OPT_READ_CACHE            /* boolean value, serve get() and getMany() from the client's read cache, default: false */
+};
+
+/*
+ *******************************************************************************************************
+ * Enum for PHP client's POLICY_TYPE_* constant values. The policy types
+ * Aerospike::compilePolicy() can compile options into.
+ *******************************************************************************************************
+ */
+enum Aerospike_policy_types {
+    POLICY_TYPE_READ = 1,     /* get(), exists() */
+    POLICY_TYPE_WRITE,        /* put() */
+    POLICY_TYPE_OPERATE,      /* operate(), append(), prepend(), increment(), touch() */
+    POLICY_TYPE_REMOVE,       /* remove() */
+    POLICY_TYPE_BATCH,        /* getMany(), existsMany() */
+    POLICY_TYPE_APPLY         /* apply() */
 };
 
 /*
@@ -75,6 +94,16 @@ AerospikeConstants aerospike_constants[] = {
     { OPT_POLICY_REPLICA                    ,   "OPT_POLICY_REPLICA"                },
     { OPT_POLICY_CONSISTENCY                ,   "OPT_POLICY_CONSISTENCY"            },
     { OPT_POLICY_COMMIT_LEVEL               ,   "OPT_POLICY_COMMIT_LEVEL"           },
+    { OPT_MAX_RECORDS                       ,   "OPT_MAX_RECORDS"                   },
+    { OPT_SCAN_SHARD                        ,   "OPT_SCAN_SHARD"                    },
+    { OPT_QUERY_SCAN_FALLBACK               ,   "OPT_QUERY_SCAN_FALLBACK"           },
+    { OPT_READ_CACHE                        ,   "OPT_READ_CACHE"                    },
+    { POLICY_TYPE_READ                      ,   "POLICY_TYPE_READ"                  },
+    { POLICY_TYPE_WRITE                     ,   "POLICY_TYPE_WRITE"                 },
+    { POLICY_TYPE_OPERATE                   ,   "POLICY_TYPE_OPERATE"               },
+    { POLICY_TYPE_REMOVE                    ,   "POLICY_TYPE_REMOVE"                },
+    { POLICY_TYPE_BATCH                     ,   "POLICY_TYPE_BATCH"                 },
+    { POLICY_TYPE_APPLY                     ,   "POLICY_TYPE_APPLY"                 },
     { AS_POLICY_RETRY_NONE                  ,   "POLICY_RETRY_NONE"                 },
     { AS_POLICY_RETRY_ONCE                  ,   "POLICY_RETRY_ONCE"                 },
     { AS_POLICY_EXISTS_IGNORE               ,   "POLICY_EXISTS_IGNORE"              },
@@ -107,6 +136,28 @@ AerospikeConstants aerospike_constants[] = {
     { AS_POLICY_COMMIT_LEVEL_ALL            ,   "POLICY_COMMIT_LEVEL_ALL"           },
     { AS_POLICY_COMMIT_LEVEL_MASTER         ,   "POLICY_COMMIT_LEVEL_MASTER"        }
 };
+/*
+ *******************************************************************************************************
+ * Structure of an Aerospike\Policy object: the options of one policy type,
+ * validated and resolved against the INI defaults once by
+ * Aerospike::compilePolicy().
+ *******************************************************************************************************
+ */
+typedef struct Aerospike_policy_object {
+    zend_object std;
+    long type;
+    union {
+        as_policy_read read;
+        as_policy_write write;
+        as_policy_operate operate;
+        as_policy_remove remove;
+        as_policy_batch batch;
+        as_policy_apply apply;
+    } policy;
+    uint32_t serializer;
+    zval *options_p;
+} Aerospike_policy_object;
+
 /*
  *******************************************************************************************************
  * Extern declarations of policy functions.
@@ -149,4 +200,28 @@ set_policy_udf_apply(as_policy_apply *apply_policy_p,
 extern as_status
 declare_policy_constants_php(zend_class_entry *Aerospike_ce TSRMLS_DC);
 
+extern as_status
+declare_policy_class_php(TSRMLS_D);
+
+extern void
+aerospike_policy_compile(zval *policy_zval_p,
+        long type,
+        zval *options_p,
+        as_error *error_p TSRMLS_DC);
+
+extern bool
+aerospike_policy_is_compiled(zval *options_p TSRMLS_DC);
+
+extern zval*
+aerospike_policy_get_options(zval *options_p TSRMLS_DC);
+
+/*
+ *******************************************************************************************************
+ * Check for the optional $options of the methods which take either an
+ * options array or an Aerospike\Policy object.
+ *******************************************************************************************************
+ */
+#define PHP_TYPE_ISNOTOPTIONS(zend_val) \
+    (PHP_TYPE_ISNOTARR(zend_val) && !aerospike_policy_is_compiled(zend_val TSRMLS_CC))
+
 #endif /* end of __AEROSPIKE_POLICY_H__ */
@@ -9,7 +9,62 @@
 #include "aerospike/as_udf.h"
 #include "aerospike/as_query.h"
 #include "aerospike/aerospike_query.h"
+#include "aerospike/aerospike_key.h"
+#include "aerospike/aerospike_scan.h"
 #include "aerospike_policy.h"
+#include "aerospike_general_constants.h"
+#include "aerospike/as_hashmap.h"
+#include "aerospike/as_hashmap_iterator.h"
+#include "aerospike/as_pair.h"
+#include "aerospike/as_list.h"
+#include "aerospike/as_map.h"
+#include "pthread.h"
+
+/*
+ ******************************************************************************************************
+ Sets an equality predicate on an as_query object.
+ *
+ * @param query_p                   The C client's as_query object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param bin_p                     The indexed bin.
+ * @param val_pp                    The string or integer value to be matched.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+static as_status
+aerospike_query_where_equals(as_query* query_p, as_error* error_p,
+        const char* bin_p, zval** val_pp TSRMLS_DC)
+{
+    switch(Z_TYPE_PP(val_pp)) {
+        case IS_STRING:
+            if (!as_query_where(query_p, bin_p, string_equals(Z_STRVAL_PP(val_pp)))) {
+                DEBUG_PHP_EXT_DEBUG("Unable to set query predicate");
+                PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                        "Unable to set query predicate");
+                goto exit;
+            }
+            break;
+        case IS_LONG:
+            if (!as_query_where(query_p, bin_p, integer_equals(Z_LVAL_PP(val_pp)))) {
+                DEBUG_PHP_EXT_DEBUG("Unable to set query predicate");
+                PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                        "Unable to set query predicate");
+                goto exit;
+            }
+            break;
+        default:
+            DEBUG_PHP_EXT_DEBUG("Predicate 'val' must be either string or integer.");
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                    "Predicate 'val' must be either string or integer.");
+            goto exit;
+    }
+
+    PHP_EXT_SET_AS_ERR(error_p, DEFAULT_ERRORNO, DEFAULT_ERROR);
+
+exit:
+    return error_p->code;
+}
 
 /*
  ******************************************************************************************************
@@ -64,30 +119,9 @@ aerospike_query_define(as_query* query_p, as_error* error_p, char* namespace_p,
         convert_to_string_ex(op_pp);
         convert_to_string_ex(bin_pp);
         if (strncmp(Z_STRVAL_PP(op_pp), "=", 1) == 0) {
-            switch(Z_TYPE_PP(val_pp)) {
-                case IS_STRING:
-                    convert_to_string_ex(val_pp);
-                    if (!as_query_where(query_p, Z_STRVAL_PP(bin_pp),
-                                string_equals(Z_STRVAL_PP(val_pp)))) {
-                        DEBUG_PHP_EXT_DEBUG("Unable to set query predicate");
-                        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
-                                "Unable to set query predicate");
-                    }
-                    break;
-                case IS_LONG:
-                    convert_to_long_ex(val_pp);
-                    if (!as_query_where(query_p, Z_STRVAL_PP(bin_pp),
-                                integer_equals(Z_LVAL_PP(val_pp)))) {
-                        DEBUG_PHP_EXT_DEBUG("Unable to set query predicate");
-                        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
-                                "Unable to set query predicate");
-                    }
-                    break;
-                default:
-                    DEBUG_PHP_EXT_DEBUG("Predicate 'val' must be either string or integer.");
-                    PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
-                            "Predicate 'val' must be either string or integer.");
-                    goto exit;
+            if (AEROSPIKE_OK != aerospike_query_where_equals(query_p, error_p,
+                        Z_STRVAL_PP(bin_pp), val_pp TSRMLS_CC)) {
+                goto exit;
             }
         } else if (strncmp(Z_STRVAL_PP(op_pp), "BETWEEN", 7) == 0) {
             bool between_unpacked = false;
@@ -139,192 +173,511 @@ exit:
 
 /*
  ******************************************************************************************************
- Executes a query in the Aerospike DB.
+ * Operators of the filters evaluated on the records returned by the index
+ * predicate of a query, before they are converted into PHP arrays.
+ ******************************************************************************************************
+ */
+enum query_filter_op {
+    QUERY_FILTER_EQ,
+    QUERY_FILTER_BETWEEN,
+    QUERY_FILTER_IN,
+    QUERY_FILTER_CONTAINS
+};
+
+typedef struct query_filter_t {
+    const char*             bin_p;
+    enum query_filter_op    op;
+    as_val*                 val_p;
+    as_val**                vals_pp;
+    uint32_t                vals_count;
+    int64_t                 min;
+    int64_t                 max;
+} query_filter;
+
+/*
+ ******************************************************************************************************
+ * udata of aerospike_query_filter_callback, wrapping the userland callback
+ * with the filters every record has to pass before it is handed to it.
+ ******************************************************************************************************
+ */
+typedef struct query_filter_udata_t {
+    userland_callback*      user_func_p;
+    query_filter*           filters_p;
+    uint32_t                filters_count;
+    bool                    is_stopped;
+    bool                    is_dedup;
+    pthread_mutex_t         dedup_lock;
+    uint8_t*                digests_p;
+    uint32_t                digests_capacity;
+    uint32_t                digests_count;
+} query_filter_udata;
+
+/*
+ ******************************************************************************************************
+ Adds the digest of a record to the digests already streamed by the queries
+ of an IN predicate, held in an open addressing table indexed by the leading
+ bytes of the digest, which are evenly distributed.
  *
- * @param as_object_p               The C client's aerospike object.
- * @param error_p                   The C client's as_error to be set to the encountered error.
- * @param namespace_p               The namespace to scan.
- * @param set_p                     The set to scan.
- * @param user_func_p               The user's callback to be applied per record
- *                                  that is scanned.
- * @param bins_ht_p                 The HashTable for optional filter bins array.
- * @param predicate_p               The HashTable for Query Predicate array.
- * @param options_p                 The optional policy.
+ * @param filter_udata_p            The query_filter_udata holding the digests.
+ * @param digest_p                  The digest of the record.
  *
- * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ * @return true if the digest was not streamed yet, or could not be tracked.
  ******************************************************************************************************
  */
-extern as_status
-aerospike_query_run(aerospike* as_object_p, as_error* error_p, char* namespace_p,
-        char* set_p, userland_callback* user_func_p, HashTable* bins_ht_p,
-        HashTable* predicate_ht_p, zval* options_p TSRMLS_DC)
+static bool
+aerospike_query_digest_add(query_filter_udata* filter_udata_p, const uint8_t* digest_p)
 {
-    as_query            query;
-    bool                is_init_query = false;
-    as_policy_query     query_policy;
+    uint8_t*            digests_p = NULL;
+    uint8_t*            slot_p = NULL;
+    uint32_t            capacity = 0;
+    uint32_t            mask = 0;
+    uint32_t            hash = 0;
+    uint32_t            i;
+    uint32_t            j;
+    static const uint8_t empty[AS_DIGEST_VALUE_SIZE] = {0};
 
-    if ((!as_object_p) || (!error_p) || (!namespace_p) || (!set_p)) {
-        DEBUG_PHP_EXT_DEBUG("Unable to initiate query");
-        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR, "Unable to initiate query");
-        goto exit;
+    if (filter_udata_p->digests_count * 2 >= filter_udata_p->digests_capacity) {
+        capacity = filter_udata_p->digests_capacity ? filter_udata_p->digests_capacity * 2 : 1024;
+        if (!(digests_p = (uint8_t *) calloc(capacity, AS_DIGEST_VALUE_SIZE))) {
+            return true;
+        }
+        for (i = 0; i < filter_udata_p->digests_capacity; i++) {
+            slot_p = filter_udata_p->digests_p + i * AS_DIGEST_VALUE_SIZE;
+            if (memcmp(slot_p, empty, AS_DIGEST_VALUE_SIZE) == 0) {
+                continue;
+            }
+            memcpy(&hash, slot_p, sizeof(hash));
+            j = hash & (capacity - 1);
+            while (memcmp(digests_p + j * AS_DIGEST_VALUE_SIZE, empty, AS_DIGEST_VALUE_SIZE) != 0) {
+                j = (j + 1) & (capacity - 1);
+            }
+            memcpy(digests_p + j * AS_DIGEST_VALUE_SIZE, slot_p, AS_DIGEST_VALUE_SIZE);
+        }
+        free(filter_udata_p->digests_p);
+        filter_udata_p->digests_p = digests_p;
+        filter_udata_p->digests_capacity = capacity;
     }
 
-    set_policy(NULL, NULL, NULL, NULL, NULL, NULL, &query_policy, NULL,
-            options_p, error_p TSRMLS_CC);
-    if (AEROSPIKE_OK != (error_p->code)) {
-        DEBUG_PHP_EXT_DEBUG("Unable to set policy");
-        goto exit;
+    mask = filter_udata_p->digests_capacity - 1;
+    memcpy(&hash, digest_p, sizeof(hash));
+    j = hash & mask;
+    while (memcmp((slot_p = filter_udata_p->digests_p + j * AS_DIGEST_VALUE_SIZE),
+                empty, AS_DIGEST_VALUE_SIZE) != 0) {
+        if (memcmp(slot_p, digest_p, AS_DIGEST_VALUE_SIZE) == 0) {
+            return false;
+        }
+        j = (j + 1) & mask;
     }
+    memcpy(slot_p, digest_p, AS_DIGEST_VALUE_SIZE);
+    filter_udata_p->digests_count++;
+    return true;
+}
 
-    as_query_init(&query, namespace_p, set_p);
-    is_init_query = true;
+/*
+ ******************************************************************************************************
+ Converts a PHP string or integer into an as_val owned by a query filter.
+ *
+ * @param val_p                     The zval to be converted.
+ *
+ * @return The as_val, or NULL if the zval is neither a string nor an integer.
+ ******************************************************************************************************
+ */
+static as_val*
+aerospike_query_filter_val(zval* val_p)
+{
+    switch (Z_TYPE_P(val_p)) {
+        case IS_LONG:
+            return (as_val *) as_integer_new(Z_LVAL_P(val_p));
+        case IS_STRING:
+            return (as_val *) as_string_new(strdup(Z_STRVAL_P(val_p)), true);
+        default:
+            return NULL;
+    }
+}
 
-    if (predicate_ht_p) {
-        as_query_where_inita(&query, 1);
+/*
+ ******************************************************************************************************
+ Compares two integer or string as_vals.
+ *
+ * @return true if both values have the same type and value.
+ ******************************************************************************************************
+ */
+static bool
+aerospike_query_val_equals(const as_val* val1_p, const as_val* val2_p)
+{
+    if (!val1_p || !val2_p || as_val_type(val1_p) != as_val_type(val2_p)) {
+        return false;
     }
 
-    if (AEROSPIKE_OK != (aerospike_query_define(&query, error_p, namespace_p,
-                    set_p, predicate_ht_p, NULL, NULL, NULL TSRMLS_CC))) {
-        DEBUG_PHP_EXT_DEBUG("Unable to define scan");
-        goto exit;
+    switch (as_val_type(val1_p)) {
+        case AS_INTEGER:
+            return as_integer_get((as_integer *) val1_p) ==
+                as_integer_get((as_integer *) val2_p);
+        case AS_STRING:
+            return strcmp(as_string_get((as_string *) val1_p),
+                    as_string_get((as_string *) val2_p)) == 0;
+        default:
+            return false;
     }
+}
 
-    if (bins_ht_p) {
-        as_query_select_inita(&query, zend_hash_num_elements(bins_ht_p));
-        HashPosition pos;
-        zval **bin_names_pp = NULL;
-        foreach_hashtable(bins_ht_p, pos, bin_names_pp) {
-            if (Z_TYPE_PP(bin_names_pp) != IS_STRING) {
-                convert_to_string_ex(bin_names_pp);
+/*
+ ******************************************************************************************************
+ Checks whether a bin value passes a query filter.
+ *
+ * @param filter_p                  The filter.
+ * @param bin_val_p                 The value of the filter's bin in the record.
+ *
+ * @return true if the value passes the filter.
+ ******************************************************************************************************
+ */
+static bool
+aerospike_query_filter_match(const query_filter* filter_p, const as_val* bin_val_p)
+{
+    as_integer*         integer_p = NULL;
+    as_list*            list_p = NULL;
+    as_map*             map_p = NULL;
+    uint32_t            i;
+
+    if (!bin_val_p) {
+        return false;
+    }
+
+    switch (filter_p->op) {
+        case QUERY_FILTER_EQ:
+            return aerospike_query_val_equals(filter_p->val_p, bin_val_p);
+        case QUERY_FILTER_BETWEEN:
+            integer_p = as_integer_fromval(bin_val_p);
+            return integer_p && as_integer_get(integer_p) >= filter_p->min &&
+                as_integer_get(integer_p) <= filter_p->max;
+        case QUERY_FILTER_IN:
+            for (i = 0; i < filter_p->vals_count; i++) {
+                if (aerospike_query_val_equals(filter_p->vals_pp[i], bin_val_p)) {
+                    return true;
+                }
             }
-            if (!as_query_select(&query, Z_STRVAL_PP(bin_names_pp))) {
-                DEBUG_PHP_EXT_DEBUG("Unable to apply filter bins to the query");
-                PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
-                        "Unable to apply filter bins to the query");
-                goto exit;
+            return false;
+        case QUERY_FILTER_CONTAINS:
+            if ((list_p = as_list_fromval((as_val *) bin_val_p))) {
+                for (i = 0; i < as_list_size(list_p); i++) {
+                    if (aerospike_query_val_equals(filter_p->val_p,
+                                as_list_get(list_p, i))) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            if ((map_p = as_map_fromval(bin_val_p))) {
+                return as_map_get(map_p, filter_p->val_p) != NULL;
+            }
+            return false;
+    }
+    return false;
+}
+
+/*
+ ******************************************************************************************************
+ Callback for a query with filters. Records failing any filter, or already
+ streamed by another query of an IN predicate, are dropped before being
+ converted into PHP arrays, the others are passed on to
+ aerospike_helper_record_stream_callback.
+ *
+ * @param val_p                     The record as an as_val, or NULL once the
+ *                                  query is complete.
+ * @param udata_p                   The query_filter_udata.
+ *
+ * @return true to continue the query, false once the userland callback
+ *         asked to stop.
+ ******************************************************************************************************
+ */
+static bool
+aerospike_query_filter_callback(const as_val* val_p, void* udata_p)
+{
+    query_filter_udata*     filter_udata_p = (query_filter_udata *) udata_p;
+    as_record*              record_p = NULL;
+    bool                    is_new = true;
+    uint32_t                i;
+
+    if (filter_udata_p->is_stopped ||
+            USERLAND_CALLBACK_LIMIT_REACHED(filter_udata_p->user_func_p)) {
+        return false;
+    }
+
+    if (val_p && (record_p = as_record_fromval(val_p))) {
+        for (i = 0; i < filter_udata_p->filters_count; i++) {
+            if (!aerospike_query_filter_match(&filter_udata_p->filters_p[i],
+                        (const as_val *) as_record_get(record_p,
+                            filter_udata_p->filters_p[i].bin_p))) {
+                return true;
             }
         }
-        if (AEROSPIKE_OK != (aerospike_query_foreach(as_object_p, error_p,
-                        &query_policy, &query,
-                        aerospike_helper_record_stream_callback,
-                        user_func_p))) {
-            DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
-            goto exit;
+        if (filter_udata_p->is_dedup) {
+            pthread_mutex_lock(&filter_udata_p->dedup_lock);
+            is_new = aerospike_query_digest_add(filter_udata_p,
+                    record_p->key.digest.value);
+            pthread_mutex_unlock(&filter_udata_p->dedup_lock);
+            if (!is_new) {
+                return true;
+            }
         }
-    } else if (AEROSPIKE_OK != (aerospike_query_foreach(as_object_p, error_p,
-                    NULL, &query, aerospike_helper_record_stream_callback,
-                    user_func_p))) {
-        DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
-        goto exit;
     }
-exit:
-    if (is_init_query) {
-        as_query_destroy(&query);
+
+    if (!aerospike_helper_record_stream_callback(val_p,
+                filter_udata_p->user_func_p)) {
+        filter_udata_p->is_stopped = true;
+        return false;
     }
-    return error_p->code;
+    return true;
 }
 
 /*
  ******************************************************************************************************
- Executes a query aggregation in the Aerospike DB by applying the UDF.
+ Compiles a predicate array into a query filter.
  *
- * @param as_object_p               The C client's aerospike object.
+ * @param filter_p                  The filter to be initialized.
  * @param error_p                   The C client's as_error to be set to the encountered error.
- * @param module_p                  The name of UDF module containing the function
- *                                  to execute.
- * @param function_p                The name of the function to be applied to
- *                                  the record.
- * @param args_pp                   An array of arguments for the UDF.
- * @param namespace_p               The namespace to scan.
- * @param set_p                     The set to scan.
- * @param bins_ht_p                 The HashTable for optional filter bins array.
- * @param predicate_p               The HashTable for Query Predicate array.
- * @param return_value_p            The return value of aggregation to be
- *                                  populated by this method.
- * @param options_p                 The optional policy.
+ * @param predicate_ht_p            The HashTable of the predicate, with the
+ *                                  keys 'bin', 'op' and 'val'.
  *
  * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
  ******************************************************************************************************
  */
-extern as_status
-aerospike_query_aggregate(aerospike* as_object_p, as_error* error_p,
-        const char* module_p, const char* function_p, zval** args_pp,
-        char* namespace_p, char* set_p, HashTable* bins_ht_p,
-        HashTable* predicate_ht_p, zval* outer_container_p,
-        zval* options_p TSRMLS_DC)
+static as_status
+aerospike_query_filter_init(query_filter* filter_p, as_error* error_p,
+        HashTable* predicate_ht_p TSRMLS_DC)
 {
-    as_arraylist                args_list;
-    as_arraylist*               args_list_p = NULL;
-    as_static_pool              udf_pool = {0};
-    uint32_t                    serializer_policy = -1;
-    as_policy_query             query_policy;
-    as_query                    query;
-    bool                        is_init_query = false;
-    foreach_callback_udata      aggregate_result_callback_udata;
-    zval*                       key_container_p = NULL;
-    zval*                       return_value_p = NULL;
-    bool                        key_container_assoc = false;
-    bool                        return_value_assoc = false;
+    zval**              op_pp = NULL;
+    zval**              bin_pp = NULL;
+    zval**              val_pp = NULL;
+    zval**              min_pp = NULL;
+    zval**              max_pp = NULL;
+    zval**              in_val_pp = NULL;
+    HashPosition        pos;
 
-    if ((!as_object_p) || (!error_p) || (!module_p) || (!function_p) ||
-            (!args_pp && (!(*args_pp))) || (!namespace_p) || (!set_p) ||
-            (!predicate_ht_p) || (!outer_container_p)) {
-        DEBUG_PHP_EXT_DEBUG("Unable to initiate query aggregation");
-        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR, "Unable to initiate query aggregation");
+    if ((FAILURE == zend_hash_find(predicate_ht_p, OP, sizeof(OP), (void **) &op_pp)) ||
+            (FAILURE == zend_hash_find(predicate_ht_p, BIN, sizeof(BIN), (void **) &bin_pp)) ||
+            (FAILURE == zend_hash_find(predicate_ht_p, VAL, sizeof(VAL), (void **) &val_pp)) ||
+            (Z_TYPE_PP(op_pp) != IS_STRING) || (Z_TYPE_PP(bin_pp) != IS_STRING)) {
+        DEBUG_PHP_EXT_DEBUG("Predicate is expected to include the keys 'bin','op', and 'val'.");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                "Predicate is expected to include the keys 'bin','op', and 'val'.");
         goto exit;
     }
 
-    set_policy(NULL, NULL, NULL, NULL, NULL, NULL, &query_policy,
-            &serializer_policy, options_p, error_p TSRMLS_CC);
-    if (AEROSPIKE_OK != (error_p->code)) {
-        DEBUG_PHP_EXT_DEBUG("Unable to set policy");
-        goto exit;
-    }
+    filter_p->bin_p = Z_STRVAL_PP(bin_pp);
 
-    if ((*args_pp)) {
-        as_arraylist_init(&args_list,
-                zend_hash_num_elements(Z_ARRVAL_PP(args_pp)), 0);
-        args_list_p = &args_list;
-        AS_LIST_PUT(NULL, args_pp, &args_list, &udf_pool,
-                serializer_policy, error_p TSRMLS_CC);
-        if (AEROSPIKE_OK != (error_p->code)) {
-            DEBUG_PHP_EXT_DEBUG("Unable to create args list for UDF");
+    if (strcmp(Z_STRVAL_PP(op_pp), "=") == 0) {
+        filter_p->op = QUERY_FILTER_EQ;
+        if (!(filter_p->val_p = aerospike_query_filter_val(*val_pp))) {
+            goto type_error;
+        }
+    } else if (strcmp(Z_STRVAL_PP(op_pp), "CONTAINS") == 0) {
+        filter_p->op = QUERY_FILTER_CONTAINS;
+        if (!(filter_p->val_p = aerospike_query_filter_val(*val_pp))) {
+            goto type_error;
+        }
+    } else if (strcmp(Z_STRVAL_PP(op_pp), "BETWEEN") == 0) {
+        filter_p->op = QUERY_FILTER_BETWEEN;
+        if ((Z_TYPE_PP(val_pp) != IS_ARRAY) ||
+                (zend_hash_index_find(Z_ARRVAL_PP(val_pp), 0, (void **) &min_pp) != SUCCESS) ||
+                (zend_hash_index_find(Z_ARRVAL_PP(val_pp), 1, (void **) &max_pp) != SUCCESS) ||
+                (Z_TYPE_PP(min_pp) != IS_LONG) || (Z_TYPE_PP(max_pp) != IS_LONG)) {
+            DEBUG_PHP_EXT_DEBUG("Predicate BETWEEN 'op' requires an array of (min,max) integers.");
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                    "Predicate BETWEEN 'op' requires an array of (min,max) integers.");
+            goto exit;
+        }
+        filter_p->min = Z_LVAL_PP(min_pp);
+        filter_p->max = Z_LVAL_PP(max_pp);
+    } else if (strcmp(Z_STRVAL_PP(op_pp), "IN") == 0) {
+        filter_p->op = QUERY_FILTER_IN;
+        if ((Z_TYPE_PP(val_pp) != IS_ARRAY) ||
+                (zend_hash_num_elements(Z_ARRVAL_PP(val_pp)) == 0)) {
+            DEBUG_PHP_EXT_DEBUG("Predicate IN 'op' requires a non-empty array of values.");
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                    "Predicate IN 'op' requires a non-empty array of values.");
             goto exit;
         }
+        filter_p->vals_pp = (as_val **) ecalloc(
+                zend_hash_num_elements(Z_ARRVAL_PP(val_pp)), sizeof(as_val *));
+        foreach_hashtable(Z_ARRVAL_PP(val_pp), pos, in_val_pp) {
+            if (!(filter_p->vals_pp[filter_p->vals_count] =
+                        aerospike_query_filter_val(*in_val_pp))) {
+                goto type_error;
+            }
+            filter_p->vals_count++;
+        }
+    } else {
+        DEBUG_PHP_EXT_DEBUG("Unsupported 'op' in predicate");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM, "Unsupported 'op' in predicate");
+        goto exit;
     }
 
-    if (NULL == as_query_init(&query, namespace_p, set_p)) {
-        DEBUG_PHP_EXT_DEBUG("Unable to initialize a query");
-        error_p->code = AEROSPIKE_ERR;
-        goto exit;
+    PHP_EXT_SET_AS_ERR(error_p, DEFAULT_ERRORNO, DEFAULT_ERROR);
+    goto exit;
+
+type_error:
+    DEBUG_PHP_EXT_DEBUG("Predicate 'val' must be either string or integer.");
+    PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+            "Predicate 'val' must be either string or integer.");
+exit:
+    return error_p->code;
+}
+
+/*
+ ******************************************************************************************************
+ Releases the filters of a query, along with the digests streamed and the
+ bins hidden from the userland callback.
+ *
+ * @param filter_udata_p            The query_filter_udata holding the filters.
+ ******************************************************************************************************
+ */
+static void
+aerospike_query_filters_destroy(query_filter_udata* filter_udata_p)
+{
+    uint32_t            i;
+    uint32_t            j;
+    query_filter*       filter_p = NULL;
+
+    if (filter_udata_p->is_dedup) {
+        pthread_mutex_destroy(&filter_udata_p->dedup_lock);
+        free(filter_udata_p->digests_p);
+        filter_udata_p->digests_p = NULL;
+        filter_udata_p->is_dedup = false;
+    }
+    if (filter_udata_p->user_func_p && filter_udata_p->user_func_p->hidden_bins_pp) {
+        efree(filter_udata_p->user_func_p->hidden_bins_pp);
+        filter_udata_p->user_func_p->hidden_bins_pp = NULL;
+        filter_udata_p->user_func_p->hidden_bins_count = 0;
+    }
+    if (!filter_udata_p->filters_p) {
+        return;
     }
 
-    is_init_query = true;
-    as_query_where_inita(&query, 1);
-    if (AEROSPIKE_OK != (aerospike_query_define(&query, error_p, namespace_p,
-                    set_p, predicate_ht_p, module_p, function_p,
-                    args_list_p TSRMLS_CC))) {
-        DEBUG_PHP_EXT_DEBUG("Unable to define query");
-        goto exit;
+    for (i = 0; i < filter_udata_p->filters_count; i++) {
+        filter_p = &filter_udata_p->filters_p[i];
+        if (filter_p->val_p) {
+            as_val_destroy(filter_p->val_p);
+        }
+        if (filter_p->vals_pp) {
+            for (j = 0; j < filter_p->vals_count; j++) {
+                as_val_destroy(filter_p->vals_pp[j]);
+            }
+            efree(filter_p->vals_pp);
+        }
     }
+    efree(filter_udata_p->filters_p);
+    filter_udata_p->filters_p = NULL;
+}
 
-    MAKE_STD_ZVAL(return_value_p);
-    array_init(return_value_p);
+/*
+ ******************************************************************************************************
+ Lists the bins of the filters missing from the requested bins in the
+ userland callback, as they are selected only to evaluate the filters and
+ must not show up in the records.
+ *
+ * @param filter_udata_p            The query_filter_udata holding the filters.
+ * @param bins_ht_p                 The HashTable for optional filter bins array.
+ ******************************************************************************************************
+ */
+static void
+aerospike_query_hide_filter_bins(query_filter_udata* filter_udata_p,
+        HashTable* bins_ht_p TSRMLS_DC)
+{
+    userland_callback*  user_func_p = filter_udata_p->user_func_p;
+    HashPosition        pos;
+    zval**              bin_names_pp = NULL;
+    const char*         bin_p = NULL;
+    bool                is_selected = false;
+    uint32_t            i;
+    uint32_t            j;
 
-    if (0 != add_assoc_zval(outer_container_p, PHP_AS_RECORD_DEFINE_FOR_BINS, return_value_p)) {
-       DEBUG_PHP_EXT_DEBUG("Unable to get result of aggregate");
-       error_p->code = AEROSPIKE_ERR;
-       goto exit;
+    if (!bins_ht_p || !user_func_p || !filter_udata_p->filters_count) {
+        return;
     }
 
-    return_value_assoc = true;
-    aggregate_result_callback_udata.udata_p = return_value_p;
-    aggregate_result_callback_udata.error_p = error_p;
+    user_func_p->hidden_bins_pp = (const char **) ecalloc(
+            filter_udata_p->filters_count, sizeof(const char *));
+    for (i = 0; i < filter_udata_p->filters_count; i++) {
+        bin_p = filter_udata_p->filters_p[i].bin_p;
+        is_selected = false;
+        foreach_hashtable(bins_ht_p, pos, bin_names_pp) {
+            if (Z_TYPE_PP(bin_names_pp) != IS_STRING) {
+                convert_to_string_ex(bin_names_pp);
+            }
+            if (strcmp(Z_STRVAL_PP(bin_names_pp), bin_p) == 0) {
+                is_selected = true;
+                break;
+            }
+        }
+        for (j = 0; !is_selected && j < user_func_p->hidden_bins_count; j++) {
+            is_selected = (strcmp(user_func_p->hidden_bins_pp[j], bin_p) == 0);
+        }
+        if (!is_selected) {
+            user_func_p->hidden_bins_pp[user_func_p->hidden_bins_count++] = bin_p;
+        }
+    }
+}
+
+/*
+ ******************************************************************************************************
+ Runs a single as_query, either on the predicate array or, for one value of an
+ IN predicate, on an equality predicate on the given bin.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param query_policy_p            The query policy.
+ * @param namespace_p               The namespace to query.
+ * @param set_p                     The set to query.
+ * @param predicate_ht_p            The HashTable for Query Predicate array,
+ *                                  ignored if in_bin_p is set.
+ * @param in_bin_p                  The bin of an IN predicate, or NULL.
+ * @param in_val_pp                 The value of an IN predicate to be queried.
+ * @param bins_ht_p                 The HashTable for optional filter bins array.
+ * @param filter_udata_p            The udata of the filtering callback.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+static as_status
+aerospike_query_run_one(aerospike* as_object_p, as_error* error_p,
+        as_policy_query* query_policy_p, char* namespace_p, char* set_p,
+        HashTable* predicate_ht_p, const char* in_bin_p, zval** in_val_pp,
+        HashTable* bins_ht_p, query_filter_udata* filter_udata_p TSRMLS_DC)
+{
+    as_query            query;
+    HashPosition        pos;
+    zval**              bin_names_pp = NULL;
+    uint32_t            i;
+    uint32_t            j;
+    uint64_t            started_at = 0;
+
+    as_query_init(&query, namespace_p, set_p);
+
+    if (in_bin_p) {
+        as_query_where_inita(&query, 1);
+        if (AEROSPIKE_OK != aerospike_query_where_equals(&query, error_p,
+                    in_bin_p, in_val_pp TSRMLS_CC)) {
+            goto exit;
+        }
+    } else {
+        if (predicate_ht_p) {
+            as_query_where_inita(&query, 1);
+        }
+        if (AEROSPIKE_OK != (aerospike_query_define(&query, error_p, namespace_p,
+                        set_p, predicate_ht_p, NULL, NULL, NULL TSRMLS_CC))) {
+            DEBUG_PHP_EXT_DEBUG("Unable to define query");
+            goto exit;
+        }
+    }
 
     if (bins_ht_p) {
-        as_query_select_inita(&query, zend_hash_num_elements(bins_ht_p));
-        HashPosition pos;
-        zval **bin_names_pp = NULL;
+        /*
+         * The bins the filters are evaluated on are selected along with the
+         * requested ones, as a record missing them would never pass.
+         */
+        as_query_select_inita(&query, zend_hash_num_elements(bins_ht_p) +
+                filter_udata_p->filters_count);
         foreach_hashtable(bins_ht_p, pos, bin_names_pp) {
             if (Z_TYPE_PP(bin_names_pp) != IS_STRING) {
                 convert_to_string_ex(bin_names_pp);
@@ -336,88 +689,1267 @@ aerospike_query_aggregate(aerospike* as_object_p, as_error* error_p,
                 goto exit;
             }
         }
-
-        if (AEROSPIKE_OK != (aerospike_query_foreach(as_object_p, error_p,
-                        &query_policy, &query,
-                        aerospike_helper_aggregate_callback,
-                        &aggregate_result_callback_udata))) {
-            DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
-            goto exit;
+        for (i = 0; i < filter_udata_p->filters_count; i++) {
+            for (j = 0; j < query.select.size; j++) {
+                if (strcmp(query.select.entries[j],
+                            filter_udata_p->filters_p[i].bin_p) == 0) {
+                    break;
+                }
+            }
+            if (j == query.select.size &&
+                    !as_query_select(&query, filter_udata_p->filters_p[i].bin_p)) {
+                DEBUG_PHP_EXT_DEBUG("Unable to apply filter bins to the query");
+                PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                        "Unable to apply filter bins to the query");
+                goto exit;
+            }
         }
-    } else if (AEROSPIKE_OK != (aerospike_query_foreach(as_object_p, error_p,
-                    &query_policy, &query, aerospike_helper_aggregate_callback,
-                    &aggregate_result_callback_udata))) {
+    }
+
+    started_at = aerospike_latency_now();
+    aerospike_query_foreach(as_object_p, error_p, query_policy_p, &query,
+            aerospike_query_filter_callback, filter_udata_p);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_QUERY, NULL, started_at);
+    if (AEROSPIKE_OK != error_p->code) {
         DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
         goto exit;
     }
+exit:
+    as_query_destroy(&query);
+    return error_p->code;
+}
 
-    if (is_init_query == true) {
+/*
+ ******************************************************************************************************
+ Checks with the secondary index cache whether the bin of the index predicate
+ has an index of the type of the predicate value. The cache is reloaded if
+ stale, and a query is let through to the server if it can not be loaded.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param sindex_cache_p            The secondary index cache, or NULL.
+ * @param namespace_p               The namespace to query.
+ * @param set_p                     The set to query.
+ * @param predicate_ht_p            The HashTable of the index predicate.
+ *
+ * @return false only if the cache has no index for the predicate.
+ ******************************************************************************************************
+ */
+static bool
+aerospike_query_has_index(aerospike* as_object_p,
+        aerospike_sindex_cache* sindex_cache_p, char* namespace_p, char* set_p,
+        HashTable* predicate_ht_p TSRMLS_DC)
+{
+    as_error            error;
+    zval**              op_pp = NULL;
+    zval**              bin_pp = NULL;
+    zval**              val_pp = NULL;
+    zval**              first_val_pp = NULL;
+    HashPosition        pos;
+    int                 type = -1;
 
-        MAKE_STD_ZVAL(key_container_p);
-        array_init(key_container_p);
+    if (!sindex_cache_p || !predicate_ht_p ||
+            (FAILURE == zend_hash_find(predicate_ht_p, OP, sizeof(OP), (void **) &op_pp)) ||
+            (FAILURE == zend_hash_find(predicate_ht_p, BIN, sizeof(BIN), (void **) &bin_pp)) ||
+            (FAILURE == zend_hash_find(predicate_ht_p, VAL, sizeof(VAL), (void **) &val_pp)) ||
+            (Z_TYPE_PP(op_pp) != IS_STRING) || (Z_TYPE_PP(bin_pp) != IS_STRING)) {
+        return true;
+    }
 
-        if (0 != add_assoc_stringl(key_container_p, PHP_AS_KEY_DEFINE_FOR_NS, query.ns, strlen(query.ns), 1)) {
-            DEBUG_PHP_EXT_DEBUG("Unable to get namespace");
-            error_p->code = AEROSPIKE_ERR;
-            goto exit;
+    if (strcmp(Z_STRVAL_PP(op_pp), "BETWEEN") == 0) {
+        type = INDEX_TYPE_INTEGER;
+    } else {
+        if (strcmp(Z_STRVAL_PP(op_pp), "IN") == 0 && Z_TYPE_PP(val_pp) == IS_ARRAY) {
+            zend_hash_internal_pointer_reset_ex(Z_ARRVAL_PP(val_pp), &pos);
+            if (SUCCESS == zend_hash_get_current_data_ex(Z_ARRVAL_PP(val_pp),
+                        (void **) &first_val_pp, &pos)) {
+                val_pp = first_val_pp;
+            }
         }
-
-        if ( 0 != add_assoc_stringl(key_container_p, PHP_AS_KEY_DEFINE_FOR_SET, query.set, strlen(query.set), 1)) {
-            DEBUG_PHP_EXT_DEBUG("Unable to get set");
-            error_p->code = AEROSPIKE_ERR;
-            goto exit;
+        if (Z_TYPE_PP(val_pp) == IS_LONG) {
+            type = INDEX_TYPE_INTEGER;
+        } else if (Z_TYPE_PP(val_pp) == IS_STRING) {
+            type = INDEX_TYPE_STRING;
         }
+    }
 
-        if (0 != add_assoc_null(key_container_p, PHP_AS_KEY_DEFINE_FOR_KEY)) {
-            DEBUG_PHP_EXT_DEBUG("Unable to get primary key of a record");
-            error_p->code = AEROSPIKE_ERR;
-            goto exit;
-        }
+    as_error_init(&error);
+    if (AEROSPIKE_OK != aerospike_index_cache_refresh(as_object_p, &error,
+                sindex_cache_p, false, NULL TSRMLS_CC)) {
+        DEBUG_PHP_EXT_DEBUG("%s", error.message);
+        return true;
+    }
+    if (aerospike_index_cache_lookup(sindex_cache_p, namespace_p, set_p,
+                Z_STRVAL_PP(bin_pp), type)) {
+        return true;
+    }
 
-        if (0 != add_assoc_null(key_container_p, PHP_AS_KEY_DEFINE_FOR_DIGEST)) {
-            DEBUG_PHP_EXT_DEBUG("Unable to get primary of a record");
-            error_p->code = AEROSPIKE_ERR;
-            goto exit;
+    /*
+     * The index may have been created by another client since the cache
+     * was loaded, so the cache is reloaded once before the query fails,
+     * unless it was loaded within the last second.
+     */
+    if (!aerospike_index_cache_is_reloadable(sindex_cache_p)) {
+        return false;
+    }
+    if (AEROSPIKE_OK != aerospike_index_cache_refresh(as_object_p, &error,
+                sindex_cache_p, true, NULL TSRMLS_CC)) {
+        DEBUG_PHP_EXT_DEBUG("%s", error.message);
+        return true;
+    }
+    return aerospike_index_cache_lookup(sindex_cache_p, namespace_p, set_p,
+            Z_STRVAL_PP(bin_pp), type);
+}
+
+/*
+ ******************************************************************************************************
+ Runs a query on a bin without a secondary index as a scan of the set, of
+ which the records are evaluated against the filters, the index predicate
+ being the first of them.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param query_policy_p            The query policy, of which the timeout is used.
+ * @param namespace_p               The namespace to scan.
+ * @param set_p                     The set to scan.
+ * @param bins_ht_p                 The HashTable for optional filter bins array.
+ * @param filter_udata_p            The udata of the filtering callback.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+static as_status
+aerospike_query_scan_fallback(aerospike* as_object_p, as_error* error_p,
+        as_policy_query* query_policy_p, char* namespace_p, char* set_p,
+        HashTable* bins_ht_p, query_filter_udata* filter_udata_p TSRMLS_DC)
+{
+    as_scan             scan;
+    as_policy_scan      scan_policy;
+    HashPosition        pos;
+    zval**              bin_names_pp = NULL;
+    uint32_t            i;
+    uint32_t            j;
+    uint64_t            started_at = 0;
+
+    as_scan_init(&scan, namespace_p, set_p);
+    as_policy_scan_init(&scan_policy);
+    scan_policy.timeout = query_policy_p->timeout;
+
+    if (bins_ht_p) {
+        as_scan_select_inita(&scan, zend_hash_num_elements(bins_ht_p) +
+                filter_udata_p->filters_count);
+        foreach_hashtable(bins_ht_p, pos, bin_names_pp) {
+            if (Z_TYPE_PP(bin_names_pp) != IS_STRING) {
+                convert_to_string_ex(bin_names_pp);
+            }
+            if (!as_scan_select(&scan, Z_STRVAL_PP(bin_names_pp))) {
+                DEBUG_PHP_EXT_DEBUG("Unable to apply filter bins to the scan");
+                PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                        "Unable to apply filter bins to the scan");
+                goto exit;
+            }
+        }
+        for (i = 0; i < filter_udata_p->filters_count; i++) {
+            for (j = 0; j < scan.select.size; j++) {
+                if (strcmp(scan.select.entries[j],
+                            filter_udata_p->filters_p[i].bin_p) == 0) {
+                    break;
+                }
+            }
+            if (j == scan.select.size &&
+                    !as_scan_select(&scan, filter_udata_p->filters_p[i].bin_p)) {
+                DEBUG_PHP_EXT_DEBUG("Unable to apply filter bins to the scan");
+                PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                        "Unable to apply filter bins to the scan");
+                goto exit;
+            }
         }
+    }
 
-        if (0 != add_assoc_zval(outer_container_p, PHP_AS_KEY_DEFINE_FOR_KEY, key_container_p)) {
-            DEBUG_PHP_EXT_DEBUG("Unable to get a key");
-            error_p->code = AEROSPIKE_ERR;
-            goto exit;
+    started_at = aerospike_latency_now();
+    aerospike_scan_foreach(as_object_p, error_p, &scan_policy, &scan,
+            aerospike_query_filter_callback, filter_udata_p);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_QUERY, NULL, started_at);
+    if (AEROSPIKE_OK != error_p->code) {
+        DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+        goto exit;
+    }
+exit:
+    as_scan_destroy(&scan);
+    return error_p->code;
+}
+
+/*
+ ******************************************************************************************************
+ Executes a query in the Aerospike DB.
+ *
+ * The where array is either a single predicate, or a list of predicates of
+ * which the first one is run against the secondary index and the others are
+ * evaluated on the records it returns, before they are converted into PHP
+ * arrays. An IN predicate on the index runs one query per value, and a
+ * record streamed by several of them is handed to the callback once.
+ *
+ * A query on a bin which the secondary index cache shows has no index fails
+ * with AEROSPIKE_ERR_INDEX, as the server would, without reaching it, or runs as
+ * a filtered scan with OPT_QUERY_SCAN_FALLBACK.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param sindex_cache_p            The secondary index cache, or NULL not to
+ *                                  check for an index.
+ * @param namespace_p               The namespace to scan.
+ * @param set_p                     The set to scan.
+ * @param user_func_p               The user's callback to be applied per record
+ *                                  that is scanned.
+ * @param bins_ht_p                 The HashTable for optional filter bins array.
+ * @param predicate_p               The HashTable for Query Predicate array.
+ * @param options_p                 The optional policy.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+extern as_status
+aerospike_query_run(aerospike* as_object_p, as_error* error_p,
+        aerospike_sindex_cache* sindex_cache_p, char* namespace_p,
+        char* set_p, userland_callback* user_func_p, HashTable* bins_ht_p,
+        HashTable* predicate_ht_p, zval* options_p TSRMLS_DC)
+{
+    as_policy_query     query_policy;
+    query_filter_udata  filter_udata;
+    HashTable*          index_predicate_ht_p = predicate_ht_p;
+    HashPosition        pos;
+    zval**              predicate_pp = NULL;
+    zval**              op_pp = NULL;
+    zval**              bin_pp = NULL;
+    zval**              val_pp = NULL;
+    zval**              in_val_pp = NULL;
+    zval**              fallback_pp = NULL;
+    bool                is_index_predicate = true;
+
+    memset(&filter_udata, 0, sizeof(filter_udata));
+    filter_udata.user_func_p = user_func_p;
+
+    if ((!as_object_p) || (!error_p) || (!namespace_p) || (!set_p)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to initiate query");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR, "Unable to initiate query");
+        goto exit;
+    }
+
+    set_policy(NULL, NULL, NULL, NULL, NULL, NULL, &query_policy, NULL,
+            options_p, error_p TSRMLS_CC);
+    if (AEROSPIKE_OK != (error_p->code)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+        goto exit;
+    }
+
+    aerospike_helper_set_max_records(user_func_p, options_p);
+
+    if (predicate_ht_p && (zend_hash_num_elements(predicate_ht_p) != 0) &&
+            !zend_hash_exists(predicate_ht_p, BIN, sizeof(BIN))) {
+        index_predicate_ht_p = NULL;
+        filter_udata.filters_p = (query_filter *) ecalloc(
+                zend_hash_num_elements(predicate_ht_p), sizeof(query_filter));
+        foreach_hashtable(predicate_ht_p, pos, predicate_pp) {
+            if (Z_TYPE_PP(predicate_pp) != IS_ARRAY) {
+                DEBUG_PHP_EXT_DEBUG("Each predicate in the where list must be an array.");
+                PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                        "Each predicate in the where list must be an array.");
+                goto exit;
+            }
+            if (is_index_predicate) {
+                index_predicate_ht_p = Z_ARRVAL_PP(predicate_pp);
+                is_index_predicate = false;
+                continue;
+            }
+            filter_udata.filters_count++;
+            if (AEROSPIKE_OK != aerospike_query_filter_init(
+                        &filter_udata.filters_p[filter_udata.filters_count - 1],
+                        error_p, Z_ARRVAL_PP(predicate_pp) TSRMLS_CC)) {
+                goto exit;
+            }
         }
+    }
 
-        key_container_assoc = true;
+    if (index_predicate_ht_p &&
+            (SUCCESS == zend_hash_find(index_predicate_ht_p, OP, sizeof(OP),
+                                       (void **) &op_pp)) &&
+            (Z_TYPE_PP(op_pp) == IS_STRING) &&
+            (strcmp(Z_STRVAL_PP(op_pp), "CONTAINS") == 0)) {
+        DEBUG_PHP_EXT_DEBUG("CONTAINS predicates can not be run against a secondary index.");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                "CONTAINS predicates can not be run against a secondary index.");
+        goto exit;
+    }
 
-        if (0 != add_assoc_null(outer_container_p, PHP_AS_RECORD_DEFINE_FOR_METADATA)) {
-            DEBUG_PHP_EXT_DEBUG("Unable to get metadata of a record");
-            error_p->code = AEROSPIKE_ERR;
+    if (!aerospike_query_has_index(as_object_p, sindex_cache_p, namespace_p,
+                set_p, index_predicate_ht_p TSRMLS_CC)) {
+        if (!options_p || (FAILURE == zend_hash_index_find(Z_ARRVAL_P(options_p),
+                        OPT_QUERY_SCAN_FALLBACK, (void **) &fallback_pp)) ||
+                !Z_BVAL_PP(fallback_pp)) {
+            DEBUG_PHP_EXT_DEBUG("No secondary index for the query predicate.");
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_INDEX,
+                    "No secondary index for the query predicate.");
             goto exit;
         }
-
-      /*  if (0 != add_assoc_zval(outer_container_p, PHP_AS_RECORD_DEFINE_FOR_BINS, return_value_p)) {
-            DEBUG_PHP_EXT_DEBUG("Unable to get result of aggregate");
-            error_p->code = AEROSPIKE_ERR;
+        filter_udata.filters_p = (query_filter *) erealloc(filter_udata.filters_p,
+                (filter_udata.filters_count + 1) * sizeof(query_filter));
+        memset(&filter_udata.filters_p[filter_udata.filters_count], 0,
+                sizeof(query_filter));
+        filter_udata.filters_count++;
+        if (AEROSPIKE_OK != aerospike_query_filter_init(
+                    &filter_udata.filters_p[filter_udata.filters_count - 1],
+                    error_p, index_predicate_ht_p TSRMLS_CC)) {
             goto exit;
-        }*/
+        }
+        aerospike_query_hide_filter_bins(&filter_udata, bins_ht_p TSRMLS_CC);
+        aerospike_query_scan_fallback(as_object_p, error_p, &query_policy,
+                namespace_p, set_p, bins_ht_p, &filter_udata TSRMLS_CC);
+        goto exit;
     }
 
-exit:
-    if (args_list_p) {
-        as_arraylist_destroy(args_list_p);
-    }
+    aerospike_query_hide_filter_bins(&filter_udata, bins_ht_p TSRMLS_CC);
 
-    if (is_init_query) {
-        as_query_destroy(&query);
+    if (op_pp && (Z_TYPE_PP(op_pp) == IS_STRING) &&
+            (strcmp(Z_STRVAL_PP(op_pp), "IN") == 0)) {
+        if ((FAILURE == zend_hash_find(index_predicate_ht_p, BIN, sizeof(BIN),
+                        (void **) &bin_pp)) || (Z_TYPE_PP(bin_pp) != IS_STRING) ||
+                (FAILURE == zend_hash_find(index_predicate_ht_p, VAL, sizeof(VAL),
+                        (void **) &val_pp)) || (Z_TYPE_PP(val_pp) != IS_ARRAY) ||
+                (zend_hash_num_elements(Z_ARRVAL_PP(val_pp)) == 0)) {
+            DEBUG_PHP_EXT_DEBUG("Predicate IN 'op' requires a non-empty array of values.");
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                    "Predicate IN 'op' requires a non-empty array of values.");
+            goto exit;
+        }
+        if (zend_hash_num_elements(Z_ARRVAL_PP(val_pp)) > 1) {
+            pthread_mutex_init(&filter_udata.dedup_lock, NULL);
+            filter_udata.is_dedup = true;
+        }
+        foreach_hashtable(Z_ARRVAL_PP(val_pp), pos, in_val_pp) {
+            if (filter_udata.is_stopped) {
+                break;
+            }
+            if (AEROSPIKE_OK != aerospike_query_run_one(as_object_p, error_p,
+                        &query_policy, namespace_p, set_p, NULL,
+                        Z_STRVAL_PP(bin_pp), in_val_pp, bins_ht_p,
+                        &filter_udata TSRMLS_CC)) {
+                goto exit;
+            }
+        }
+    } else {
+        aerospike_query_run_one(as_object_p, error_p, &query_policy,
+                namespace_p, set_p, index_predicate_ht_p, NULL, NULL,
+                bins_ht_p, &filter_udata TSRMLS_CC);
     }
 
-    if (error_p->code == AEROSPIKE_ERR) {
-        if (return_value_p && !return_value_assoc)
-            zval_dtor(return_value_p);
-        if (key_container_p && (false == key_container_assoc)) {
-            zval_dtor(key_container_p);
-        }
+exit:
+    /*
+     * The streams aborted on reaching OPT_MAX_RECORDS are not an error,
+     * unlike any other failure of the scan or query.
+     */
+    if (USERLAND_CALLBACK_LIMIT_ABORTED(user_func_p, error_p)) {
+        PHP_EXT_SET_AS_ERR(error_p, DEFAULT_ERRORNO, DEFAULT_ERROR);
     }
+    aerospike_query_filters_destroy(&filter_udata);
+    return error_p->code;
+}
 
+/*
+ ******************************************************************************************************
+ Executes a query aggregation in the Aerospike DB by applying the UDF.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param module_p                  The name of UDF module containing the function
+ *                                  to execute.
+ * @param function_p                The name of the function to be applied to
+ *                                  the record.
+ * @param args_pp                   An array of arguments for the UDF.
+ * @param namespace_p               The namespace to scan.
+ * @param set_p                     The set to scan.
+ * @param bins_ht_p                 The HashTable for optional filter bins array.
+ * @param predicate_p               The HashTable for Query Predicate array.
+ * @param return_value_p            The return value of aggregation to be
+ *                                  populated by this method.
+ * @param options_p                 The optional policy.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+extern as_status
+aerospike_query_aggregate(aerospike* as_object_p, as_error* error_p,
+        const char* module_p, const char* function_p, zval** args_pp,
+        char* namespace_p, char* set_p, HashTable* bins_ht_p,
+        HashTable* predicate_ht_p, zval* outer_container_p,
+        zval* options_p TSRMLS_DC)
+{
+    as_arraylist                args_list;
+    as_arraylist*               args_list_p = NULL;
+    as_static_pool              udf_pool = {0};
+    uint32_t                    serializer_policy = -1;
+    as_policy_query             query_policy;
+    as_query                    query;
+    bool                        is_init_query = false;
+    foreach_callback_udata      aggregate_result_callback_udata;
+    zval*                       key_container_p = NULL;
+    zval*                       return_value_p = NULL;
+    bool                        key_container_assoc = false;
+    bool                        return_value_assoc = false;
+    uint64_t                    started_at = 0;
+
+    if ((!as_object_p) || (!error_p) || (!module_p) || (!function_p) ||
+            (!args_pp && (!(*args_pp))) || (!namespace_p) || (!set_p) ||
+            (!predicate_ht_p) || (!outer_container_p)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to initiate query aggregation");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR, "Unable to initiate query aggregation");
+        goto exit;
+    }
+
+    if (AEROSPIKE_OK != aerospike_helper_reject_max_records(options_p, error_p)) {
+        goto exit;
+    }
+
+    set_policy(NULL, NULL, NULL, NULL, NULL, NULL, &query_policy,
+            &serializer_policy, options_p, error_p TSRMLS_CC);
+    if (AEROSPIKE_OK != (error_p->code)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+        goto exit;
+    }
+
+    if ((*args_pp)) {
+        as_arraylist_init(&args_list,
+                zend_hash_num_elements(Z_ARRVAL_PP(args_pp)), 0);
+        args_list_p = &args_list;
+        AS_LIST_PUT(NULL, args_pp, &args_list, &udf_pool,
+                serializer_policy, error_p TSRMLS_CC);
+        if (AEROSPIKE_OK != (error_p->code)) {
+            DEBUG_PHP_EXT_DEBUG("Unable to create args list for UDF");
+            goto exit;
+        }
+    }
+
+    if (NULL == as_query_init(&query, namespace_p, set_p)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to initialize a query");
+        error_p->code = AEROSPIKE_ERR;
+        goto exit;
+    }
+
+    is_init_query = true;
+    as_query_where_inita(&query, 1);
+    if (AEROSPIKE_OK != (aerospike_query_define(&query, error_p, namespace_p,
+                    set_p, predicate_ht_p, module_p, function_p,
+                    args_list_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_DEBUG("Unable to define query");
+        goto exit;
+    }
+
+    MAKE_STD_ZVAL(return_value_p);
+    array_init(return_value_p);
+
+    if (0 != add_assoc_zval(outer_container_p, PHP_AS_RECORD_DEFINE_FOR_BINS, return_value_p)) {
+       DEBUG_PHP_EXT_DEBUG("Unable to get result of aggregate");
+       error_p->code = AEROSPIKE_ERR;
+       goto exit;
+    }
+
+    return_value_assoc = true;
+    aggregate_result_callback_udata.udata_p = return_value_p;
+    aggregate_result_callback_udata.error_p = error_p;
+
+    started_at = aerospike_latency_now();
+    if (bins_ht_p) {
+        as_query_select_inita(&query, zend_hash_num_elements(bins_ht_p));
+        HashPosition pos;
+        zval **bin_names_pp = NULL;
+        foreach_hashtable(bins_ht_p, pos, bin_names_pp) {
+            if (Z_TYPE_PP(bin_names_pp) != IS_STRING) {
+                convert_to_string_ex(bin_names_pp);
+            }
+            if (!as_query_select(&query, Z_STRVAL_PP(bin_names_pp))) {
+                DEBUG_PHP_EXT_DEBUG("Unable to apply filter bins to the query");
+                PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                        "Unable to apply filter bins to the query");
+                goto exit;
+            }
+        }
+
+        if (AEROSPIKE_OK != (aerospike_query_foreach(as_object_p, error_p,
+                        &query_policy, &query,
+                        aerospike_helper_aggregate_callback,
+                        &aggregate_result_callback_udata))) {
+            DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+            goto exit;
+        }
+    } else if (AEROSPIKE_OK != (aerospike_query_foreach(as_object_p, error_p,
+                    &query_policy, &query, aerospike_helper_aggregate_callback,
+                    &aggregate_result_callback_udata))) {
+        DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+        goto exit;
+    }
+
+    if (is_init_query == true) {
+
+        MAKE_STD_ZVAL(key_container_p);
+        array_init(key_container_p);
+
+        if (0 != add_assoc_stringl(key_container_p, PHP_AS_KEY_DEFINE_FOR_NS, query.ns, strlen(query.ns), 1)) {
+            DEBUG_PHP_EXT_DEBUG("Unable to get namespace");
+            error_p->code = AEROSPIKE_ERR;
+            goto exit;
+        }
+
+        if ( 0 != add_assoc_stringl(key_container_p, PHP_AS_KEY_DEFINE_FOR_SET, query.set, strlen(query.set), 1)) {
+            DEBUG_PHP_EXT_DEBUG("Unable to get set");
+            error_p->code = AEROSPIKE_ERR;
+            goto exit;
+        }
+
+        if (0 != add_assoc_null(key_container_p, PHP_AS_KEY_DEFINE_FOR_KEY)) {
+            DEBUG_PHP_EXT_DEBUG("Unable to get primary key of a record");
+            error_p->code = AEROSPIKE_ERR;
+            goto exit;
+        }
+
+        if (0 != add_assoc_null(key_container_p, PHP_AS_KEY_DEFINE_FOR_DIGEST)) {
+            DEBUG_PHP_EXT_DEBUG("Unable to get primary of a record");
+            error_p->code = AEROSPIKE_ERR;
+            goto exit;
+        }
+
+        if (0 != add_assoc_zval(outer_container_p, PHP_AS_KEY_DEFINE_FOR_KEY, key_container_p)) {
+            DEBUG_PHP_EXT_DEBUG("Unable to get a key");
+            error_p->code = AEROSPIKE_ERR;
+            goto exit;
+        }
+
+        key_container_assoc = true;
+
+        if (0 != add_assoc_null(outer_container_p, PHP_AS_RECORD_DEFINE_FOR_METADATA)) {
+            DEBUG_PHP_EXT_DEBUG("Unable to get metadata of a record");
+            error_p->code = AEROSPIKE_ERR;
+            goto exit;
+        }
+
+      /*  if (0 != add_assoc_zval(outer_container_p, PHP_AS_RECORD_DEFINE_FOR_BINS, return_value_p)) {
+            DEBUG_PHP_EXT_DEBUG("Unable to get result of aggregate");
+            error_p->code = AEROSPIKE_ERR;
+            goto exit;
+        }*/
+    }
+
+exit:
+    if (started_at) {
+        aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_QUERY, NULL, started_at);
+    }
+
+    if (args_list_p) {
+        as_arraylist_destroy(args_list_p);
+    }
+
+    if (is_init_query) {
+        as_query_destroy(&query);
+    }
+
+    if (error_p->code == AEROSPIKE_ERR) {
+        if (return_value_p && !return_value_assoc)
+            zval_dtor(return_value_p);
+        if (key_container_p && (false == key_container_assoc)) {
+            zval_dtor(key_container_p);
+        }
+    }
+
+    aerospike_helper_free_static_pool(&udf_pool);
+    return error_p->code;
+}
+
+/*
+ ******************************************************************************************************
+ * The bin selected by REDUCE_COUNT so that the records stream back without
+ * any bin, as the as_query of this client version has no no_bins flag.
+ ******************************************************************************************************
+ */
+#define REDUCE_COUNT_NO_BIN "\x01"
+
+/*
+ ******************************************************************************************************
+ * State shared by the per-node threads of a native reducer query.
+ * Every field below the lock is only touched while holding it.
+ ******************************************************************************************************
+ */
+typedef struct reduce_callback_udata_t {
+    pthread_mutex_t     lock;
+    long                type;
+    const char*         bin_p;
+    const char*         group_by_p;
+    uint32_t            k;
+    int64_t             count;
+    int64_t             value;
+    bool                has_value;
+    bool                is_overflow;
+    int64_t*            top_p;
+    uint32_t            top_count;
+    as_hashmap*         groups_p;
+} reduce_callback_udata;
+
+/*
+ ******************************************************************************************************
+ Inserts a value into the descending top-k array of the reducer, dropping the
+ smallest value once k values are held.
+ *
+ * @param udata_p                   The reducer state.
+ * @param value                     The value to be considered.
+ ******************************************************************************************************
+ */
+static void
+aerospike_query_reduce_top_k(reduce_callback_udata* udata_p, int64_t value)
+{
+    uint32_t            pos;
+
+    if (udata_p->top_count == udata_p->k) {
+        if (value <= udata_p->top_p[udata_p->k - 1]) {
+            return;
+        }
+        pos = udata_p->k - 1;
+    } else {
+        pos = udata_p->top_count++;
+    }
+
+    while (pos > 0 && udata_p->top_p[pos - 1] < value) {
+        udata_p->top_p[pos] = udata_p->top_p[pos - 1];
+        pos--;
+    }
+    udata_p->top_p[pos] = value;
+}
+
+/*
+ ******************************************************************************************************
+ Adds a value to a sum of the reducer, flagging the reducer instead when the
+ sum would overflow a 64-bit integer.
+ *
+ * @param udata_p                   The reducer state.
+ * @param sum_p                     The sum to be added to.
+ * @param value                     The value to be added.
+ ******************************************************************************************************
+ */
+static void
+aerospike_query_reduce_add(reduce_callback_udata* udata_p, int64_t* sum_p, int64_t value)
+{
+    if ((value > 0 && *sum_p > INT64_MAX - value) ||
+            (value < 0 && *sum_p < INT64_MIN - value)) {
+        udata_p->is_overflow = true;
+        return;
+    }
+    *sum_p += value;
+}
+
+/*
+ ******************************************************************************************************
+ Adds a value to the running sum of its group. String and integer group values
+ are supported, records with any other type in the group bin are skipped.
+ *
+ * @param udata_p                   The reducer state.
+ * @param group_p                   The value of the group by bin.
+ * @param value                     The value to be added to the group's sum.
+ ******************************************************************************************************
+ */
+static void
+aerospike_query_reduce_group(reduce_callback_udata* udata_p,
+        const as_val* group_p, int64_t value)
+{
+    as_integer*         sum_p = NULL;
+    as_val*             key_p = NULL;
+
+    sum_p = as_integer_fromval(as_hashmap_get(udata_p->groups_p, (as_val *) group_p));
+    if (sum_p) {
+        aerospike_query_reduce_add(udata_p, &sum_p->value, value);
+        return;
+    }
+
+    switch (as_val_type(group_p)) {
+        case AS_STRING:
+            key_p = (as_val *) as_string_new(
+                    strdup(as_string_get((as_string *) group_p)), true);
+            break;
+        case AS_INTEGER:
+            key_p = (as_val *) as_integer_new(as_integer_get((as_integer *) group_p));
+            break;
+        default:
+            return;
+    }
+    as_hashmap_set(udata_p->groups_p, key_p, (as_val *) as_integer_new(value));
+}
+
+/*
+ ******************************************************************************************************
+ Callback for a native reducer query. Folds each record streamed back from the
+ cluster into the shared reducer state without touching any zvals, as it may
+ be invoked concurrently from the per-node threads of the C client.
+ *
+ * @param val_p                     The record as an as_val, or NULL once the
+ *                                  query is complete.
+ * @param udata_p                   The reducer state.
+ *
+ * @return true to continue the query.
+ ******************************************************************************************************
+ */
+static bool
+aerospike_query_reduce_callback(const as_val* val_p, void* udata_p)
+{
+    reduce_callback_udata*  reduce_p = (reduce_callback_udata *) udata_p;
+    as_record*              record_p = NULL;
+    as_integer*             integer_p = NULL;
+    const as_val*           group_p = NULL;
+    int64_t                 value = 0;
+
+    if (!val_p || !(record_p = as_record_fromval(val_p))) {
+        return true;
+    }
+
+    if (reduce_p->type == REDUCE_COUNT) {
+        pthread_mutex_lock(&reduce_p->lock);
+        reduce_p->count++;
+        pthread_mutex_unlock(&reduce_p->lock);
+        return true;
+    }
+
+    if (!(integer_p = as_integer_fromval((as_val *) as_record_get(record_p,
+                        reduce_p->bin_p)))) {
+        return true;
+    }
+    value = as_integer_get(integer_p);
+
+    if (reduce_p->type == REDUCE_GROUP_BY_SUM &&
+            !(group_p = (const as_val *) as_record_get(record_p, reduce_p->group_by_p))) {
+        return true;
+    }
+
+    pthread_mutex_lock(&reduce_p->lock);
+    reduce_p->count++;
+    switch (reduce_p->type) {
+        case REDUCE_SUM:
+            aerospike_query_reduce_add(reduce_p, &reduce_p->value, value);
+            break;
+        case REDUCE_MIN:
+            if (!reduce_p->has_value || value < reduce_p->value) {
+                reduce_p->value = value;
+            }
+            reduce_p->has_value = true;
+            break;
+        case REDUCE_MAX:
+            if (!reduce_p->has_value || value > reduce_p->value) {
+                reduce_p->value = value;
+            }
+            reduce_p->has_value = true;
+            break;
+        case REDUCE_TOP_K:
+            aerospike_query_reduce_top_k(reduce_p, value);
+            break;
+        case REDUCE_GROUP_BY_SUM:
+            aerospike_query_reduce_group(reduce_p, group_p, value);
+            break;
+    }
+    pthread_mutex_unlock(&reduce_p->lock);
+    return true;
+}
+
+/*
+ ******************************************************************************************************
+ Converts the final state of a native reducer into the PHP result. A sum which
+ overflowed, or a string group whose PHP array key is the one of an integer
+ group, such as "5" and 5, fail the reduction rather than return a wrong value.
+ *
+ * @param reduce_p                  The reducer state.
+ * @param result_p                  The zval to be populated with the result.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+static as_status
+aerospike_query_reduce_result(reduce_callback_udata* reduce_p, zval* result_p,
+        as_error* error_p)
+{
+    as_hashmap_iterator     it;
+    as_pair*                pair_p = NULL;
+    as_val*                 group_p = NULL;
+    char*                   group_str_p = NULL;
+    bool                    is_collision = false;
+    uint32_t                i;
+
+    if (reduce_p->is_overflow) {
+        ZVAL_NULL(result_p);
+        DEBUG_PHP_EXT_DEBUG("Reducer sum overflows a 64-bit integer");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                "Reducer sum overflows a 64-bit integer");
+        goto exit;
+    }
+
+    switch (reduce_p->type) {
+        case REDUCE_COUNT:
+            ZVAL_LONG(result_p, reduce_p->count);
+            break;
+        case REDUCE_SUM:
+            ZVAL_LONG(result_p, reduce_p->value);
+            break;
+        case REDUCE_MIN:
+        case REDUCE_MAX:
+            if (reduce_p->has_value) {
+                ZVAL_LONG(result_p, reduce_p->value);
+            } else {
+                ZVAL_NULL(result_p);
+            }
+            break;
+        case REDUCE_TOP_K:
+            array_init(result_p);
+            for (i = 0; i < reduce_p->top_count; i++) {
+                add_next_index_long(result_p, reduce_p->top_p[i]);
+            }
+            break;
+        case REDUCE_GROUP_BY_SUM:
+            array_init(result_p);
+            as_hashmap_iterator_init(&it, reduce_p->groups_p);
+            while (!is_collision && as_hashmap_iterator_has_next(&it)) {
+                pair_p = as_pair_fromval(as_hashmap_iterator_next(&it));
+                group_p = as_pair_1(pair_p);
+                if (as_val_type(group_p) == AS_STRING) {
+                    group_str_p = as_string_get((as_string *) group_p);
+                    if (!(is_collision = zend_symtable_exists(Z_ARRVAL_P(result_p),
+                                    group_str_p, strlen(group_str_p) + 1))) {
+                        add_assoc_long(result_p, group_str_p,
+                                as_integer_get((as_integer *) as_pair_2(pair_p)));
+                    }
+                } else {
+                    if (!(is_collision = zend_hash_index_exists(Z_ARRVAL_P(result_p),
+                                    as_integer_get((as_integer *) group_p)))) {
+                        add_index_long(result_p, as_integer_get((as_integer *) group_p),
+                                as_integer_get((as_integer *) as_pair_2(pair_p)));
+                    }
+                }
+            }
+            as_hashmap_iterator_destroy(&it);
+            if (is_collision) {
+                zval_dtor(result_p);
+                ZVAL_NULL(result_p);
+                DEBUG_PHP_EXT_DEBUG("Reducer groups collide as PHP array keys");
+                PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                        "Reducer groups collide as PHP array keys");
+            }
+            break;
+    }
+exit:
+    return error_p->code;
+}
+
+/*
+ ******************************************************************************************************
+ Executes a query in the Aerospike DB and reduces the matching records with one
+ of the native reducers, so that no UDF has to be registered and no Lua runs
+ on either the server or the client.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param namespace_p               The namespace to query.
+ * @param set_p                     The set to query.
+ * @param predicate_ht_p            The HashTable for Query Predicate array.
+ * @param reducer_ht_p              The HashTable describing the reducer with
+ *                                  the keys 'type', 'bin', 'k' and 'group_by'.
+ * @param result_p                  The zval to be populated with the result.
+ * @param options_p                 The optional policy.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+extern as_status
+aerospike_query_reduce(aerospike* as_object_p, as_error* error_p,
+        char* namespace_p, char* set_p, HashTable* predicate_ht_p,
+        HashTable* reducer_ht_p, zval* result_p, zval* options_p TSRMLS_DC)
+{
+    as_query                query;
+    bool                    is_init_query = false;
+    bool                    is_init_lock = false;
+    as_policy_query         query_policy;
+    reduce_callback_udata   reduce;
+    zval**                  type_pp = NULL;
+    zval**                  bin_pp = NULL;
+    zval**                  k_pp = NULL;
+    zval**                  group_by_pp = NULL;
+    uint64_t                started_at = 0;
+
+    memset(&reduce, 0, sizeof(reduce));
+
+    if ((!as_object_p) || (!error_p) || (!namespace_p) || (!set_p) ||
+            (!predicate_ht_p) || (!reducer_ht_p) || (!result_p)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to initiate query reduction");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR, "Unable to initiate query reduction");
+        goto exit;
+    }
+
+    if (AEROSPIKE_OK != aerospike_helper_reject_max_records(options_p, error_p)) {
+        goto exit;
+    }
+
+    if ((FAILURE == zend_hash_find(reducer_ht_p, REDUCER_TYPE,
+                    sizeof(REDUCER_TYPE), (void **) &type_pp)) ||
+            (Z_TYPE_PP(type_pp) != IS_LONG) ||
+            (Z_LVAL_PP(type_pp) < REDUCE_COUNT) ||
+            (Z_LVAL_PP(type_pp) > REDUCE_GROUP_BY_SUM)) {
+        DEBUG_PHP_EXT_DEBUG("Reducer 'type' must be one of the Aerospike::REDUCE_* constants");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                "Reducer 'type' must be one of the Aerospike::REDUCE_* constants");
+        goto exit;
+    }
+    reduce.type = Z_LVAL_PP(type_pp);
+
+    if (reduce.type != REDUCE_COUNT) {
+        if ((FAILURE == zend_hash_find(reducer_ht_p, BIN, sizeof(BIN),
+                        (void **) &bin_pp)) || (Z_TYPE_PP(bin_pp) != IS_STRING) ||
+                (Z_STRLEN_PP(bin_pp) == 0)) {
+            DEBUG_PHP_EXT_DEBUG("Reducer requires a non-empty 'bin'");
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                    "Reducer requires a non-empty 'bin'");
+            goto exit;
+        }
+        reduce.bin_p = Z_STRVAL_PP(bin_pp);
+    }
+
+    if (reduce.type == REDUCE_TOP_K) {
+        if ((FAILURE == zend_hash_find(reducer_ht_p, REDUCER_K,
+                        sizeof(REDUCER_K), (void **) &k_pp)) ||
+                (Z_TYPE_PP(k_pp) != IS_LONG) || (Z_LVAL_PP(k_pp) <= 0) ||
+                (Z_LVAL_PP(k_pp) > UINT16_MAX)) {
+            DEBUG_PHP_EXT_DEBUG("Reducer REDUCE_TOP_K requires a positive integer 'k'");
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                    "Reducer REDUCE_TOP_K requires a positive integer 'k'");
+            goto exit;
+        }
+        reduce.k = (uint32_t) Z_LVAL_PP(k_pp);
+        if (!(reduce.top_p = (int64_t *) malloc(reduce.k * sizeof(int64_t)))) {
+            DEBUG_PHP_EXT_DEBUG("Unable to allocate the top-k values");
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                    "Unable to allocate the top-k values");
+            goto exit;
+        }
+    }
+
+    if (reduce.type == REDUCE_GROUP_BY_SUM) {
+        if ((FAILURE == zend_hash_find(reducer_ht_p, REDUCER_GROUP_BY,
+                        sizeof(REDUCER_GROUP_BY), (void **) &group_by_pp)) ||
+                (Z_TYPE_PP(group_by_pp) != IS_STRING) ||
+                (Z_STRLEN_PP(group_by_pp) == 0)) {
+            DEBUG_PHP_EXT_DEBUG("Reducer REDUCE_GROUP_BY_SUM requires a non-empty 'group_by'");
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                    "Reducer REDUCE_GROUP_BY_SUM requires a non-empty 'group_by'");
+            goto exit;
+        }
+        reduce.group_by_p = Z_STRVAL_PP(group_by_pp);
+        reduce.groups_p = as_hashmap_new(32);
+    }
+
+    set_policy(NULL, NULL, NULL, NULL, NULL, NULL, &query_policy, NULL,
+            options_p, error_p TSRMLS_CC);
+    if (AEROSPIKE_OK != (error_p->code)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+        goto exit;
+    }
+
+    as_query_init(&query, namespace_p, set_p);
+    is_init_query = true;
+    as_query_where_inita(&query, 1);
+
+    if (AEROSPIKE_OK != (aerospike_query_define(&query, error_p, namespace_p,
+                    set_p, predicate_ht_p, NULL, NULL, NULL TSRMLS_CC))) {
+        DEBUG_PHP_EXT_DEBUG("Unable to define query");
+        goto exit;
+    }
+
+    /*
+     * Only the bins the reducer reads are streamed back. A count reads no
+     * bin, so it selects one that no record holds.
+     */
+    if (reduce.bin_p) {
+        as_query_select_inita(&query, reduce.group_by_p ? 2 : 1);
+        as_query_select(&query, reduce.bin_p);
+        if (reduce.group_by_p) {
+            as_query_select(&query, reduce.group_by_p);
+        }
+    } else {
+        as_query_select_inita(&query, 1);
+        as_query_select(&query, REDUCE_COUNT_NO_BIN);
+    }
+
+    pthread_mutex_init(&reduce.lock, NULL);
+    is_init_lock = true;
+
+    started_at = aerospike_latency_now();
+    aerospike_query_foreach(as_object_p, error_p, &query_policy, &query,
+            aerospike_query_reduce_callback, &reduce);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_QUERY, NULL, started_at);
+    if (AEROSPIKE_OK != error_p->code) {
+        DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+        goto exit;
+    }
+
+    zval_dtor(result_p);
+    aerospike_query_reduce_result(&reduce, result_p, error_p);
+
+exit:
+    if (is_init_lock) {
+        pthread_mutex_destroy(&reduce.lock);
+    }
+    if (is_init_query) {
+        as_query_destroy(&query);
+    }
+    if (reduce.top_p) {
+        free(reduce.top_p);
+    }
+    if (reduce.groups_p) {
+        as_hashmap_destroy(reduce.groups_p);
+    }
+    return error_p->code;
+}
+
+/*
+ ******************************************************************************************************
+ * State shared by the per-node threads of a query applying a record UDF.
+ * The error, counters and digests are only touched while holding the lock.
+ * The digests of the records the UDF was applied to are kept so that the
+ * record cache is invalidated by the request thread once the query returns,
+ * the cache not being usable from the threads of the C client.
+ ******************************************************************************************************
+ */
+typedef struct query_apply_udata_t {
+    pthread_mutex_t     lock;
+    aerospike*          as_object_p;
+    as_policy_apply     apply_policy;
+    const char*         module_p;
+    const char*         function_p;
+    as_list*            args_list_p;
+    as_error            error;
+    uint64_t            applied;
+    as_digest_value*    digests_p;
+    uint32_t            n_digests;
+    uint32_t            digests_size;
+} query_apply_udata;
+
+/*
+ ******************************************************************************************************
+ Callback for a query applying a record UDF. Applies the UDF to the key of
+ each record streamed back from the cluster, and stops the query on the first
+ failure, which is kept as the error of the whole query. The digest of every
+ record the UDF was sent to is kept, a failed apply possibly having written.
+ *
+ * @param val_p                     The record as an as_val, or NULL once the
+ *                                  query is complete.
+ * @param udata_p                   The query_apply_udata of the query.
+ *
+ * @return true to continue the query; else false.
+ ******************************************************************************************************
+ */
+static bool
+aerospike_query_apply_callback(const as_val* val_p, void* udata_p)
+{
+    query_apply_udata*      apply_p = (query_apply_udata *) udata_p;
+    as_record*              record_p = NULL;
+    as_key                  key;
+    as_error                error;
+    as_val*                 result_p = NULL;
+    as_digest_value*        digests_p = NULL;
+    uint32_t                digests_size = 0;
+    bool                    do_continue = true;
+    uint64_t                started_at = 0;
+
+    if (!val_p || !(record_p = as_record_fromval(val_p))) {
+        return true;
+    }
+
+    as_key_init_digest(&key, record_p->key.ns, record_p->key.set,
+            record_p->key.digest.value);
+    as_error_init(&error);
+    started_at = aerospike_latency_now();
+    aerospike_key_apply(apply_p->as_object_p, &error, &apply_p->apply_policy,
+            &key, apply_p->module_p, apply_p->function_p, apply_p->args_list_p,
+            &result_p);
+    aerospike_latency_record(apply_p->as_object_p, AEROSPIKE_LATENCY_UDF, &key, started_at);
+    as_val_destroy(result_p);
+    as_key_destroy(&key);
+
+    pthread_mutex_lock(&apply_p->lock);
+    if (apply_p->n_digests == apply_p->digests_size) {
+        digests_size = apply_p->digests_size ? apply_p->digests_size * 2 : 64;
+        if ((digests_p = (as_digest_value *) realloc(apply_p->digests_p,
+                        sizeof(as_digest_value) * digests_size))) {
+            apply_p->digests_p = digests_p;
+            apply_p->digests_size = digests_size;
+        } else if (AEROSPIKE_OK == apply_p->error.code) {
+            PHP_EXT_SET_AS_ERR(&apply_p->error, AEROSPIKE_ERR_CLIENT,
+                    "Unable to keep the digests of the applied records");
+        }
+    }
+    if (apply_p->n_digests < apply_p->digests_size) {
+        memcpy(apply_p->digests_p[apply_p->n_digests++], record_p->key.digest.value,
+                AS_DIGEST_VALUE_SIZE);
+    }
+    if (AEROSPIKE_OK == apply_p->error.code) {
+        if (AEROSPIKE_OK == error.code) {
+            apply_p->applied++;
+        } else {
+            as_error_copy(&apply_p->error, &error);
+            do_continue = false;
+        }
+    } else {
+        do_continue = false;
+    }
+    pthread_mutex_unlock(&apply_p->lock);
+    return do_continue;
+}
+
+/*
+ ******************************************************************************************************
+ Executes a query in the Aerospike DB and applies a record UDF to each of the
+ matching records. This is a loop run by the client, not a job of the
+ cluster: the 3.0 C client has no background query, so only the indexed bin
+ of the records is streamed back and aerospike_key_apply() is called on each
+ of them by digest as they arrive, within the calling request. The records the
+ UDF was sent to are then removed from the record cache and the read memo.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param cache_p                   The record cache of the connection.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param namespace_p               The namespace to query.
+ * @param set_p                     The set to query.
+ * @param predicate_ht_p            The HashTable for Query Predicate array.
+ * @param module_p                  The name of UDF module containing the function
+ *                                  to execute.
+ * @param function_p                The name of the function to be applied to
+ *                                  the records.
+ * @param args_pp                   An array of arguments for the UDF.
+ * @param applied_p                 The zval to be set to the number of records
+ *                                  the UDF was applied to.
+ * @param options_p                 The optional policy.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+extern as_status
+aerospike_query_apply_each(aerospike* as_object_p,
+        aerospike_record_cache* cache_p, as_error* error_p, char* namespace_p, char* set_p, HashTable* predicate_ht_p,
+        char* module_p, char* function_p, zval** args_pp, zval* applied_p,
+        zval* options_p TSRMLS_DC)
+{
+    as_query                query;
+    bool                    is_init_query = false;
+    bool                    is_init_lock = false;
+    as_policy_query         query_policy;
+    as_arraylist            args_list;
+    as_arraylist*           args_list_p = NULL;
+    as_static_pool          udf_pool = {0};
+    uint32_t                serializer_policy = -1;
+    query_apply_udata       apply = {0};
+    as_key                  key;
+    uint32_t                i = 0;
+    zval**                  bin_pp = NULL;
+    zval**                  timeout_pp = NULL;
+    uint64_t                started_at = 0;
+
+    if ((!as_object_p) || (!cache_p) || (!error_p) || (!namespace_p) || (!set_p) ||
+            (!predicate_ht_p) || (!module_p) || (!function_p)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to initiate query apply");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR, "Unable to initiate query apply");
+        goto exit;
+    }
+
+    if (AEROSPIKE_OK != aerospike_helper_reject_max_records(options_p, error_p)) {
+        goto exit;
+    }
+
+    set_policy(NULL, NULL, NULL, NULL, NULL, NULL, &query_policy, &serializer_policy,
+            options_p, error_p TSRMLS_CC);
+    if (AEROSPIKE_OK != (error_p->code)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+        goto exit;
+    }
+
+    /*
+     * The UDF is applied with the default apply policy, except for the
+     * write timeout.
+     */
+    set_policy_udf_apply(&apply.apply_policy, NULL, error_p TSRMLS_CC);
+    if (AEROSPIKE_OK != (error_p->code)) {
+        DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+        goto exit;
+    }
+    if (options_p && (SUCCESS == zend_hash_index_find(Z_ARRVAL_P(options_p),
+                    OPT_WRITE_TIMEOUT, (void **) &timeout_pp)) &&
+            (Z_TYPE_PP(timeout_pp) == IS_LONG)) {
+        apply.apply_policy.timeout = (uint32_t) Z_LVAL_PP(timeout_pp);
+    }
+
+    if ((*args_pp)) {
+        as_arraylist_inita(&args_list,
+                zend_hash_num_elements(Z_ARRVAL_PP(args_pp)));
+        args_list_p = &args_list;
+        AS_LIST_PUT(NULL, args_pp, args_list_p, &udf_pool,
+                serializer_policy, error_p TSRMLS_CC);
+        if (AEROSPIKE_OK != (error_p->code)) {
+            DEBUG_PHP_EXT_DEBUG("Unable to create args list for UDF");
+            goto exit;
+        }
+    }
+
+    as_query_init(&query, namespace_p, set_p);
+    is_init_query = true;
+    as_query_where_inita(&query, 1);
+
+    if (AEROSPIKE_OK != (aerospike_query_define(&query, error_p, namespace_p,
+                    set_p, predicate_ht_p, NULL, NULL, NULL TSRMLS_CC))) {
+        DEBUG_PHP_EXT_DEBUG("Unable to define query");
+        goto exit;
+    }
+
+    if (SUCCESS == zend_hash_find(predicate_ht_p, BIN, sizeof(BIN),
+                (void **) &bin_pp)) {
+        as_query_select_inita(&query, 1);
+        as_query_select(&query, Z_STRVAL_PP(bin_pp));
+    }
+
+    apply.as_object_p = as_object_p;
+    apply.module_p = module_p;
+    apply.function_p = function_p;
+    apply.args_list_p = (as_list *) args_list_p;
+    apply.applied = 0;
+    as_error_init(&apply.error);
+    pthread_mutex_init(&apply.lock, NULL);
+    is_init_lock = true;
+
+    started_at = aerospike_latency_now();
+    aerospike_query_foreach(as_object_p, error_p, &query_policy, &query,
+            aerospike_query_apply_callback, &apply);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_QUERY, NULL, started_at);
+    for (i = 0; i < apply.n_digests; i++) {
+        as_key_init_digest(&key, namespace_p, set_p, apply.digests_p[i]);
+        aerospike_record_cache_remove(cache_p, &key TSRMLS_CC);
+        as_key_destroy(&key);
+    }
+    if (AEROSPIKE_OK != apply.error.code) {
+        as_error_copy(error_p, &apply.error);
+    }
+    if (applied_p) {
+        zval_dtor(applied_p);
+        ZVAL_LONG(applied_p, (long) apply.applied);
+    }
+
+exit:
+    if (is_init_lock) {
+        pthread_mutex_destroy(&apply.lock);
+    }
+    if (is_init_query) {
+        as_query_destroy(&query);
+    }
+    if (args_list_p) {
+        as_arraylist_destroy(args_list_p);
+    }
+    if (apply.digests_p) {
+        free(apply.digests_p);
+    }
     aerospike_helper_free_static_pool(&udf_pool);
     return error_p->code;
 }
@@ -0,0 +1,1165 @@
+#include "php.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include "aerospike/aerospike.h"
+#include "aerospike/aerospike_key.h"
+#include "aerospike/as_error.h"
+#include "aerospike/as_hashmap.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_msgpack.h"
+#include "aerospike/as_serializer.h"
+#include "aerospike_common.h"
+#include "aerospike_policy.h"
+
+#define RECORD_CACHE_BUCKETS 1024
+
+static void
+aerospike_record_cache_put_local(aerospike_record_cache* cache_p, as_key* key_p,
+        const as_record* record_p, size_t max_memory);
+
+static void
+aerospike_read_memo_remove(aerospike_record_cache* cache_p, as_key* key_p TSRMLS_DC);
+
+/*
+ *******************************************************************************************************
+ * Initializes an empty record cache. Its buckets are allocated on the first
+ * insertion, so that a cache which is never enabled costs nothing.
+ *
+ * The cluster id identifies the seeds of the connection in the shared memory
+ * record cache, so that the connections to other clusters of the host never
+ * read its records. It does not depend on the order of the seeds.
+ *
+ * @param cache_p               The cache to be initialized.
+ * @param config_p              The as_config of the connection.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_record_cache_init(aerospike_record_cache* cache_p, as_config* config_p)
+{
+    const char*         addr_p = NULL;
+    uint32_t            hash = 0;
+    uint32_t            i = 0;
+
+    pthread_mutex_init(&cache_p->lock, NULL);
+    cache_p->buckets_p = NULL;
+    cache_p->lru_head_p = NULL;
+    cache_p->lru_tail_p = NULL;
+    cache_p->size = 0;
+    cache_p->cluster_id = 0;
+    for (i = 0; config_p && i < config_p->hosts_size; i++) {
+        hash = 2166136261U;
+        for (addr_p = config_p->hosts[i].addr; addr_p && *addr_p; addr_p++) {
+            hash = (hash ^ (uint8_t) tolower(*addr_p)) * 16777619U;
+        }
+        hash = (hash ^ config_p->hosts[i].port) * 16777619U;
+        cache_p->cluster_id += hash;
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Unlinks an entry from its bucket and from the LRU list, and releases it.
+ * The cache lock must be held by the caller.
+ *******************************************************************************************************
+ */
+static void
+aerospike_record_cache_evict(aerospike_record_cache* cache_p,
+        aerospike_record_cache_entry* entry_p)
+{
+    aerospike_record_cache_entry**  link_pp = &cache_p->buckets_p[entry_p->bucket];
+
+    while (*link_pp && *link_pp != entry_p) {
+        link_pp = &(*link_pp)->hash_next_p;
+    }
+    if (*link_pp) {
+        *link_pp = entry_p->hash_next_p;
+    }
+
+    if (entry_p->lru_prev_p) {
+        entry_p->lru_prev_p->lru_next_p = entry_p->lru_next_p;
+    } else {
+        cache_p->lru_head_p = entry_p->lru_next_p;
+    }
+    if (entry_p->lru_next_p) {
+        entry_p->lru_next_p->lru_prev_p = entry_p->lru_prev_p;
+    } else {
+        cache_p->lru_tail_p = entry_p->lru_prev_p;
+    }
+
+    cache_p->size -= entry_p->size;
+    as_record_destroy(entry_p->record_p);
+    free(entry_p);
+}
+
+/*
+ *******************************************************************************************************
+ * Releases all the records held by a cache.
+ *
+ * @param cache_p               The cache to be destroyed.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_record_cache_destroy(aerospike_record_cache* cache_p)
+{
+    while (cache_p->lru_head_p) {
+        aerospike_record_cache_evict(cache_p, cache_p->lru_head_p);
+    }
+    if (cache_p->buckets_p) {
+        free(cache_p->buckets_p);
+        cache_p->buckets_p = NULL;
+    }
+    pthread_mutex_destroy(&cache_p->lock);
+}
+
+/*
+ *******************************************************************************************************
+ * Shared memory record cache.
+ *
+ * A SysV segment of fixed size slots, shared by all the processes of the host
+ * which enable it, so that PHP-FPM workers share the records they read. A
+ * record is held by the slot its digest maps to, as a msgpack map of its bins.
+ *
+ * The segment is created with the key aerospike.shm.record_cache.key, readable
+ * and writable only by the user of the process. A slot also holds the cluster
+ * id of the connection which cached its record, and is only read by the
+ * connections with the same seeds.
+ *
+ * Each slot is guarded by a sequence number, odd while the slot is written.
+ * Readers do not lock: they copy the slot and keep the copy only if the
+ * sequence number was even and did not change meanwhile. A writer claims a
+ * slot by compare-and-swap, and skips the slot if it is being written. A slot
+ * left odd for SHM_RECORD_CACHE_LOCK_TIMEOUT seconds belongs to a writer
+ * which died while writing it, and is taken over by the next writer.
+ *
+ * Dropping a record waits for the slot instead of skipping it, and moves its
+ * sequence number on. A read takes the sequence number of the slot as a token
+ * before going to the server, and caches the record it read only if the slot
+ * still has the same sequence number. A read of the old record which was in
+ * flight during a write can then not cache it again.
+ *******************************************************************************************************
+ */
+#define SHM_RECORD_CACHE_MAGIC 0x41535244
+#define SHM_RECORD_CACHE_MIN_SLOT_SIZE 128
+#define SHM_RECORD_CACHE_LOCK_TIMEOUT 2
+
+typedef struct aerospike_shm_record_cache_t {
+    uint32_t            magic;                      /* set once the segment is initialized */
+    uint32_t            slot_size;
+    uint32_t            n_slots;
+    uint32_t            reserved;
+} aerospike_shm_record_cache;
+
+typedef struct aerospike_shm_record_slot_t {
+    volatile uint32_t   seq;
+    volatile uint32_t   locked_at;                  /* when a writer last claimed the slot */
+    uint32_t            cluster_id;                 /* of the connection which cached the record */
+    uint32_t            size;                       /* size of the serialized bins */
+    uint32_t            cached_at;
+    uint32_t            expires_at;                 /* capped by aerospike.shm.record_cache.max_ttl, 0 if empty */
+    uint32_t            ttl;                        /* the record's ttl when cached */
+    uint16_t            gen;
+    uint8_t             digest[AS_DIGEST_VALUE_SIZE];
+    char                ns[AS_NAMESPACE_MAX_SIZE];
+    uint8_t             data[];
+} aerospike_shm_record_slot;
+
+static aerospike_shm_record_cache*  shm_record_cache_p = NULL;
+static bool                         is_shm_record_cache_attached = false;
+static pthread_mutex_t              shm_record_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ *******************************************************************************************************
+ * Checks whether the shared memory record cache is configured, by
+ * aerospike.shm.use and aerospike.shm.record_cache.size.
+ *******************************************************************************************************
+ */
+static bool
+aerospike_shm_record_cache_is_configured(TSRMLS_D)
+{
+    return ((SHM_USE_PHP_INI) && (SHM_RECORD_CACHE_SIZE_PHP_INI) > 0);
+}
+
+/*
+ *******************************************************************************************************
+ * Attaches the shared memory record cache on its first use by the process,
+ * creating and initializing the segment if no other process did. Forked
+ * workers inherit the attachment of their parent.
+ *
+ * @return the segment, or NULL if it is not configured or unusable.
+ *******************************************************************************************************
+ */
+static aerospike_shm_record_cache*
+aerospike_shm_record_cache_get_segment(TSRMLS_D)
+{
+    aerospike_shm_record_cache*     segment_p = NULL;
+    size_t                          size = 0;
+    uint32_t                        slot_size = 0;
+    int                             shm_id = -1;
+    bool                            is_created = false;
+
+    if (!aerospike_shm_record_cache_is_configured(TSRMLS_C)) {
+        return NULL;
+    }
+
+    if (!is_shm_record_cache_attached) {
+        pthread_mutex_lock(&shm_record_cache_lock);
+        if (!is_shm_record_cache_attached) {
+            size = (size_t) (SHM_RECORD_CACHE_SIZE_PHP_INI);
+            slot_size = (uint32_t) (SHM_RECORD_CACHE_SLOT_SIZE_PHP_INI);
+            if (slot_size < SHM_RECORD_CACHE_MIN_SLOT_SIZE) {
+                slot_size = SHM_RECORD_CACHE_MIN_SLOT_SIZE;
+            }
+            slot_size = (slot_size + 7) & ~7;
+
+            if (size >= sizeof(aerospike_shm_record_cache) + slot_size) {
+                if (-1 != (shm_id = shmget((key_t) (SHM_RECORD_CACHE_KEY_PHP_INI), size,
+                                IPC_CREAT | IPC_EXCL | 0600))) {
+                    is_created = true;
+                } else if (errno == EEXIST) {
+                    shm_id = shmget((key_t) (SHM_RECORD_CACHE_KEY_PHP_INI), 0, 0600);
+                }
+            }
+            if (shm_id != -1 &&
+                    (void *) -1 != (segment_p = (aerospike_shm_record_cache *) shmat(shm_id, NULL, 0))) {
+                if (is_created) {
+                    segment_p->slot_size = slot_size;
+                    segment_p->n_slots = (uint32_t) ((size - sizeof(aerospike_shm_record_cache)) / slot_size);
+                    __sync_synchronize();
+                    segment_p->magic = SHM_RECORD_CACHE_MAGIC;
+                }
+                shm_record_cache_p = segment_p;
+            } else {
+                DEBUG_PHP_EXT_WARNING("Unable to attach the shared memory record cache");
+            }
+            is_shm_record_cache_attached = true;
+        }
+        pthread_mutex_unlock(&shm_record_cache_lock);
+    }
+
+    if (!shm_record_cache_p || shm_record_cache_p->magic != SHM_RECORD_CACHE_MAGIC) {
+        return NULL;
+    }
+    return shm_record_cache_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Returns the slot a key maps to.
+ *******************************************************************************************************
+ */
+static aerospike_shm_record_slot*
+aerospike_shm_record_cache_slot(aerospike_shm_record_cache* segment_p, as_key* key_p)
+{
+    as_digest*                  digest_p = as_key_digest(key_p);
+    uint32_t                    index = (*(uint32_t *) digest_p->value) % segment_p->n_slots;
+
+    return (aerospike_shm_record_slot *) ((uint8_t *) segment_p +
+            sizeof(aerospike_shm_record_cache) + (size_t) index * segment_p->slot_size);
+}
+
+/*
+ *******************************************************************************************************
+ * Claims a slot for writing, making its sequence number odd. A slot claimed
+ * for SHM_RECORD_CACHE_LOCK_TIMEOUT seconds is taken over, moving its
+ * sequence number to the next odd one.
+ *
+ * @param slot_p                The slot to be written.
+ * @param now                   The current time.
+ *
+ * @return the odd sequence number of the claim, to be passed to
+ * aerospike_shm_record_cache_unlock(), or 0 if the slot is being written.
+ *******************************************************************************************************
+ */
+static uint32_t
+aerospike_shm_record_cache_lock(aerospike_shm_record_slot* slot_p, uint32_t now)
+{
+    uint32_t                    seq = slot_p->seq;
+    uint32_t                    locked_seq = seq + 1;
+
+    if (seq & 1) {
+        if ((int32_t) (now - slot_p->locked_at) < SHM_RECORD_CACHE_LOCK_TIMEOUT) {
+            return 0;
+        }
+        locked_seq = seq + 2;
+    }
+    if (!__sync_bool_compare_and_swap(&slot_p->seq, seq, locked_seq)) {
+        return 0;
+    }
+    slot_p->locked_at = now;
+    __sync_synchronize();
+    return locked_seq;
+}
+
+/*
+ *******************************************************************************************************
+ * Releases a slot claimed by aerospike_shm_record_cache_lock(), unless it was
+ * taken over meanwhile.
+ *******************************************************************************************************
+ */
+static void
+aerospike_shm_record_cache_unlock(aerospike_shm_record_slot* slot_p, uint32_t locked_seq)
+{
+    __sync_synchronize();
+    __sync_bool_compare_and_swap(&slot_p->seq, locked_seq, locked_seq + 1);
+}
+
+/*
+ *******************************************************************************************************
+ * Returns the token of the slot of a key, to be passed to
+ * aerospike_shm_record_cache_put() once the record is read from the server.
+ * The token is odd, and nothing is cached, if the slot is being written or
+ * the shared memory record cache is not configured.
+ *******************************************************************************************************
+ */
+static uint32_t
+aerospike_shm_record_cache_token(as_key* key_p TSRMLS_DC)
+{
+    aerospike_shm_record_cache*     segment_p = aerospike_shm_record_cache_get_segment(TSRMLS_C);
+    uint32_t                        seq = 1;
+
+    if (segment_p) {
+        seq = aerospike_shm_record_cache_slot(segment_p, key_p)->seq;
+        __sync_synchronize();
+    }
+    return seq;
+}
+
+/*
+ *******************************************************************************************************
+ * Callback of as_map_foreach, adding a bin of the deserialized map to the
+ * as_record passed as udata.
+ *******************************************************************************************************
+ */
+static bool
+aerospike_shm_record_cache_set_bin(const as_val* key_p, const as_val* value_p, void* udata)
+{
+    if (as_val_type(key_p) != AS_STRING) {
+        return false;
+    }
+    as_val_reserve((as_val *) value_p);
+    return as_record_set((as_record *) udata, as_string_get((as_string *) key_p),
+            (as_bin_value *) value_p);
+}
+
+/*
+ *******************************************************************************************************
+ * Reads the record of a key from the shared memory record cache.
+ *
+ * @param key_p                 The key of the record.
+ * @param cluster_id            The cluster id of the connection.
+ * @param ttl_p                 The remaining ttl of the record.
+ *
+ * @return a new record, to be destroyed by the caller, or NULL on a miss.
+ *******************************************************************************************************
+ */
+static as_record*
+aerospike_shm_record_cache_get(as_key* key_p, uint32_t cluster_id,
+        uint32_t* ttl_p TSRMLS_DC)
+{
+    aerospike_shm_record_cache*     segment_p = aerospike_shm_record_cache_get_segment(TSRMLS_C);
+    aerospike_shm_record_slot*      slot_p = NULL;
+    aerospike_shm_record_slot       slot;
+    as_serializer                   serializer;
+    as_buffer                       buffer;
+    as_val*                         bins_p = NULL;
+    as_record*                      record_p = NULL;
+    uint8_t*                        data_p = NULL;
+    uint32_t                        seq = 0;
+    uint32_t                        now = (uint32_t) time(NULL);
+
+    if (!segment_p) {
+        return NULL;
+    }
+
+    slot_p = aerospike_shm_record_cache_slot(segment_p, key_p);
+    seq = slot_p->seq;
+    __sync_synchronize();
+    if (seq & 1) {
+        return NULL;
+    }
+
+    memcpy(&slot, slot_p, sizeof(aerospike_shm_record_slot));
+    if (slot.expires_at <= now || slot.size == 0 || slot.cluster_id != cluster_id ||
+            slot.size > segment_p->slot_size - sizeof(aerospike_shm_record_slot) ||
+            memcmp(slot.digest, as_key_digest(key_p)->value, AS_DIGEST_VALUE_SIZE) ||
+            strncmp(slot.ns, key_p->ns, AS_NAMESPACE_MAX_SIZE)) {
+        return NULL;
+    }
+    if (!(data_p = (uint8_t *) malloc(slot.size))) {
+        return NULL;
+    }
+    memcpy(data_p, slot_p->data, slot.size);
+    __sync_synchronize();
+    if (slot_p->seq != seq) {
+        goto exit;
+    }
+
+    as_buffer_init(&buffer);
+    buffer.data = data_p;
+    buffer.size = slot.size;
+    buffer.capacity = slot.size;
+    as_msgpack_init(&serializer);
+    as_serializer_deserialize(&serializer, &buffer, &bins_p);
+    as_serializer_destroy(&serializer);
+    if (!bins_p || as_val_type(bins_p) != AS_MAP) {
+        goto exit;
+    }
+
+    if ((record_p = as_record_new(as_map_size((as_map *) bins_p)))) {
+        if (!as_map_foreach((as_map *) bins_p, aerospike_shm_record_cache_set_bin, record_p)) {
+            as_record_destroy(record_p);
+            record_p = NULL;
+            goto exit;
+        }
+        record_p->gen = slot.gen;
+        record_p->ttl = (slot.ttl == 0 || slot.ttl == AS_RECORD_NO_EXPIRE_TTL) ?
+            slot.ttl : slot.ttl - (now - slot.cached_at);
+        *ttl_p = record_p->ttl;
+    }
+
+exit:
+    if (bins_p) {
+        as_val_destroy(bins_p);
+    }
+    free(data_p);
+    return record_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Writes the record of a key to the shared memory record cache, for at most
+ * aerospike.shm.record_cache.max_ttl seconds. Records which do not fit in a
+ * slot are not cached, nor are those of a slot written since the token was
+ * taken. A slot left claimed by a writer which died is taken over and emptied.
+ *
+ * @param key_p                 The key of the record.
+ * @param record_p              The record read from the server.
+ * @param cluster_id            The cluster id of the connection.
+ * @param token                 The token of the slot taken before the read.
+ *
+ *******************************************************************************************************
+ */
+static void
+aerospike_shm_record_cache_put(as_key* key_p, const as_record* record_p,
+        uint32_t cluster_id, uint32_t token TSRMLS_DC)
+{
+    aerospike_shm_record_cache*     segment_p = aerospike_shm_record_cache_get_segment(TSRMLS_C);
+    aerospike_shm_record_slot*      slot_p = NULL;
+    as_hashmap                      bins;
+    as_serializer                   serializer;
+    as_buffer                       buffer;
+    char*                           name_p = NULL;
+    uint32_t                        seq = 0;
+    uint32_t                        now = (uint32_t) time(NULL);
+    uint32_t                        ttl = (uint32_t) (SHM_RECORD_CACHE_MAX_TTL_PHP_INI);
+    uint16_t                        i = 0;
+
+    if (!segment_p || ttl == 0) {
+        return;
+    }
+
+    slot_p = aerospike_shm_record_cache_slot(segment_p, key_p);
+    if (slot_p->seq != token || (token & 1)) {
+        if ((slot_p->seq & 1) && (seq = aerospike_shm_record_cache_lock(slot_p, now))) {
+            slot_p->expires_at = 0;
+            aerospike_shm_record_cache_unlock(slot_p, seq);
+        }
+        return;
+    }
+    if (record_p->ttl != 0 && record_p->ttl != AS_RECORD_NO_EXPIRE_TTL && record_p->ttl < ttl) {
+        ttl = record_p->ttl;
+    }
+
+    as_hashmap_init(&bins, record_p->bins.size ? record_p->bins.size : 1);
+    for (i = 0; i < record_p->bins.size; i++) {
+        if ((name_p = strdup(record_p->bins.entries[i].name))) {
+            as_hashmap_set(&bins, (as_val *) as_string_new(name_p, true),
+                    as_val_reserve((as_val *) record_p->bins.entries[i].valuep));
+        }
+    }
+    as_buffer_init(&buffer);
+    as_msgpack_init(&serializer);
+    if (0 != as_serializer_serialize(&serializer, (as_val *) &bins, &buffer) ||
+            buffer.size > segment_p->slot_size - sizeof(aerospike_shm_record_slot)) {
+        goto exit;
+    }
+
+    if (!__sync_bool_compare_and_swap(&slot_p->seq, token, token + 1)) {
+        goto exit;
+    }
+    seq = token + 1;
+    slot_p->locked_at = now;
+    __sync_synchronize();
+    slot_p->cluster_id = cluster_id;
+    slot_p->size = buffer.size;
+    slot_p->cached_at = now;
+    slot_p->expires_at = now + ttl;
+    slot_p->ttl = record_p->ttl;
+    slot_p->gen = record_p->gen;
+    memcpy(slot_p->digest, as_key_digest(key_p)->value, AS_DIGEST_VALUE_SIZE);
+    strncpy(slot_p->ns, key_p->ns, AS_NAMESPACE_MAX_SIZE - 1);
+    slot_p->ns[AS_NAMESPACE_MAX_SIZE - 1] = '\0';
+    memcpy(slot_p->data, buffer.data, buffer.size);
+    aerospike_shm_record_cache_unlock(slot_p, seq);
+
+exit:
+    as_serializer_destroy(&serializer);
+    as_buffer_destroy(&buffer);
+    as_hashmap_destroy(&bins);
+}
+
+/*
+ *******************************************************************************************************
+ * Drops the record of a key from the shared memory record cache, whatever
+ * connection cached it. The slot of the key is waited for if it is being
+ * written, and its sequence number moved on, so that the reads in flight do
+ * not cache the record again.
+ *
+ * @param key_p                 The key of the record.
+ *
+ *******************************************************************************************************
+ */
+static void
+aerospike_shm_record_cache_remove(as_key* key_p TSRMLS_DC)
+{
+    aerospike_shm_record_cache*     segment_p = aerospike_shm_record_cache_get_segment(TSRMLS_C);
+    aerospike_shm_record_slot*      slot_p = NULL;
+    uint32_t                        seq = 0;
+    uint32_t                        started_at = (uint32_t) time(NULL);
+    uint32_t                        now = started_at;
+
+    if (!segment_p) {
+        return;
+    }
+
+    slot_p = aerospike_shm_record_cache_slot(segment_p, key_p);
+    while (!(seq = aerospike_shm_record_cache_lock(slot_p, now))) {
+        if (now - started_at > SHM_RECORD_CACHE_LOCK_TIMEOUT) {
+            DEBUG_PHP_EXT_WARNING("Unable to drop a record from the shared memory record cache");
+            return;
+        }
+        sched_yield();
+        now = (uint32_t) time(NULL);
+    }
+    if (!memcmp(slot_p->digest, as_key_digest(key_p)->value, AS_DIGEST_VALUE_SIZE) &&
+            !strncmp(slot_p->ns, key_p->ns, AS_NAMESPACE_MAX_SIZE)) {
+        slot_p->expires_at = 0;
+    }
+    aerospike_shm_record_cache_unlock(slot_p, seq);
+}
+
+/*
+ *******************************************************************************************************
+ * Checks whether a read should go through the record cache: the cache must be
+ * enabled by aerospike.read_cache.max_memory or aerospike.shm.record_cache.size
+ * and the read must opt in with OPT_READ_CACHE.
+ *
+ * @param options_p             The user's optional policy options, an array or
+ *                              an Aerospike\Policy.
+ *
+ * @return true if the cache is to be used.
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_record_cache_is_enabled(zval* options_p TSRMLS_DC)
+{
+    zval**                      read_cache_pp = NULL;
+
+    if (((READ_CACHE_MAX_MEMORY_PHP_INI) <= 0 &&
+                !aerospike_shm_record_cache_is_configured(TSRMLS_C)) || !options_p ||
+            !(options_p = aerospike_policy_get_options(options_p TSRMLS_CC)) ||
+            Z_TYPE_P(options_p) != IS_ARRAY) {
+        return false;
+    }
+
+    if (zend_hash_index_find(Z_ARRVAL_P(options_p), OPT_READ_CACHE,
+                (void **) &read_cache_pp) == FAILURE) {
+        return false;
+    }
+
+    return (Z_TYPE_PP(read_cache_pp) == IS_BOOL && Z_BVAL_PP(read_cache_pp));
+}
+
+/*
+ *******************************************************************************************************
+ * Looks up the entry of a key. The cache lock must be held by the caller.
+ *******************************************************************************************************
+ */
+static aerospike_record_cache_entry*
+aerospike_record_cache_find(aerospike_record_cache* cache_p, as_key* key_p,
+        uint32_t* bucket_p)
+{
+    aerospike_record_cache_entry*   entry_p = NULL;
+    as_digest*                      digest_p = as_key_digest(key_p);
+
+    *bucket_p = (*(uint32_t *) digest_p->value) % RECORD_CACHE_BUCKETS;
+    if (!cache_p->buckets_p) {
+        return NULL;
+    }
+
+    for (entry_p = cache_p->buckets_p[*bucket_p]; entry_p; entry_p = entry_p->hash_next_p) {
+        if (!memcmp(entry_p->digest, digest_p->value, AS_DIGEST_VALUE_SIZE) &&
+                !strcmp(entry_p->ns, key_p->ns)) {
+            break;
+        }
+    }
+    return entry_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Moves an entry to the head of the LRU list. The cache lock must be held by
+ * the caller.
+ *******************************************************************************************************
+ */
+static void
+aerospike_record_cache_touch(aerospike_record_cache* cache_p,
+        aerospike_record_cache_entry* entry_p)
+{
+    if (cache_p->lru_head_p == entry_p) {
+        return;
+    }
+
+    entry_p->lru_prev_p->lru_next_p = entry_p->lru_next_p;
+    if (entry_p->lru_next_p) {
+        entry_p->lru_next_p->lru_prev_p = entry_p->lru_prev_p;
+    } else {
+        cache_p->lru_tail_p = entry_p->lru_prev_p;
+    }
+
+    entry_p->lru_prev_p = NULL;
+    entry_p->lru_next_p = cache_p->lru_head_p;
+    cache_p->lru_head_p->lru_prev_p = entry_p;
+    cache_p->lru_head_p = entry_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Reserves the cached record of a key if it has not expired. An entry older
+ * than aerospike.read_cache.max_age seconds is revalidated with a header-only
+ * read when as_object_p is given, and kept only if the record's generation
+ * did not change. Otherwise a stale entry is a miss. A key missing from the
+ * cache is looked up in the shared memory record cache, and cached if found.
+ *
+ * The returned record is shared with the cache and must be released by the
+ * caller with as_record_destroy(). Its ttl is that of the original read, the
+ * remaining ttl is returned in ttl_p.
+ *
+ * @param cache_p               The cache to be looked up.
+ * @param as_object_p           The C client's aerospike object, or NULL to
+ *                              treat stale entries as misses.
+ * @param read_policy_p         The read policy of the revalidation.
+ * @param key_p                 The key of the record.
+ * @param ttl_p                 The remaining ttl of the record.
+ * @param token_p               The token to be passed to
+ *                              aerospike_record_cache_put() if the record is
+ *                              then read from the server.
+ *
+ * @return the cached record, or NULL on a miss.
+ *******************************************************************************************************
+ */
+extern as_record*
+aerospike_record_cache_get(aerospike_record_cache* cache_p,
+        aerospike* as_object_p, as_policy_read* read_policy_p, as_key* key_p,
+        uint32_t* ttl_p, uint32_t* token_p TSRMLS_DC)
+{
+    aerospike_record_cache_entry*   entry_p = NULL;
+    as_record*                      record_p = NULL;
+    as_record*                      header_p = NULL;
+    as_error                        error;
+    uint32_t                        bucket = 0;
+    uint16_t                        gen = 0;
+    time_t                          now = time(NULL);
+    bool                            is_stale = false;
+    size_t                          max_memory = (size_t) (READ_CACHE_MAX_MEMORY_PHP_INI);
+
+    *token_p = aerospike_shm_record_cache_token(key_p TSRMLS_CC);
+
+    pthread_mutex_lock(&cache_p->lock);
+    if ((entry_p = aerospike_record_cache_find(cache_p, key_p, &bucket))) {
+        if (entry_p->expires_at && entry_p->expires_at <= now) {
+            aerospike_record_cache_evict(cache_p, entry_p);
+        } else if (now - entry_p->cached_at >= READ_CACHE_MAX_AGE_PHP_INI) {
+            is_stale = true;
+            gen = entry_p->record_p->gen;
+        } else {
+            aerospike_record_cache_touch(cache_p, entry_p);
+            record_p = (as_record *) as_val_reserve(entry_p->record_p);
+            *ttl_p = entry_p->expires_at ? (uint32_t) (entry_p->expires_at - now) : entry_p->record_p->ttl;
+        }
+    }
+    pthread_mutex_unlock(&cache_p->lock);
+
+    if (!record_p && !is_stale &&
+            (record_p = aerospike_shm_record_cache_get(key_p, cache_p->cluster_id,
+                ttl_p TSRMLS_CC)) &&
+            max_memory > 0) {
+        aerospike_record_cache_put_local(cache_p, key_p, record_p, max_memory);
+    }
+
+    if (!is_stale || !as_object_p) {
+        return record_p;
+    }
+
+    as_error_init(&error);
+    if (AEROSPIKE_OK != aerospike_key_exists(as_object_p, &error,
+                read_policy_p, key_p, &header_p) || !header_p) {
+        aerospike_record_cache_remove(cache_p, key_p TSRMLS_CC);
+        goto exit;
+    }
+
+    pthread_mutex_lock(&cache_p->lock);
+    if ((entry_p = aerospike_record_cache_find(cache_p, key_p, &bucket))) {
+        if (header_p->gen != gen || entry_p->record_p->gen != gen) {
+            aerospike_record_cache_evict(cache_p, entry_p);
+        } else {
+            entry_p->cached_at = now;
+            entry_p->expires_at = (header_p->ttl == 0 || header_p->ttl == AS_RECORD_NO_EXPIRE_TTL) ?
+                0 : now + header_p->ttl;
+            aerospike_record_cache_touch(cache_p, entry_p);
+            record_p = (as_record *) as_val_reserve(entry_p->record_p);
+            *ttl_p = header_p->ttl;
+        }
+    }
+    pthread_mutex_unlock(&cache_p->lock);
+
+exit:
+    if (header_p) {
+        as_record_destroy(header_p);
+    }
+    return record_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Deep copies a bin value, adding its estimated footprint to size_p. Lists and
+ * maps are copied through the msgpack serializer, whose output size is used
+ * as their footprint.
+ *
+ * @return the copy, or NULL if the value could not be copied.
+ *******************************************************************************************************
+ */
+static as_val*
+aerospike_record_cache_copy_val(const as_val* val_p, size_t* size_p)
+{
+    as_val*                     copy_p = NULL;
+    as_serializer               serializer;
+    as_buffer                   buffer;
+    as_bytes*                   bytes_p = NULL;
+    char*                       str_p = NULL;
+
+    switch (as_val_type(val_p)) {
+        case AS_NIL:
+            copy_p = (as_val *) &as_nil;
+            break;
+        case AS_INTEGER:
+            copy_p = (as_val *) as_integer_new(as_integer_get((as_integer *) val_p));
+            *size_p += sizeof(as_integer);
+            break;
+        case AS_STRING:
+            if ((str_p = strdup(as_string_get((as_string *) val_p)))) {
+                copy_p = (as_val *) as_string_new(str_p, true);
+                *size_p += sizeof(as_string) + strlen(str_p) + 1;
+            }
+            break;
+        case AS_BYTES:
+            if ((bytes_p = as_bytes_new(((as_bytes *) val_p)->size))) {
+                as_bytes_set(bytes_p, 0, ((as_bytes *) val_p)->value, ((as_bytes *) val_p)->size);
+                as_bytes_set_type(bytes_p, as_bytes_get_type((as_bytes *) val_p));
+                copy_p = (as_val *) bytes_p;
+                *size_p += sizeof(as_bytes) + bytes_p->size;
+            }
+            break;
+        case AS_LIST:
+        case AS_MAP:
+            as_msgpack_init(&serializer);
+            as_buffer_init(&buffer);
+            if (0 == as_serializer_serialize(&serializer, (as_val *) val_p, &buffer)) {
+                as_serializer_deserialize(&serializer, &buffer, &copy_p);
+                *size_p += buffer.size;
+            }
+            as_buffer_destroy(&buffer);
+            as_serializer_destroy(&serializer);
+            break;
+        default:
+            break;
+    }
+    return copy_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Caches a copy of a record, evicting the least recently used records to stay
+ * within max_memory bytes. The record is not cached if its copy alone would
+ * exceed the bound.
+ *******************************************************************************************************
+ */
+static void
+aerospike_record_cache_put_local(aerospike_record_cache* cache_p, as_key* key_p,
+        const as_record* record_p, size_t max_memory)
+{
+    aerospike_record_cache_entry*   entry_p = NULL;
+    aerospike_record_cache_entry*   old_entry_p = NULL;
+    as_record*                      copy_p = NULL;
+    as_val*                         val_p = NULL;
+    uint32_t                        bucket = 0;
+    uint16_t                        i = 0;
+    size_t                          size = sizeof(aerospike_record_cache_entry) + sizeof(as_record);
+    time_t                          now = time(NULL);
+
+    if (max_memory == 0 || !(copy_p = as_record_new(record_p->bins.size))) {
+        return;
+    }
+    copy_p->gen = record_p->gen;
+    copy_p->ttl = record_p->ttl;
+    for (i = 0; i < record_p->bins.size; i++) {
+        if (!(val_p = aerospike_record_cache_copy_val(
+                        (as_val *) record_p->bins.entries[i].valuep, &size))) {
+            goto exit;
+        }
+        as_record_set(copy_p, record_p->bins.entries[i].name, (as_bin_value *) val_p);
+        size += sizeof(as_bin);
+    }
+
+    if (size > max_memory ||
+            !(entry_p = (aerospike_record_cache_entry *) calloc(1, sizeof(aerospike_record_cache_entry)))) {
+        goto exit;
+    }
+    strncpy(entry_p->ns, key_p->ns, AS_NAMESPACE_MAX_SIZE - 1);
+    memcpy(entry_p->digest, as_key_digest(key_p)->value, AS_DIGEST_VALUE_SIZE);
+    entry_p->record_p = copy_p;
+    entry_p->size = size;
+    entry_p->cached_at = now;
+    entry_p->expires_at = (record_p->ttl == 0 || record_p->ttl == AS_RECORD_NO_EXPIRE_TTL) ?
+        0 : now + record_p->ttl;
+    copy_p = NULL;
+
+    pthread_mutex_lock(&cache_p->lock);
+    if (!cache_p->buckets_p && !(cache_p->buckets_p = (aerospike_record_cache_entry **)
+                calloc(RECORD_CACHE_BUCKETS, sizeof(aerospike_record_cache_entry *)))) {
+        pthread_mutex_unlock(&cache_p->lock);
+        as_record_destroy(entry_p->record_p);
+        free(entry_p);
+        return;
+    }
+    if ((old_entry_p = aerospike_record_cache_find(cache_p, key_p, &bucket))) {
+        aerospike_record_cache_evict(cache_p, old_entry_p);
+    }
+    while (cache_p->lru_tail_p && cache_p->size + size > max_memory) {
+        aerospike_record_cache_evict(cache_p, cache_p->lru_tail_p);
+    }
+
+    entry_p->bucket = bucket;
+    entry_p->hash_next_p = cache_p->buckets_p[bucket];
+    cache_p->buckets_p[bucket] = entry_p;
+    entry_p->lru_next_p = cache_p->lru_head_p;
+    if (cache_p->lru_head_p) {
+        cache_p->lru_head_p->lru_prev_p = entry_p;
+    } else {
+        cache_p->lru_tail_p = entry_p;
+    }
+    cache_p->lru_head_p = entry_p;
+    cache_p->size += size;
+    pthread_mutex_unlock(&cache_p->lock);
+
+exit:
+    if (copy_p) {
+        as_record_destroy(copy_p);
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Caches a record read from the server, in the cache of the connection
+ * within aerospike.read_cache.max_memory bytes, and in the shared memory
+ * record cache if it is enabled.
+ *
+ * @param cache_p               The cache to be populated.
+ * @param key_p                 The key of the record.
+ * @param record_p              The record read from the server.
+ * @param max_memory            The value of aerospike.read_cache.max_memory.
+ * @param token                 The token returned by aerospike_record_cache_get()
+ *                              before the record was read.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_record_cache_put(aerospike_record_cache* cache_p, as_key* key_p,
+        const as_record* record_p, size_t max_memory, uint32_t token TSRMLS_DC)
+{
+    aerospike_record_cache_put_local(cache_p, key_p, record_p, max_memory);
+    aerospike_shm_record_cache_put(key_p, record_p, cache_p->cluster_id, token TSRMLS_CC);
+}
+
+/*
+ *******************************************************************************************************
+ * Drops the cached record of a key. Called after a write to the key through
+ * this client, so that the next cached read goes to the server.
+ *
+ * @param cache_p               The cache holding the record.
+ * @param key_p                 The key of the record.
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_record_cache_remove(aerospike_record_cache* cache_p, as_key* key_p TSRMLS_DC)
+{
+    aerospike_record_cache_entry*   entry_p = NULL;
+    uint32_t                        bucket = 0;
+
+    aerospike_read_memo_remove(cache_p, key_p TSRMLS_CC);
+    aerospike_shm_record_cache_remove(key_p TSRMLS_CC);
+    if (!cache_p->buckets_p) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache_p->lock);
+    if ((entry_p = aerospike_record_cache_find(cache_p, key_p, &bucket))) {
+        aerospike_record_cache_evict(cache_p, entry_p);
+    }
+    pthread_mutex_unlock(&cache_p->lock);
+}
+
+/*
+ *******************************************************************************************************
+ * Request scoped read memo.
+ *
+ * With aerospike.read_memo, the records returned by get() are kept until the
+ * end of the request, so that a later get() of the same key through the same
+ * connection is answered without a read. The memo maps the connection and the
+ * key to an array of the records returned for each bin filter, the record
+ * returned without a filter being under "".
+ *******************************************************************************************************
+ */
+#define READ_MEMO_KEY_SIZE (sizeof(void *) + AS_NAMESPACE_MAX_SIZE + AS_DIGEST_VALUE_SIZE)
+
+/*
+ *******************************************************************************************************
+ * Builds the memo key of a record: the address of the connection's cache,
+ * the namespace and the digest.
+ *******************************************************************************************************
+ */
+static void
+aerospike_read_memo_key(aerospike_record_cache* cache_p, as_key* key_p,
+        char* memo_key_p)
+{
+    memset(memo_key_p, 0, READ_MEMO_KEY_SIZE);
+    memcpy(memo_key_p, &cache_p, sizeof(void *));
+    strncpy(memo_key_p + sizeof(void *), key_p->ns, AS_NAMESPACE_MAX_SIZE - 1);
+    memcpy(memo_key_p + sizeof(void *) + AS_NAMESPACE_MAX_SIZE,
+            as_key_digest(key_p)->value, AS_DIGEST_VALUE_SIZE);
+}
+
+/*
+ *******************************************************************************************************
+ * Builds the memo entry key of a bin filter, the bin names each followed by
+ * a comma, or "" without a filter. The returned string must be freed with
+ * efree().
+ *******************************************************************************************************
+ */
+static char*
+aerospike_read_memo_filter(zval* bins_p, uint* filter_len_p TSRMLS_DC)
+{
+    HashPosition                position;
+    zval**                      bin_pp = NULL;
+    char*                       filter_p = NULL;
+    uint                        filter_len = 0;
+
+    if (!bins_p) {
+        *filter_len_p = 0;
+        return estrndup("", 0);
+    }
+
+    foreach_hashtable(Z_ARRVAL_P(bins_p), position, bin_pp) {
+        if (Z_TYPE_PP(bin_pp) != IS_STRING) {
+            if (filter_p) {
+                efree(filter_p);
+            }
+            return NULL;
+        }
+        filter_p = erealloc(filter_p, filter_len + Z_STRLEN_PP(bin_pp) + 2);
+        memcpy(filter_p + filter_len, Z_STRVAL_PP(bin_pp), Z_STRLEN_PP(bin_pp));
+        filter_len += Z_STRLEN_PP(bin_pp);
+        filter_p[filter_len++] = ',';
+        filter_p[filter_len] = '\0';
+    }
+    *filter_len_p = filter_len;
+    return filter_p ? filter_p : estrndup("", 0);
+}
+
+/*
+ *******************************************************************************************************
+ * Answers a get() from the read memo. A filtered get() is also answered from
+ * the record memoized without a filter, keeping only the requested bins, as
+ * long as the record has all of them: the bins it lacks are missed, so that
+ * the server decides how they are returned.
+ *
+ * @param cache_p               The read cache of the connection.
+ * @param key_p                 The key of the record.
+ * @param bins_p                The bin filter of get(), or NULL.
+ * @param record_p              The zval to be set to the memoized record.
+ *
+ * @return true if the record is memoized.
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_read_memo_get(aerospike_record_cache* cache_p, as_key* key_p,
+        zval* bins_p, zval* record_p TSRMLS_DC)
+{
+    char                        memo_key[READ_MEMO_KEY_SIZE];
+    char*                       filter_p = NULL;
+    uint                        filter_len = 0;
+    zval**                      entry_pp = NULL;
+    zval**                      memo_record_pp = NULL;
+    zval**                      memo_bins_pp = NULL;
+    zval**                      bin_pp = NULL;
+    zval**                      value_pp = NULL;
+    zval*                       projected_bins_p = NULL;
+    HashPosition                position;
+    bool                        is_found = false;
+
+    if (!(READ_MEMO_PHP_INI) || !AEROSPIKE_G(read_memo_g)) {
+        return false;
+    }
+
+    aerospike_read_memo_key(cache_p, key_p, memo_key);
+    if (FAILURE == zend_hash_find(AEROSPIKE_G(read_memo_g), memo_key,
+                READ_MEMO_KEY_SIZE, (void **) &entry_pp) ||
+            !(filter_p = aerospike_read_memo_filter(bins_p, &filter_len TSRMLS_CC))) {
+        goto exit;
+    }
+
+    if (SUCCESS == zend_hash_find(Z_ARRVAL_PP(entry_pp), filter_p, filter_len + 1,
+                (void **) &memo_record_pp)) {
+        zval_dtor(record_p);
+        ZVAL_ZVAL(record_p, *memo_record_pp, 1, 0);
+        is_found = true;
+        goto exit;
+    }
+
+    if (!bins_p || FAILURE == zend_hash_find(Z_ARRVAL_PP(entry_pp), "", 1,
+                (void **) &memo_record_pp) ||
+            FAILURE == zend_hash_find(Z_ARRVAL_PP(memo_record_pp),
+                PHP_AS_RECORD_DEFINE_FOR_BINS, strlen(PHP_AS_RECORD_DEFINE_FOR_BINS) + 1,
+                (void **) &memo_bins_pp)) {
+        goto exit;
+    }
+
+    MAKE_STD_ZVAL(projected_bins_p);
+    array_init(projected_bins_p);
+    foreach_hashtable(Z_ARRVAL_P(bins_p), position, bin_pp) {
+        if (SUCCESS == zend_hash_find(Z_ARRVAL_PP(memo_bins_pp), Z_STRVAL_PP(bin_pp),
+                    Z_STRLEN_PP(bin_pp) + 1, (void **) &value_pp)) {
+            Z_ADDREF_PP(value_pp);
+            add_assoc_zval(projected_bins_p, Z_STRVAL_PP(bin_pp), *value_pp);
+        } else {
+            zval_ptr_dtor(&projected_bins_p);
+            goto exit;
+        }
+    }
+    zval_dtor(record_p);
+    ZVAL_ZVAL(record_p, *memo_record_pp, 1, 0);
+    SEPARATE_ARRAY(record_p);
+    add_assoc_zval(record_p, PHP_AS_RECORD_DEFINE_FOR_BINS, projected_bins_p);
+    is_found = true;
+
+exit:
+    if (filter_p) {
+        efree(filter_p);
+    }
+    return is_found;
+}
+
+/*
+ *******************************************************************************************************
+ * Memoizes a record returned by get() until the end of the request.
+ *
+ * @param cache_p               The read cache of the connection.
+ * @param key_p                 The key of the record.
+ * @param bins_p                The bin filter of get(), or NULL.
+ * @param record_p              The record returned by get().
+ *
+ *******************************************************************************************************
+ */
+extern void
+aerospike_read_memo_put(aerospike_record_cache* cache_p, as_key* key_p,
+        zval* bins_p, zval* record_p TSRMLS_DC)
+{
+    char                        memo_key[READ_MEMO_KEY_SIZE];
+    char*                       filter_p = NULL;
+    uint                        filter_len = 0;
+    zval**                      entry_pp = NULL;
+    zval*                       entry_p = NULL;
+    zval*                       memo_record_p = NULL;
+
+    if (!(READ_MEMO_PHP_INI) ||
+            !(filter_p = aerospike_read_memo_filter(bins_p, &filter_len TSRMLS_CC))) {
+        return;
+    }
+
+    if (!AEROSPIKE_G(read_memo_g)) {
+        ALLOC_HASHTABLE(AEROSPIKE_G(read_memo_g));
+        zend_hash_init(AEROSPIKE_G(read_memo_g), 16, NULL, ZVAL_PTR_DTOR, 0);
+    }
+
+    aerospike_read_memo_key(cache_p, key_p, memo_key);
+    if (SUCCESS == zend_hash_find(AEROSPIKE_G(read_memo_g), memo_key,
+                READ_MEMO_KEY_SIZE, (void **) &entry_pp)) {
+        entry_p = *entry_pp;
+    } else {
+        MAKE_STD_ZVAL(entry_p);
+        array_init(entry_p);
+        zend_hash_update(AEROSPIKE_G(read_memo_g), memo_key, READ_MEMO_KEY_SIZE,
+                (void **) &entry_p, sizeof(zval *), NULL);
+    }
+
+    MAKE_STD_ZVAL(memo_record_p);
+    ZVAL_ZVAL(memo_record_p, record_p, 1, 0);
+    add_assoc_zval_ex(entry_p, filter_p, filter_len + 1, memo_record_p);
+    efree(filter_p);
+}
+
+/*
+ *******************************************************************************************************
+ * Drops the memoized records of a key, after a write to it through this
+ * client.
+ *
+ * @param cache_p               The read cache of the connection.
+ * @param key_p                 The key of the record.
+ *
+ *******************************************************************************************************
+ */
+static void
+aerospike_read_memo_remove(aerospike_record_cache* cache_p, as_key* key_p TSRMLS_DC)
+{
+    char                        memo_key[READ_MEMO_KEY_SIZE];
+
+    if (!AEROSPIKE_G(read_memo_g)) {
+        return;
+    }
+
+    aerospike_read_memo_key(cache_p, key_p, memo_key);
+    zend_hash_del(AEROSPIKE_G(read_memo_g), memo_key, READ_MEMO_KEY_SIZE);
+}
+
+/*
+ *******************************************************************************************************
+ * Releases the read memo, at the end of the request.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_read_memo_destroy(TSRMLS_D)
+{
+    if (AEROSPIKE_G(read_memo_g)) {
+        zend_hash_destroy(AEROSPIKE_G(read_memo_g));
+        FREE_HASHTABLE(AEROSPIKE_G(read_memo_g));
+        AEROSPIKE_G(read_memo_g) = NULL;
+    }
+}
@@ -122,6 +122,7 @@ extern as_status aerospike_record_operations_exists(aerospike* as_object_p,
     as_status                   status = AEROSPIKE_OK;
     as_policy_read              read_policy;
     as_record*                  record_p = NULL;
+    uint64_t                    started_at = 0;
     /*Aerospike_object *aerospike_object = PHP_AEROSPIKE_GET_OBJECT;
     TSRMLS_FETCH_FROM_CTX(aerospike_object->ts);*/
 
@@ -138,8 +139,13 @@ extern as_status aerospike_record_operations_exists(aerospike* as_object_p,
         goto exit;
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_key_exists(as_object_p, error_p,
-                    &read_policy, as_key_p, &record_p))) {
+    started_at = aerospike_latency_now();
+    status = aerospike_key_exists(as_object_p, error_p, &read_policy, as_key_p,
+            &record_p);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_GET, as_key_p, started_at);
+    aerospike_call_trace_command(as_object_p, AEROSPIKE_LATENCY_GET, "exists", as_key_p,
+            status, started_at TSRMLS_CC);
+    if (AEROSPIKE_OK != status) {
         goto exit;
     }
 
@@ -176,6 +182,7 @@ aerospike_record_operations_remove(Aerospike_object* aerospike_obj_p,
     as_status                   status = AEROSPIKE_OK;
     as_policy_remove            remove_policy;
     aerospike*                  as_object_p = aerospike_obj_p->as_ref_p->as_p;
+    uint64_t                    started_at = 0;
     TSRMLS_FETCH_FROM_CTX(aerospike_obj_p->ts);
 
     if ( (!as_key_p) || (!error_p) ||
@@ -192,8 +199,12 @@ aerospike_record_operations_remove(Aerospike_object* aerospike_obj_p,
     }
 
     get_generation_value(options_p, &remove_policy.generation, error_p TSRMLS_CC);
-    if (AEROSPIKE_OK != (status = aerospike_key_remove(as_object_p, error_p,
-                    &remove_policy, as_key_p))) {
+    started_at = aerospike_latency_now();
+    status = aerospike_key_remove(as_object_p, error_p, &remove_policy, as_key_p);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_PUT, as_key_p, started_at);
+    aerospike_call_trace_command(as_object_p, AEROSPIKE_LATENCY_PUT, "remove", as_key_p,
+            status, started_at TSRMLS_CC);
+    if (AEROSPIKE_OK != status) {
         goto exit;
     }
 exit: 
@@ -245,6 +256,7 @@ aerospike_record_operations_general(Aerospike_object* aerospike_obj_p,
     as_status           status = AEROSPIKE_OK;
     as_policy_operate   operate_policy;
     uint32_t            serializer_policy;
+    uint64_t            started_at = 0;
 
     TSRMLS_FETCH_FROM_CTX(aerospike_obj_p->ts);
     as_operations_inita(&ops, 1);
@@ -269,8 +281,13 @@ aerospike_record_operations_general(Aerospike_object* aerospike_obj_p,
         goto exit;
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_key_operate(as_object_p, error_p,
-                    &operate_policy, as_key_p, &ops, NULL))) {
+    started_at = aerospike_latency_now();
+    status = aerospike_key_operate(as_object_p, error_p, &operate_policy,
+            as_key_p, &ops, NULL);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_OPERATE, as_key_p, started_at);
+    aerospike_call_trace_command(as_object_p, AEROSPIKE_LATENCY_OPERATE, NULL, as_key_p,
+            status, started_at TSRMLS_CC);
+    if (AEROSPIKE_OK != status) {
         goto exit;
     }
 
@@ -295,6 +312,7 @@ aerospike_record_operations_operate(Aerospike_object* aerospike_obj_p,
     aerospike*                  as_object_p = aerospike_obj_p->as_ref_p->as_p;
     as_status                   status = AEROSPIKE_OK;
     as_policy_operate           operate_policy;
+    uint64_t                    started_at = 0;
     HashPosition                pointer;
     HashPosition                each_pointer;
     HashTable*                  each_operation_array_p = NULL;
@@ -371,8 +389,13 @@ aerospike_record_operations_operate(Aerospike_object* aerospike_obj_p,
         }
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_key_operate(as_object_p, error_p,
-                    &operate_policy, as_key_p, &ops, &get_rec))) {
+    started_at = aerospike_latency_now();
+    status = aerospike_key_operate(as_object_p, error_p, &operate_policy,
+            as_key_p, &ops, &get_rec);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_OPERATE, as_key_p, started_at);
+    aerospike_call_trace_command(as_object_p, AEROSPIKE_LATENCY_OPERATE, NULL, as_key_p,
+            status, started_at TSRMLS_CC);
+    if (AEROSPIKE_OK != status) {
         DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
         goto exit;
     } else {
@@ -425,6 +448,7 @@ aerospike_record_operations_remove_bin(Aerospike_object* aerospike_obj_p,
     zval                **bin_names;
     as_policy_write     write_policy;
     aerospike*          as_object_p = aerospike_obj_p->as_ref_p->as_p;
+    uint64_t            started_at = 0;
     TSRMLS_FETCH_FROM_CTX(aerospike_obj_p->ts);
 
     as_record_inita(&rec, zend_hash_num_elements(bins_array_p));
@@ -455,8 +479,12 @@ aerospike_record_operations_remove_bin(Aerospike_object* aerospike_obj_p,
     }
 
     get_generation_value(options_p, &rec.gen, error_p TSRMLS_CC);
-    if (AEROSPIKE_OK != (status = aerospike_key_put(as_object_p, error_p,
-                    NULL, as_key_p, &rec))) {
+    started_at = aerospike_latency_now();
+    status = aerospike_key_put(as_object_p, error_p, NULL, as_key_p, &rec);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_PUT, as_key_p, started_at);
+    aerospike_call_trace_command(as_object_p, AEROSPIKE_LATENCY_PUT, "removeBin", as_key_p,
+            status, started_at TSRMLS_CC);
+    if (AEROSPIKE_OK != status) {
          goto exit;
     }
 
@@ -497,8 +525,9 @@ aerospike_php_exists_metadata(Aerospike_object* aerospike_obj_p,
         goto exit;
     }
 
-    if (PHP_TYPE_ISNOTARR(key_record_p) ||
-             ((options_p) && (PHP_TYPE_ISNOTARR(options_p)))) {
+    if (PHP_TYPE_ISNOTKEY(key_record_p) ||
+             ((options_p) && (PHP_TYPE_ISNOTARR(options_p)) &&
+              !aerospike_policy_is_compiled(options_p TSRMLS_CC))) {
         PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
                 "input parameters (type) for exist/getMetdata function not proper.");
         status = AEROSPIKE_ERR_PARAM;
@@ -515,8 +544,8 @@ aerospike_php_exists_metadata(Aerospike_object* aerospike_obj_p,
     }
 
     if (AEROSPIKE_OK != (status =
-                aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_record_p),
-                    &as_key_for_put_record, &initializeKey))) {
+                aerospike_transform_get_rec_key(key_record_p,
+                    &as_key_for_put_record, &initializeKey TSRMLS_CC))) {
         PHP_EXT_SET_AS_ERR(error_p, status,
                 "unable to iterate through exists/getMetadata key params");
         DEBUG_PHP_EXT_ERROR("unable to iterate through exists/getMetadata key params");
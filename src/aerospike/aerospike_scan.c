@@ -5,6 +5,7 @@
 #include "aerospike/as_error.h"
 #include "aerospike/as_status.h"
 #include "aerospike/aerospike.h"
+#include "aerospike/as_cluster.h"
 #include "aerospike_common.h"
 #include "aerospike/as_udf.h"
 #include "aerospike/as_scan.h"
@@ -14,10 +15,202 @@
 #define PROGRESS_PCT "progress_pct"
 #define RECORDS_SCANNED "records_scanned"
 #define STATUS "status"
+#define CURSOR_COMPLETED "completed"
+#define CURSOR_DONE "done"
+
+/*
+ ******************************************************************************************************
+ * Reads an Aerospike::OPT_SCAN_SHARD value array(shard, shards).
+ *
+ * @param shard_value_p             The OPT_SCAN_SHARD value.
+ * @param shard_p                   The shard to be scanned.
+ * @param shards_p                  The number of shards the scan is split into.
+ *
+ * @return AEROSPIKE_OK if the value is valid. Otherwise AEROSPIKE_ERR_PARAM.
+ ******************************************************************************************************
+ */
+static as_status
+aerospike_scan_get_shard(zval* shard_value_p, long* shard_p, long* shards_p)
+{
+    zval**              shard_pp = NULL;
+    zval**              shards_pp = NULL;
+
+    if ((Z_TYPE_P(shard_value_p) != IS_ARRAY) ||
+            (zend_hash_num_elements(Z_ARRVAL_P(shard_value_p)) != 2) ||
+            (SUCCESS != zend_hash_index_find(Z_ARRVAL_P(shard_value_p), 0, (void **) &shard_pp)) ||
+            (SUCCESS != zend_hash_index_find(Z_ARRVAL_P(shard_value_p), 1, (void **) &shards_pp)) ||
+            (Z_TYPE_PP(shard_pp) != IS_LONG) || (Z_TYPE_PP(shards_pp) != IS_LONG) ||
+            (Z_LVAL_PP(shards_pp) < 1) ||
+            (Z_LVAL_PP(shard_pp) < 0) || (Z_LVAL_PP(shard_pp) >= Z_LVAL_PP(shards_pp))) {
+        return AEROSPIKE_ERR_PARAM;
+    }
+    *shard_p = Z_LVAL_PP(shard_pp);
+    *shards_p = Z_LVAL_PP(shards_pp);
+    return AEROSPIKE_OK;
+}
+
+/*
+ ******************************************************************************************************
+ * Reads the list of completed nodes of an Aerospike::scanNodes() cursor into
+ * a new array, an empty cursor starting the scan from its first node.
+ *
+ * @param cursor_p                  The cursor array.
+ * @param completed_p               The array to be populated with the names of
+ *                                  the completed nodes.
+ *
+ * @return AEROSPIKE_OK if the cursor is valid. Otherwise AEROSPIKE_ERR_PARAM.
+ ******************************************************************************************************
+ */
+static as_status
+aerospike_scan_get_cursor(zval* cursor_p, zval* completed_p)
+{
+    zval**              completed_pp = NULL;
+    zval**              node_name_pp = NULL;
+    HashPosition        pos;
+
+    if (SUCCESS != zend_hash_find(Z_ARRVAL_P(cursor_p), CURSOR_COMPLETED,
+                sizeof(CURSOR_COMPLETED), (void **) &completed_pp)) {
+        return AEROSPIKE_OK;
+    }
+    if (Z_TYPE_PP(completed_pp) != IS_ARRAY) {
+        return AEROSPIKE_ERR_PARAM;
+    }
+    foreach_hashtable(Z_ARRVAL_PP(completed_pp), pos, node_name_pp) {
+        if (Z_TYPE_PP(node_name_pp) != IS_STRING) {
+            return AEROSPIKE_ERR_PARAM;
+        }
+        add_next_index_stringl(completed_p, Z_STRVAL_PP(node_name_pp),
+                Z_STRLEN_PP(node_name_pp), 1);
+    }
+    return AEROSPIKE_OK;
+}
+
+/*
+ ******************************************************************************************************
+ * Checks whether a node is listed in the completed nodes of a cursor.
+ *
+ * @param completed_p               The array of the names of the completed nodes.
+ * @param node_name_p               The name of the node.
+ *
+ * @return true if the node was completed, else false.
+ ******************************************************************************************************
+ */
+static bool
+aerospike_scan_is_node_completed(zval* completed_p, const char* node_name_p)
+{
+    zval**              node_name_pp = NULL;
+    HashPosition        pos;
+
+    foreach_hashtable(Z_ARRVAL_P(completed_p), pos, node_name_pp) {
+        if (!strcmp(Z_STRVAL_PP(node_name_pp), node_name_p)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int
+aerospike_scan_node_name_cmp(const void* name1_p, const void* name2_p)
+{
+    return strcmp((const char *) name1_p, (const char *) name2_p);
+}
+
+/*
+ ******************************************************************************************************
+ * Scans the nodes of a shard of the cluster. The node names are sorted so
+ * that every client agrees on them, and shard i of n is made of the nodes at
+ * positions i, i + n, i + 2n... Each node is scanned on its own by
+ * aerospike_scan_node(), so the other nodes never read the records of the
+ * shard. The scan of each node is credited to it in the latency statistics.
+ *
+ * The split is only exact while the nodes of the cluster do not change, and
+ * a shard beyond the number of nodes is rejected rather than left empty, so
+ * that a misconfigured worker pool does not silently skip records.
+ *
+ * With a cursor, the nodes it lists as completed are skipped, and each node
+ * scanned to its end is added to it. The max_records limit then stops the
+ * scan from starting a new node, rather than aborting the one being scanned,
+ * so that every call completes at least one node.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param scan_policy_p             The scan policy, or NULL for the default one.
+ * @param scan_p                    The scan to run on the nodes of the shard.
+ * @param shard                     The shard to be scanned.
+ * @param shards                    The number of shards the scan is split into.
+ * @param completed_p               The array of the names of the completed
+ *                                  nodes of the cursor, or NULL.
+ * @param max_records               The number of records after which no new
+ *                                  node is started with a cursor, 0 for no limit.
+ * @param done_p                    Set to whether every node of the shard is
+ *                                  completed.
+ * @param user_func_p               The user's callback to be applied per record
+ *                                  that is scanned.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+static as_status
+aerospike_scan_run_shard(aerospike* as_object_p, as_error* error_p,
+        as_policy_scan* scan_policy_p, as_scan* scan_p, long shard, long shards,
+        zval* completed_p, uint64_t max_records, bool* done_p,
+        userland_callback* user_func_p)
+{
+    char*               node_names_p = NULL;
+    char*               node_name_p = NULL;
+    int                 n_nodes = 0;
+    uint64_t            started_at = 0;
+    as_status           status = AEROSPIKE_OK;
+    long                i;
+
+    *done_p = false;
+    as_cluster_get_node_names(as_object_p->cluster, &n_nodes, &node_names_p);
+    if (shards > n_nodes) {
+        DEBUG_PHP_EXT_DEBUG("OPT_SCAN_SHARD splits the scan into more shards than the %d nodes", n_nodes);
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+                "OPT_SCAN_SHARD cannot split the scan into more shards than nodes");
+        goto exit;
+    }
+    if (n_nodes > 1) {
+        qsort(node_names_p, n_nodes, AS_NODE_NAME_MAX_SIZE, aerospike_scan_node_name_cmp);
+    }
+
+    for (i = shard; i < n_nodes; i += shards) {
+        node_name_p = &node_names_p[i * AS_NODE_NAME_MAX_SIZE];
+        if (completed_p && aerospike_scan_is_node_completed(completed_p, node_name_p)) {
+            continue;
+        }
+        if (max_records && user_func_p->records_count >= max_records) {
+            DEBUG_PHP_EXT_DEBUG("Scan cursor stopped before node %s", node_name_p);
+            goto exit;
+        }
+        started_at = aerospike_latency_now();
+        status = aerospike_scan_node(as_object_p, error_p, scan_policy_p, scan_p,
+                node_name_p, aerospike_helper_record_stream_callback, user_func_p);
+        aerospike_latency_record_node(AEROSPIKE_LATENCY_SCAN, node_name_p, started_at);
+        if (AEROSPIKE_OK != status) {
+            DEBUG_PHP_EXT_DEBUG("Unable to scan node %s", node_name_p);
+            goto exit;
+        }
+        if (completed_p) {
+            add_next_index_string(completed_p, node_name_p, 1);
+        }
+    }
+    *done_p = true;
+
+exit:
+    if (node_names_p) {
+        free(node_names_p);
+    }
+    return error_p->code;
+}
 
 /*
  ******************************************************************************************************
  * Scans a set in the Aerospike DB.
+ * With a cursor, the scan runs node by node and can be resumed: the cursor
+ * is updated in place with the nodes scanned to their end, which a later
+ * call passing it back skips.
  *
  * @param as_object_p               The C client's aerospike object.
  * @param error_p                   The C client's as_error to be set to the encountered error.
@@ -31,6 +224,7 @@
  * @param concurrent                Whether to scan all nodes in parallel.
  * @param no_bins                   Whether to return only metadata (and no bins).
  * @param options_p                 The optional policy.
+ * @param cursor_p                  The scanNodes() cursor array, or NULL.
  *
  * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
  ******************************************************************************************************
@@ -38,12 +232,19 @@
 extern as_status
 aerospike_scan_run(aerospike* as_object_p, as_error* error_p, char* namespace_p,
         char* set_p, userland_callback* user_func_p, HashTable* bins_ht_p,
-        zval* options_p TSRMLS_DC)
+        zval* options_p, zval* cursor_p TSRMLS_DC)
 {
     as_scan             scan;
     as_scan*            scan_p = NULL;
     as_policy_scan      scan_policy;
     uint32_t            serializer_policy = -1;
+    zval**              shard_pp = NULL;
+    long                shard = 0;
+    long                shards = 0;
+    zval*               completed_p = NULL;
+    uint64_t            max_records = 0;
+    bool                done = false;
+    uint64_t            started_at = 0;
 
     if ((!as_object_p) || (!error_p) || (!namespace_p) || (!set_p)) {
         DEBUG_PHP_EXT_DEBUG("Unable to initiate scan");
@@ -64,6 +265,35 @@ aerospike_scan_run(aerospike* as_object_p, as_error* error_p, char* namespace_p,
         goto exit;
     }
     
+    aerospike_helper_set_max_records(user_func_p, options_p);
+
+    if (options_p && (SUCCESS == zend_hash_index_find(Z_ARRVAL_P(options_p),
+                    OPT_SCAN_SHARD, (void **) &shard_pp)) &&
+            (AEROSPIKE_OK != aerospike_scan_get_shard(*shard_pp, &shard, &shards))) {
+        DEBUG_PHP_EXT_DEBUG("Invalid value for OPT_SCAN_SHARD");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM, "Invalid value for OPT_SCAN_SHARD");
+        goto exit;
+    }
+
+    if (cursor_p) {
+        MAKE_STD_ZVAL(completed_p);
+        array_init(completed_p);
+        if (AEROSPIKE_OK != aerospike_scan_get_cursor(cursor_p, completed_p)) {
+            zval_ptr_dtor(&completed_p);
+            completed_p = NULL;
+            DEBUG_PHP_EXT_DEBUG("Invalid scan cursor");
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM, "Invalid scan cursor");
+            goto exit;
+        }
+        if (!shards) {
+            shard = 0;
+            shards = 1;
+        }
+        max_records = user_func_p->max_records;
+        user_func_p->max_records = 0;
+    }
+
+    started_at = aerospike_latency_now();
     if (bins_ht_p) {
         as_scan_select_inita(&scan, zend_hash_num_elements(bins_ht_p));
         HashPosition pos;
@@ -74,17 +304,43 @@ aerospike_scan_run(aerospike* as_object_p, as_error* error_p, char* namespace_p,
             }
             as_scan_select(&scan, Z_STRVAL_PP(bin_names_pp));
         }
-        if (AEROSPIKE_OK != (aerospike_scan_foreach(as_object_p, error_p, &scan_policy,
+        if (shards) {
+            aerospike_scan_run_shard(as_object_p, error_p, &scan_policy, &scan,
+                    shard, shards, completed_p, max_records, &done, user_func_p);
+        } else if (AEROSPIKE_OK != (aerospike_scan_foreach(as_object_p, error_p, &scan_policy,
                         &scan, aerospike_helper_record_stream_callback, user_func_p))) {
             goto exit;
         }
     } else {
-        if (AEROSPIKE_OK != (aerospike_scan_foreach(as_object_p, error_p, NULL,
+        if (shards) {
+            aerospike_scan_run_shard(as_object_p, error_p, NULL, &scan,
+                    shard, shards, completed_p, max_records, &done, user_func_p);
+        } else if (AEROSPIKE_OK != (aerospike_scan_foreach(as_object_p, error_p, NULL,
                         &scan, aerospike_helper_record_stream_callback, user_func_p))) {
             goto exit;
         }
     }
 exit:
+    if (started_at) {
+        aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_SCAN, NULL, started_at);
+    }
+    /*
+     * The streams aborted on reaching OPT_MAX_RECORDS are not an error,
+     * unlike any other failure of the scan or query.
+     */
+    if (USERLAND_CALLBACK_LIMIT_ABORTED(user_func_p, error_p)) {
+        PHP_EXT_SET_AS_ERR(error_p, DEFAULT_ERRORNO, DEFAULT_ERROR);
+    }
+    /*
+     * The cursor is updated even if the scan failed, so that the nodes it
+     * completed are not scanned again.
+     */
+    if (completed_p) {
+        zval_dtor(cursor_p);
+        array_init(cursor_p);
+        add_assoc_zval(cursor_p, CURSOR_COMPLETED, completed_p);
+        add_assoc_bool(cursor_p, CURSOR_DONE, done);
+    }
     if (scan_p) {
         as_scan_destroy(scan_p);
     }
@@ -142,6 +398,20 @@ aerospike_scan_run_background(aerospike* as_object_p, as_error* error_p,
         goto exit;
     }
 
+    if (AEROSPIKE_OK != aerospike_helper_reject_max_records(options_p, error_p)) {
+        goto exit;
+    }
+
+    /*
+     * The C client 3.0 has no background scan of a single node, so a
+     * scanApply() cannot be split into shards.
+     */
+    if (options_p && zend_hash_index_exists(Z_ARRVAL_P(options_p), OPT_SCAN_SHARD)) {
+        DEBUG_PHP_EXT_DEBUG("OPT_SCAN_SHARD only applies to scan()");
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM, "OPT_SCAN_SHARD only applies to scan()");
+        goto exit;
+    }
+
     if ((*args_pp)) {
         as_arraylist_inita(&args_list,
                 zend_hash_num_elements(Z_ARRVAL_PP(args_pp)));
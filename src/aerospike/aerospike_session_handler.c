@@ -6,12 +6,57 @@
 #include "php_variables.h"
 #include "php_aerospike.h"
 #include "ext/session/php_session.h"
+#include "ext/standard/sha1.h"
+#include "ext/standard/php_rand.h"
+#include "ext/standard/php_smart_str.h"
 #include "aerospike/aerospike.h"
 #include "aerospike/aerospike_key.h"
+#include "aerospike/as_operations.h"
 #include "aerospike/as_config.h"
 #include "aerospike_common.h"
+#include <ctype.h>
+#include <limits.h>
+#include <unistd.h>
+#include <zlib.h>
 
 #define AEROSPIKE_SESSION_BIN "PHP_SESSION"
+#define AEROSPIKE_SESSION_LOCK_BIN "PHP_SESS_LOCK"
+#define AEROSPIKE_SESSION_LOCK_SUFFIX ".lock"
+#define AEROSPIKE_SESSION_LOCK_MIN_BACKOFF_USEC 1000
+#define AEROSPIKE_SESSION_LOCK_MAX_BACKOFF_USEC 100000
+#define AEROSPIKE_SESSION_KEY_BIN_PREFIX "s_"
+#define AEROSPIKE_SESSION_KEY_BIN_PREFIX_LEN 2
+#define AEROSPIKE_SESSION_BYTES_RAW 0
+#define AEROSPIKE_SESSION_BYTES_ZLIB 1
+#define AEROSPIKE_SESSION_BYTES_HEADER_SIZE 5
+#define AEROSPIKE_SESSION_SERIALIZED_MAX_DEPTH 64
+#define PS_DELIMITER '|'
+#define PS_UNDEF_MARKER '!'
+
+/*
+ *******************************************************************************************************
+ * Structure holding a single top-level entry ("name|serialized value") of
+ * session data encoded by the php serialize handler, along with the index of
+ * the per-key bin it is stored in.
+ *******************************************************************************************************
+ */
+typedef struct session_entry_t {
+    const char          *entry_p;
+    int                 entry_len;
+    int                 bin_index;
+} session_entry;
+
+/*
+ *******************************************************************************************************
+ * Structure holding the state of reading the per-key bins of a session
+ * record.
+ *******************************************************************************************************
+ */
+typedef struct session_read_udata_t {
+    aerospike_session   *session_p;
+    smart_str           *data_p;
+    as_error            *error_p;
+} session_read_udata;
 
 extern int persist;
 
@@ -20,9 +65,9 @@ extern int persist;
  * Sesion handler structure instance for Aerospike.
  *******************************************************************************************************
  */
-PS_FUNCS(aerospike);
+PS_FUNCS_SID(aerospike);
 ps_module ps_mod_aerospike = {
-    PS_MOD(aerospike)
+    PS_MOD_SID(aerospike)
 };
 
 /*
@@ -63,6 +108,28 @@ exit:
     return error_p->code;
 }
 
+/*
+ *******************************************************************************************************
+ * Function to compute the digest of serialized session data.
+ * Used to detect whether the session data written back at the end of the
+ * request differs from the data that was read at its start.
+ *
+ * @param data_p            The serialized session data.
+ * @param data_len          The length of the serialized session data.
+ * @param digest_p          The digest buffer of AEROSPIKE_SESSION_DIGEST_SIZE
+ *                          bytes to be populated by this method.
+ *******************************************************************************************************
+ */
+static void
+session_data_digest(const char *data_p, int data_len, unsigned char *digest_p)
+{
+    PHP_SHA1_CTX            context;
+
+    PHP_SHA1Init(&context);
+    PHP_SHA1Update(&context, (const unsigned char *) data_p, data_len);
+    PHP_SHA1Final(digest_p, &context);
+}
+
 /*
  *******************************************************************************************************
  * Function to initialize session object.
@@ -92,6 +159,12 @@ init_session(aerospike_session **session_pp, as_error *error_p TSRMLS_DC)
         (*session_pp)->aerospike_obj_p->as_ref_p = NULL;
         (*session_pp)->aerospike_obj_p->is_conn_16 = AEROSPIKE_CONN_STATE_FALSE;
         (*session_pp)->aerospike_obj_p->is_persistent = true;
+        (*session_pp)->is_read_digest_set = false;
+        (*session_pp)->lock_key_p = NULL;
+        (*session_pp)->lock_owner = 0;
+        (*session_pp)->created_sid_p = NULL;
+        (*session_pp)->key_bins_p = NULL;
+        (*session_pp)->has_session_bin = false;
     } else {
         PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
                 "Could not allocate memory for aerospike object");
@@ -117,6 +190,19 @@ static void
 destroy_session(aerospike_session *session_p TSRMLS_DC)
 {
     if (session_p && session_p->aerospike_obj_p) {
+        if (session_p->lock_key_p) {
+            efree(session_p->lock_key_p);
+            session_p->lock_key_p = NULL;
+        }
+        if (session_p->created_sid_p) {
+            efree(session_p->created_sid_p);
+            session_p->created_sid_p = NULL;
+        }
+        if (session_p->key_bins_p) {
+            zend_hash_destroy(session_p->key_bins_p);
+            efree(session_p->key_bins_p);
+            session_p->key_bins_p = NULL;
+        }
         session_p->aerospike_obj_p->as_ref_p = NULL;
         efree(session_p->aerospike_obj_p);
         session_p->aerospike_obj_p = NULL;
@@ -127,6 +213,802 @@ destroy_session(aerospike_session *session_p TSRMLS_DC)
     }
 }
 
+/*
+ *******************************************************************************************************
+ * Function to set a bin of a session record to the given data.
+ * Data shorter than aerospike.session.compress_threshold and free of NUL
+ * bytes is stored as a string. Otherwise it is stored as bytes prefixed by a
+ * one byte format flag and the uncompressed length, zlib compressed if it is
+ * above the threshold and compression actually reduces its size.
+ *
+ * @param record_p          The as_record whose bin is to be set.
+ * @param bin_name_p        The name of the bin to be set.
+ * @param data_p            The data to be stored.
+ * @param data_len          The length of the data to be stored.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+session_bin_set(as_record *record_p, const char *bin_name_p,
+        const char *data_p, int data_len, as_error *error_p TSRMLS_DC)
+{
+    long            threshold = SESSION_COMPRESS_THRESHOLD_PHP_INI;
+    bool            compress = (threshold > 0 && data_len >= threshold);
+    uint8_t*        buffer_p = NULL;
+    uLongf          payload_len = 0;
+    as_bytes*       bytes_p = NULL;
+
+    if (!compress && !memchr(data_p, '\0', data_len)) {
+        if (NULL == (buffer_p = malloc(data_len + 1))) {
+            goto oom;
+        }
+        memcpy(buffer_p, data_p, data_len);
+        buffer_p[data_len] = '\0';
+        if (!as_record_set_strp(record_p, bin_name_p, (char *) buffer_p, true)) {
+            free(buffer_p);
+            goto set_error;
+        }
+        goto exit;
+    }
+
+    payload_len = compress ? compressBound(data_len) : (uLongf) data_len;
+    if (payload_len < (uLongf) data_len) {
+        payload_len = data_len;
+    }
+    if (NULL == (buffer_p = malloc(AEROSPIKE_SESSION_BYTES_HEADER_SIZE + payload_len))) {
+        goto oom;
+    }
+
+    buffer_p[1] = (uint8_t) (data_len >> 24);
+    buffer_p[2] = (uint8_t) (data_len >> 16);
+    buffer_p[3] = (uint8_t) (data_len >> 8);
+    buffer_p[4] = (uint8_t) data_len;
+
+    if (compress && Z_OK == compress2(buffer_p + AEROSPIKE_SESSION_BYTES_HEADER_SIZE,
+                &payload_len, (const Bytef *) data_p, data_len, Z_BEST_SPEED) &&
+            payload_len < (uLongf) data_len) {
+        buffer_p[0] = AEROSPIKE_SESSION_BYTES_ZLIB;
+    } else {
+        buffer_p[0] = AEROSPIKE_SESSION_BYTES_RAW;
+        memcpy(buffer_p + AEROSPIKE_SESSION_BYTES_HEADER_SIZE, data_p, data_len);
+        payload_len = data_len;
+    }
+
+    if (NULL == (bytes_p = as_bytes_new_wrap(buffer_p,
+                    AEROSPIKE_SESSION_BYTES_HEADER_SIZE + payload_len, true))) {
+        free(buffer_p);
+        goto oom;
+    }
+    as_bytes_set_type(bytes_p, AS_BYTES_BLOB);
+
+    if (!as_record_set_bytes(record_p, bin_name_p, bytes_p)) {
+        as_bytes_destroy(bytes_p);
+        goto set_error;
+    }
+    goto exit;
+
+oom:
+    PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+            "Could not allocate memory for session data");
+    DEBUG_PHP_EXT_ERROR("Could not allocate memory for session data");
+    goto exit;
+
+set_error:
+    PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to set record");
+    DEBUG_PHP_EXT_ERROR("Unable to set record");
+
+exit:
+    return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to get the data stored in a bin of a session record by
+ * session_bin_set(), uncompressing it if required.
+ *
+ * @param value_p           The as_val of the bin.
+ * @param data_pp           The emalloc'd, NULL terminated data to be
+ *                          populated by this method.
+ * @param data_len_p        The length of the data to be populated by this
+ *                          method.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+session_bin_get(const as_val *value_p, char **data_pp, int *data_len_p,
+        as_error *error_p TSRMLS_DC)
+{
+    as_string*      string_p = NULL;
+    as_bytes*       bytes_p = NULL;
+    uint8_t*        buffer_p = NULL;
+    uint32_t        buffer_len = 0;
+    uLongf          data_len = 0;
+
+    if (NULL != (string_p = as_string_fromval(value_p))) {
+        *data_len_p = (int) as_string_len(string_p);
+        *data_pp = estrndup(as_string_get(string_p), *data_len_p);
+        goto exit;
+    }
+
+    if (NULL == (bytes_p = as_bytes_fromval(value_p)) ||
+            (buffer_len = as_bytes_size(bytes_p)) < AEROSPIKE_SESSION_BYTES_HEADER_SIZE) {
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                "Unable to get session bin of the record");
+        DEBUG_PHP_EXT_DEBUG("Unable to get session bin of the record");
+        goto exit;
+    }
+
+    buffer_p = as_bytes_get(bytes_p);
+    data_len = ((uLongf) buffer_p[1] << 24) | ((uLongf) buffer_p[2] << 16) |
+        ((uLongf) buffer_p[3] << 8) | (uLongf) buffer_p[4];
+
+    if (buffer_p[0] != AEROSPIKE_SESSION_BYTES_ZLIB &&
+            data_len > buffer_len - AEROSPIKE_SESSION_BYTES_HEADER_SIZE) {
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                "Unable to get session bin of the record");
+        DEBUG_PHP_EXT_DEBUG("Unable to get session bin of the record");
+        goto exit;
+    }
+
+    *data_pp = emalloc(data_len + 1);
+
+    if (buffer_p[0] == AEROSPIKE_SESSION_BYTES_ZLIB) {
+        if (Z_OK != uncompress((Bytef *) *data_pp, &data_len,
+                    buffer_p + AEROSPIKE_SESSION_BYTES_HEADER_SIZE,
+                    buffer_len - AEROSPIKE_SESSION_BYTES_HEADER_SIZE)) {
+            efree(*data_pp);
+            *data_pp = NULL;
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR,
+                    "Unable to uncompress session data");
+            DEBUG_PHP_EXT_ERROR("Unable to uncompress session data");
+            goto exit;
+        }
+    } else {
+        memcpy(*data_pp, buffer_p + AEROSPIKE_SESSION_BYTES_HEADER_SIZE, data_len);
+    }
+
+    (*data_pp)[data_len] = '\0';
+    *data_len_p = (int) data_len;
+
+exit:
+    return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to parse a "<len>:" length prefix of a serialized value.
+ *
+ * @param p                 The start of the length.
+ * @param end_p             The end of the serialized data.
+ * @param len_p             The length to be populated by this method.
+ *
+ * @return the position right after the ':' following the length, or NULL if
+ *         the length could not be parsed.
+ *******************************************************************************************************
+ */
+static const char *
+session_parse_serialized_len(const char *p, const char *end_p, long *len_p)
+{
+    long            len = 0;
+
+    if (p >= end_p || !isdigit(*p)) {
+        return NULL;
+    }
+    while (p < end_p && isdigit(*p)) {
+        len = len * 10 + (*p - '0');
+        if (len > INT_MAX) {
+            return NULL;
+        }
+        p++;
+    }
+    if (p >= end_p || *p != ':') {
+        return NULL;
+    }
+    *len_p = len;
+    return p + 1;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to skip a single value serialized by php_var_serialize(),
+ * without unserializing it so that no class is loaded and no __wakeup() is
+ * invoked.
+ *
+ * @param p                 The start of the serialized value.
+ * @param end_p             The end of the serialized data.
+ * @param depth             The nesting depth of the value.
+ * @param has_ref_p         Set to true by this method if the value contains
+ *                          a reference to another value.
+ *
+ * @return the position right after the value, or NULL if the data could not
+ *         be parsed.
+ *******************************************************************************************************
+ */
+static const char *
+session_skip_serialized(const char *p, const char *end_p, int depth,
+        bool *has_ref_p)
+{
+    char            type;
+    long            len = 0;
+    long            count = 0;
+
+    if (p + 2 > end_p || depth > AEROSPIKE_SESSION_SERIALIZED_MAX_DEPTH) {
+        return NULL;
+    }
+
+    type = *p;
+    if (type == 'N') {
+        return (p[1] == ';') ? p + 2 : NULL;
+    }
+    if (p[1] != ':') {
+        return NULL;
+    }
+    p += 2;
+
+    switch (type) {
+        case 'r':
+        case 'R':
+            *has_ref_p = true;
+            /* fall through */
+        case 'b':
+        case 'i':
+        case 'd':
+            p = memchr(p, ';', end_p - p);
+            return p ? p + 1 : NULL;
+        case 's':
+            if (NULL == (p = session_parse_serialized_len(p, end_p, &len)) ||
+                    end_p - p < len + 3 || p[0] != '"') {
+                return NULL;
+            }
+            p += 1 + len;
+            return (p[0] == '"' && p[1] == ';') ? p + 2 : NULL;
+        case 'O':
+        case 'C':
+            if (NULL == (p = session_parse_serialized_len(p, end_p, &len)) ||
+                    end_p - p < len + 3 || p[0] != '"') {
+                return NULL;
+            }
+            p += 1 + len;
+            if (p[0] != '"' || p[1] != ':') {
+                return NULL;
+            }
+            p += 2;
+            if (type == 'C') {
+                if (NULL == (p = session_parse_serialized_len(p, end_p, &len)) ||
+                        end_p - p < len + 2 || p[0] != '{' || p[len + 1] != '}') {
+                    return NULL;
+                }
+                return p + len + 2;
+            }
+            /* fall through */
+        case 'a':
+            if (NULL == (p = session_parse_serialized_len(p, end_p, &count)) ||
+                    p >= end_p || p[0] != '{') {
+                return NULL;
+            }
+            p++;
+            for (count *= 2; count > 0; count--) {
+                if (NULL == (p = session_skip_serialized(p, end_p, depth + 1, has_ref_p))) {
+                    return NULL;
+                }
+            }
+            return (p < end_p && p[0] == '}') ? p + 1 : NULL;
+        default:
+            return NULL;
+    }
+}
+
+/*
+ *******************************************************************************************************
+ * Function to build the name of a per-key bin from its index.
+ *
+ * @param bin_index         The index of the per-key bin.
+ * @param bin_name_p        The buffer of AS_BIN_NAME_MAX_SIZE bytes to be
+ *                          populated by this method.
+ *******************************************************************************************************
+ */
+static void
+session_key_bin_name(int bin_index, char *bin_name_p)
+{
+    snprintf(bin_name_p, AS_BIN_NAME_MAX_SIZE, "%s%d",
+            AEROSPIKE_SESSION_KEY_BIN_PREFIX, bin_index);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to split session data encoded by the php serialize handler into
+ * its top-level "name|serialized value" entries, and to compute the index of
+ * the per-key bin of each one from a hash of its name.
+ * Keys are spread over at most key_bins_max bins, so that the number of
+ * distinct bin names used by all sessions stays bounded however many
+ * different keys they hold.
+ * Data which cannot be split without changing its meaning, such as entries
+ * holding references to other values, is rejected.
+ *
+ * @param val_p             The encoded session data.
+ * @param vallen            The length of the encoded session data.
+ * @param key_bins_max      The number of per-key bins.
+ * @param entries_pp        The emalloc'd array of entries to be populated by
+ *                          this method if the data could be split.
+ * @param entries_count_p   The number of entries to be populated by this
+ *                          method.
+ *
+ * @return true if the data was split, else false.
+ *******************************************************************************************************
+ */
+static bool
+session_split_entries(const char *val_p, int vallen, int key_bins_max,
+        session_entry **entries_pp, int *entries_count_p)
+{
+    const char*     p = val_p;
+    const char*     end_p = val_p + vallen;
+    const char*     name_end_p = NULL;
+    bool            has_ref = false;
+    int             entries_size = 0;
+    unsigned char   digest[AEROSPIKE_SESSION_DIGEST_SIZE];
+
+    *entries_pp = NULL;
+    *entries_count_p = 0;
+
+    if (strcmp(SESSION_SERIALIZE_HANDLER_PHP_INI, "php")) {
+        goto reject;
+    }
+
+    while (p < end_p) {
+        if (*p == PS_UNDEF_MARKER ||
+                NULL == (name_end_p = memchr(p, PS_DELIMITER, end_p - p)) ||
+                NULL == (name_end_p = session_skip_serialized(name_end_p + 1,
+                        end_p, 0, &has_ref)) || has_ref) {
+            goto reject;
+        }
+
+        if (*entries_count_p == entries_size) {
+            entries_size = entries_size ? entries_size * 2 : 16;
+            *entries_pp = erealloc(*entries_pp, entries_size * sizeof(session_entry));
+        }
+
+        (*entries_pp)[*entries_count_p].entry_p = p;
+        (*entries_pp)[*entries_count_p].entry_len = name_end_p - p;
+        session_data_digest(p, (const char *) memchr(p, PS_DELIMITER, end_p - p) - p, digest);
+        (*entries_pp)[*entries_count_p].bin_index = (int) ((((uint32_t) digest[0] << 24) |
+                    ((uint32_t) digest[1] << 16) | ((uint32_t) digest[2] << 8) |
+                    (uint32_t) digest[3]) % (uint32_t) key_bins_max);
+        (*entries_count_p)++;
+        p = name_end_p;
+    }
+    return true;
+
+reject:
+    if (*entries_pp) {
+        efree(*entries_pp);
+        *entries_pp = NULL;
+    }
+    *entries_count_p = 0;
+    return false;
+}
+
+/*
+ *******************************************************************************************************
+ * Callback for as_record_foreach on a session record.
+ * Collects the per-key bins written in bin per key mode, remembering a
+ * digest of each so that unchanged keys are not rewritten, and appends their
+ * data to the session data being read.
+ *
+ * @param name_p            The name of the current bin.
+ * @param value_p           The as_val of the current bin.
+ * @param udata             The session_read_udata of the read.
+ *
+ * @return true to continue iterating, false on error.
+ *******************************************************************************************************
+ */
+static bool
+session_read_key_bin_callback(const char *name_p, const as_val *value_p,
+        void *udata)
+{
+    TSRMLS_FETCH();
+    session_read_udata*     read_udata_p = (session_read_udata *) udata;
+    aerospike_session*      session_p = read_udata_p->session_p;
+    char*                   data_p = NULL;
+    int                     data_len = 0;
+    unsigned char           digest[AEROSPIKE_SESSION_DIGEST_SIZE];
+
+    if (strncmp(name_p, AEROSPIKE_SESSION_KEY_BIN_PREFIX,
+                AEROSPIKE_SESSION_KEY_BIN_PREFIX_LEN)) {
+        return true;
+    }
+
+    if (AEROSPIKE_OK != session_bin_get(value_p, &data_p, &data_len,
+                read_udata_p->error_p TSRMLS_CC)) {
+        return false;
+    }
+
+    if (!session_p->key_bins_p) {
+        ALLOC_HASHTABLE(session_p->key_bins_p);
+        zend_hash_init(session_p->key_bins_p, 16, NULL, NULL, 0);
+    }
+    session_data_digest(data_p, data_len, digest);
+    zend_hash_update(session_p->key_bins_p, name_p, strlen(name_p) + 1,
+            digest, AEROSPIKE_SESSION_DIGEST_SIZE, NULL);
+
+    if (read_udata_p->data_p) {
+        smart_str_appendl(read_udata_p->data_p, data_p, data_len);
+    }
+    efree(data_p);
+    return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to set the bins of a session record to be written in bin per key
+ * mode. The entries are grouped into their per-key bins, only bins whose
+ * data changed since the session was read are set, bins left without
+ * entries are set to nil, and the single session bin is set to nil if the
+ * session was previously stored in it.
+ *
+ * @param session_p         The aerospike_session object being written.
+ * @param record_p          The as_record whose bins are to be set.
+ * @param entries_p         The entries of the session data.
+ * @param entries_count     The number of entries of the session data.
+ * @param key_bins_max      The number of per-key bins.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+session_set_key_bins(aerospike_session *session_p, as_record *record_p,
+        session_entry *entries_p, int entries_count, int key_bins_max,
+        as_error *error_p TSRMLS_DC)
+{
+    unsigned char           digest[AEROSPIKE_SESSION_DIGEST_SIZE];
+    unsigned char*          read_digest_p = NULL;
+    smart_str*              bins_data_p = NULL;
+    char                    key_bin_name[AS_BIN_NAME_MAX_SIZE];
+    HashPosition            pos;
+    char*                   bin_name_p = NULL;
+    uint                    bin_name_len = 0;
+    ulong                   index = 0;
+    int                     iter = 0;
+    bool                    is_present = false;
+
+    bins_data_p = ecalloc(key_bins_max, sizeof(smart_str));
+    for (iter = 0; iter < entries_count; iter++) {
+        smart_str_appendl(&bins_data_p[entries_p[iter].bin_index],
+                entries_p[iter].entry_p, entries_p[iter].entry_len);
+    }
+
+    for (iter = 0; iter < key_bins_max; iter++) {
+        if (!bins_data_p[iter].len) {
+            continue;
+        }
+        session_key_bin_name(iter, key_bin_name);
+        if (session_p->key_bins_p &&
+                SUCCESS == zend_hash_find(session_p->key_bins_p, key_bin_name,
+                    strlen(key_bin_name) + 1, (void **) &read_digest_p)) {
+            session_data_digest(bins_data_p[iter].c, bins_data_p[iter].len, digest);
+            if (!memcmp(digest, read_digest_p, AEROSPIKE_SESSION_DIGEST_SIZE)) {
+                continue;
+            }
+        }
+        if (AEROSPIKE_OK != session_bin_set(record_p, key_bin_name,
+                    bins_data_p[iter].c, bins_data_p[iter].len, error_p TSRMLS_CC)) {
+            goto exit;
+        }
+    }
+
+    if (session_p->key_bins_p) {
+        for (zend_hash_internal_pointer_reset_ex(session_p->key_bins_p, &pos);
+                HASH_KEY_IS_STRING == zend_hash_get_current_key_ex(session_p->key_bins_p,
+                    &bin_name_p, &bin_name_len, &index, 0, &pos);
+                zend_hash_move_forward_ex(session_p->key_bins_p, &pos)) {
+            is_present = false;
+            for (iter = 0; iter < key_bins_max && !is_present; iter++) {
+                if (bins_data_p[iter].len) {
+                    session_key_bin_name(iter, key_bin_name);
+                    is_present = !strcmp(bin_name_p, key_bin_name);
+                }
+            }
+            if (!is_present && !as_record_set_nil(record_p, bin_name_p)) {
+                PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to set record");
+                DEBUG_PHP_EXT_ERROR("Unable to set record");
+                goto exit;
+            }
+        }
+    }
+
+    if (session_p->has_session_bin &&
+            !as_record_set_nil(record_p, AEROSPIKE_SESSION_BIN)) {
+        PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to set record");
+        DEBUG_PHP_EXT_ERROR("Unable to set record");
+        goto exit;
+    }
+
+exit:
+    for (iter = 0; iter < key_bins_max; iter++) {
+        smart_str_free(&bins_data_p[iter]);
+    }
+    efree(bins_data_p);
+    return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to set the single session bin of a session record to be written,
+ * setting to nil any per-key bins previously written in bin per key mode.
+ *
+ * @param session_p         The aerospike_session object being written.
+ * @param record_p          The as_record whose bins are to be set.
+ * @param val_p             The encoded session data.
+ * @param vallen            The length of the encoded session data.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+session_set_session_bin(aerospike_session *session_p, as_record *record_p,
+        const char *val_p, int vallen, as_error *error_p TSRMLS_DC)
+{
+    HashPosition            pos;
+    char*                   bin_name_p = NULL;
+    uint                    bin_name_len = 0;
+    ulong                   index = 0;
+
+    if (AEROSPIKE_OK != session_bin_set(record_p, AEROSPIKE_SESSION_BIN,
+                val_p, vallen, error_p TSRMLS_CC)) {
+        goto exit;
+    }
+
+    if (session_p->key_bins_p) {
+        for (zend_hash_internal_pointer_reset_ex(session_p->key_bins_p, &pos);
+                HASH_KEY_IS_STRING == zend_hash_get_current_key_ex(session_p->key_bins_p,
+                    &bin_name_p, &bin_name_len, &index, 0, &pos);
+                zend_hash_move_forward_ex(session_p->key_bins_p, &pos)) {
+            if (!as_record_set_nil(record_p, bin_name_p)) {
+                PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to set record");
+                DEBUG_PHP_EXT_ERROR("Unable to set record");
+                goto exit;
+            }
+        }
+    }
+
+exit:
+    return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to touch a session record, extending its ttl to the value of
+ * session.cache_expire without rewriting it.
+ *
+ * @param session_p         The aerospike_session object to be touched.
+ * @param key_p             The as_key of the session record.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+session_touch(aerospike_session *session_p, as_key *key_p, as_error *error_p TSRMLS_DC)
+{
+    as_operations       ops;
+
+    as_operations_inita(&ops, 1);
+    as_operations_add_touch(&ops);
+    ops.ttl = CACHE_EXPIRE_PHP_INI;
+    if (AEROSPIKE_OK != aerospike_key_operate(session_p->aerospike_obj_p->as_ref_p->as_p,
+                error_p, NULL, key_p, &ops, NULL) &&
+            AEROSPIKE_ERR_RECORD_NOT_FOUND != error_p->code) {
+        DEBUG_PHP_EXT_ERROR("Unable to touch session data");
+    }
+    as_operations_destroy(&ops);
+    return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to acquire the lock of a session.
+ * The lock is a separate record with PK==session_id.lock, created only if it
+ * does not exist and expiring after aerospike.session.lock_ttl seconds so that
+ * a crashed request cannot hold it forever. Its bin holds a token made of the
+ * pid and a random number, so that only the owner releases it. While another
+ * request holds the
+ * lock, this method retries with an exponential backoff for up to
+ * aerospike.session.lock_wait milliseconds.
+ *
+ * @param session_p         The aerospike_session object to be locked.
+ * @param key_p             The session id.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+acquire_session_lock(aerospike_session *session_p, const char *key_p,
+        as_error *error_p TSRMLS_DC)
+{
+    as_policy_write     write_policy;
+    as_key              lock_key;
+    as_record           record;
+    long                max_wait_usec = (SESSION_LOCK_WAIT_PHP_INI) * 1000;
+    long                waited_usec = 0;
+    useconds_t          backoff_usec = AEROSPIKE_SESSION_LOCK_MIN_BACKOFF_USEC;
+
+    as_error_init(error_p);
+
+    spprintf(&session_p->lock_key_p, 0, "%s%s", key_p, AEROSPIKE_SESSION_LOCK_SUFFIX);
+    as_key_init_str(&lock_key, session_p->ns_p, session_p->set_p, session_p->lock_key_p);
+    session_p->lock_owner = ((int64_t) getpid() << 32) | (uint32_t) php_rand(TSRMLS_C);
+
+    as_policy_write_init(&write_policy);
+    write_policy.exists = AS_POLICY_EXISTS_CREATE;
+
+    as_record_inita(&record, 1);
+    as_record_set_int64(&record, AEROSPIKE_SESSION_LOCK_BIN, session_p->lock_owner);
+    record.ttl = SESSION_LOCK_TTL_PHP_INI;
+
+    while (AEROSPIKE_ERR_RECORD_EXISTS ==
+            aerospike_key_put(session_p->aerospike_obj_p->as_ref_p->as_p,
+                error_p, &write_policy, &lock_key, &record)) {
+        if (waited_usec >= max_wait_usec) {
+            PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_TIMEOUT,
+                    "Timed out waiting for session lock");
+            DEBUG_PHP_EXT_WARNING("Timed out waiting for session lock");
+            break;
+        }
+        usleep(backoff_usec);
+        waited_usec += backoff_usec;
+        if (backoff_usec < AEROSPIKE_SESSION_LOCK_MAX_BACKOFF_USEC) {
+            backoff_usec *= 2;
+        }
+    }
+
+    if (error_p->code != AEROSPIKE_OK) {
+        DEBUG_PHP_EXT_ERROR("Unable to acquire session lock");
+        efree(session_p->lock_key_p);
+        session_p->lock_key_p = NULL;
+    }
+
+    as_record_destroy(&record);
+    as_key_destroy(&lock_key);
+    return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to release the lock of a session, if held.
+ * The lock record is removed only if its token is the one written by this
+ * request, and with the generation read along with it, so that a request
+ * whose lock expired cannot release the lock since taken by another one.
+ * A lock which has already expired or changed owner is not treated as an
+ * error.
+ *
+ * @param session_p         The aerospike_session object to be unlocked.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+release_session_lock(aerospike_session *session_p, as_error *error_p TSRMLS_DC)
+{
+    as_key              lock_key;
+    as_policy_remove    remove_policy;
+    as_record*          record_p = NULL;
+    const char*         bins[] = {AEROSPIKE_SESSION_LOCK_BIN, NULL};
+
+    as_error_init(error_p);
+
+    if (!session_p || !session_p->lock_key_p) {
+        goto exit;
+    }
+
+    as_key_init_str(&lock_key, session_p->ns_p, session_p->set_p, session_p->lock_key_p);
+    if (AEROSPIKE_OK != aerospike_key_select(session_p->aerospike_obj_p->as_ref_p->as_p,
+                error_p, NULL, &lock_key, bins, &record_p)) {
+        if (error_p->code == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+            as_error_init(error_p);
+        } else {
+            DEBUG_PHP_EXT_ERROR("Unable to read session lock");
+        }
+    } else if (as_record_get_int64(record_p, AEROSPIKE_SESSION_LOCK_BIN, 0) !=
+            session_p->lock_owner) {
+        DEBUG_PHP_EXT_WARNING("Session lock expired and taken by another request");
+    } else {
+        as_policy_remove_init(&remove_policy);
+        remove_policy.gen = AS_POLICY_GEN_EQ;
+        remove_policy.generation = record_p->gen;
+        if (AEROSPIKE_OK != aerospike_key_remove(session_p->aerospike_obj_p->as_ref_p->as_p,
+                    error_p, &remove_policy, &lock_key)) {
+            if (error_p->code == AEROSPIKE_ERR_RECORD_NOT_FOUND ||
+                    error_p->code == AEROSPIKE_ERR_RECORD_GENERATION) {
+                as_error_init(error_p);
+            } else {
+                DEBUG_PHP_EXT_ERROR("Unable to release session lock");
+            }
+        }
+    }
+    if (record_p) {
+        as_record_destroy(record_p);
+    }
+    as_key_destroy(&lock_key);
+
+    efree(session_p->lock_key_p);
+    session_p->lock_key_p = NULL;
+
+exit:
+    return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to set up a session object from the save path cache.
+ * The save path parsed by the last successful PS_OPEN, along with the
+ * persistent aerospike_ref it resolved to, is cached in the module globals,
+ * so subsequent requests with the same save path neither re-parse it nor
+ * look up the persistent list.
+ *
+ * @param session_p         The aerospike_session object to be set up.
+ * @param save_path         The session save path of the current request.
+ *
+ * @return true if the session was set up from the cache, else false.
+ *******************************************************************************************************
+ */
+static bool
+session_from_save_path_cache(aerospike_session *session_p,
+        const char *save_path TSRMLS_DC)
+{
+    if (!save_path || !AEROSPIKE_G(session_save_path_g) ||
+            !AEROSPIKE_G(session_as_ref_g) ||
+            strcmp(save_path, AEROSPIKE_G(session_save_path_g))) {
+        return false;
+    }
+
+    strcpy(session_p->ns_p, AEROSPIKE_G(session_ns_g));
+    strcpy(session_p->set_p, AEROSPIKE_G(session_set_g));
+    session_p->aerospike_obj_p->as_ref_p = AEROSPIKE_G(session_as_ref_g);
+    session_p->aerospike_obj_p->as_ref_p->ref_as_p++;
+    session_p->aerospike_obj_p->is_conn_16 = AEROSPIKE_CONN_STATE_TRUE;
+    return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to cache the parsed save path and the connected aerospike_ref of
+ * a session object for reuse by subsequent requests.
+ *
+ * @param session_p         The connected aerospike_session object.
+ * @param save_path         The session save path of the current request.
+ *******************************************************************************************************
+ */
+static void
+session_update_save_path_cache(aerospike_session *session_p,
+        const char *save_path TSRMLS_DC)
+{
+    if (!save_path) {
+        return;
+    }
+
+    if (AEROSPIKE_G(session_save_path_g)) {
+        pefree(AEROSPIKE_G(session_save_path_g), 1);
+    }
+    AEROSPIKE_G(session_save_path_g) = pestrdup(save_path, 1);
+    strcpy(AEROSPIKE_G(session_ns_g), session_p->ns_p);
+    strcpy(AEROSPIKE_G(session_set_g), session_p->set_p);
+    AEROSPIKE_G(session_as_ref_g) = session_p->aerospike_obj_p->as_ref_p;
+}
+
 /*
  *******************************************************************************************************
  * PHP Exposed-Function to open an Aerospike PHP Session.
@@ -134,6 +1016,8 @@ destroy_session(aerospike_session *session_p TSRMLS_DC)
  * specified in session.save_path only if session.save_handler is set to
  * "aerospike". The internal C SDK aerospike object is fetched/hashed into the
  * Aerospike extension's Persistent List.
+ * If the save path is the same as the one of a previous request, the cached
+ * namespace, set and aerospike object are reused instead.
  *
  * Invoked on calling session_start() from PHP userland.
  * @return SUCCESS or FAILURE.
@@ -161,6 +1045,11 @@ PS_OPEN_FUNC(aerospike)
         goto exit;
     }
 
+    if (session_from_save_path_cache(session_p, save_path TSRMLS_CC)) {
+        DEBUG_PHP_EXT_INFO("Reusing cached php-aerospike session object");
+        goto exit;
+    }
+
     if (AEROSPIKE_OK !=
             aerospike_helper_check_and_set_config_for_session(&config,
                 (char *) save_path, session_p, &error TSRMLS_CC)) {
@@ -199,6 +1088,8 @@ PS_OPEN_FUNC(aerospike)
     /* connection is established, set the connection flag now */
     session_p->aerospike_obj_p->is_conn_16 = AEROSPIKE_CONN_STATE_TRUE;
 
+    session_update_save_path_cache(session_p, save_path TSRMLS_CC);
+
     DEBUG_PHP_EXT_INFO("Success in creating php-aerospike object");
 exit:
     if (error.code == AEROSPIKE_OK) {
@@ -231,6 +1122,10 @@ PS_CLOSE_FUNC(aerospike)
     DEBUG_PHP_EXT_INFO("In PS_CLOSE_FUNC");
     as_error_init(&error);
 
+    if (session_p && session_p->aerospike_obj_p && session_p->lock_key_p) {
+        release_session_lock(session_p, &error TSRMLS_CC);
+    }
+
     if (AEROSPIKE_OK != aerospike_helper_close_php_connection(session_p->aerospike_obj_p,
                     &error TSRMLS_CC)) {
         DEBUG_PHP_EXT_ERROR("Aerospike close returned error");
@@ -249,6 +1144,11 @@ exit:
  * Fetches record in the aerospike server with PK==session_id.
  * Populates the session object with contents of a bin named "PHP_SESSION".
  *
+ * If aerospike.session.skip_read_new_id is set, a session whose id was just
+ * created by this handler is known not to exist and is not fetched from the
+ * server. The read of an existing session cannot be deferred until $_SESSION
+ * is used, as PHP 5 decodes the session data within session_start().
+ *
  * Invoked on calling session_start() from PHP userland.
  * @return SUCCESS or FAILURE.
  *******************************************************************************************************
@@ -260,7 +1160,9 @@ PS_READ_FUNC(aerospike)
     as_record*          record_p = NULL;
     as_key              key_get;
     int16_t             init_key = 0;
-    char*               session_data_p = NULL;
+    const as_val*       session_bin_p = NULL;
+    smart_str           key_bins_data = {0};
+    session_read_udata  read_udata;
 
     DEBUG_PHP_EXT_INFO("In PS_READ_FUNC");
 
@@ -268,6 +1170,18 @@ PS_READ_FUNC(aerospike)
        goto exit; 
     }
 
+    if ((SESSION_LOCK_PHP_INI) && !session_p->lock_key_p &&
+            AEROSPIKE_OK != acquire_session_lock(session_p, key, &error TSRMLS_CC)) {
+        goto exit;
+    }
+
+    if (session_p->created_sid_p && !strcmp(session_p->created_sid_p, key)) {
+        DEBUG_PHP_EXT_DEBUG("Skipping read of newly created session");
+        *val = estrndup("", 0);
+        *vallen = 0;
+        goto exit;
+    }
+
     as_key_init_str(&key_get, session_p->ns_p, session_p->set_p, key);
     init_key = 1;
 
@@ -277,17 +1191,46 @@ PS_READ_FUNC(aerospike)
         goto exit;
     }
 
-    if (NULL == (session_data_p = as_record_get_str(record_p, AEROSPIKE_SESSION_BIN))) {
+    /*
+     * The session is stored either in the single session bin or, in bin per
+     * key mode, in one bin per top-level key. Per-key bins are collected in
+     * both cases so that switching modes removes the stale ones.
+     */
+    session_bin_p = (const as_val *) as_record_get(record_p, AEROSPIKE_SESSION_BIN);
+    session_p->has_session_bin = (session_bin_p != NULL);
+
+    read_udata.session_p = session_p;
+    read_udata.data_p = session_bin_p ? NULL : &key_bins_data;
+    read_udata.error_p = &error;
+    if (!as_record_foreach(record_p, session_read_key_bin_callback, &read_udata) &&
+            AEROSPIKE_OK != error.code) {
+        goto exit;
+    }
+
+    if (session_bin_p) {
+        if (AEROSPIKE_OK != session_bin_get(session_bin_p, val, vallen, &error TSRMLS_CC)) {
+            goto exit;
+        }
+    } else if (session_p->key_bins_p) {
+        smart_str_0(&key_bins_data);
+        *val = key_bins_data.c ? key_bins_data.c : estrndup("", 0);
+        *vallen = key_bins_data.len;
+        key_bins_data.c = NULL;
+    } else {
          PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR,
                     "Unable to get session bin of the record");
          DEBUG_PHP_EXT_DEBUG("Unable to get session bin of the record");
          goto exit;
     }
 
-    *val = estrndup(session_data_p, strlen(session_data_p));
-    *vallen = strlen(session_data_p);
+    session_data_digest(*val, *vallen, session_p->read_digest);
+    session_p->is_read_digest_set = true;
 
 exit:
+    smart_str_free(&key_bins_data);
+    if (record_p) {
+        as_record_destroy(record_p);
+    }
     if (init_key) {
         as_key_destroy(&key_get);
     }
@@ -301,6 +1244,8 @@ exit:
  * server.
  * Writes a record in the aerospike server with PK==session_id with a bin named "PHP_SESSION"
  * containing all the session object contents.
+ * If the session data is unchanged since it was read, the record is only
+ * touched to extend its ttl instead of being rewritten.
  *
  * Invoked on calling session_write_close() from PHP userland.
  * @return SUCCESS or FAILURE.
@@ -312,8 +1257,13 @@ PS_WRITE_FUNC(aerospike)
     aerospike_session*  session_p = PS_GET_MOD_DATA();
     as_key              key_put;
     as_record           record;
+    unsigned char       write_digest[AEROSPIKE_SESSION_DIGEST_SIZE];
     int16_t             init_key = 0;
     int16_t             init_record = 0;
+    session_entry*      entries_p = NULL;
+    int                 entries_count = 0;
+    int                 key_bins_count = 0;
+    long                key_bins_max = SESSION_BIN_PER_KEY_MAX_PHP_INI;
 
     DEBUG_PHP_EXT_INFO("In PS_WRITE_FUNC");
 
@@ -335,11 +1285,54 @@ PS_WRITE_FUNC(aerospike)
     as_key_init_str(&key_put, session_p->ns_p, session_p->set_p, key);
     init_key = 1;
 
-    as_record_inita(&record, 1);
-    init_record = 1;
-    if (!as_record_set_str(&record, AEROSPIKE_SESSION_BIN, val)) {
-        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLIENT, "Unable to set record");
-        DEBUG_PHP_EXT_ERROR("Unable to set record");
+    session_data_digest(val, vallen, write_digest);
+    if (session_p->is_read_digest_set &&
+            !memcmp(write_digest, session_p->read_digest, AEROSPIKE_SESSION_DIGEST_SIZE)) {
+        if (AEROSPIKE_ERR_RECORD_NOT_FOUND != session_touch(session_p, &key_put, &error TSRMLS_CC)) {
+            goto exit;
+        }
+        /*
+         * The record expired or was removed since it was read, fall back to
+         * writing it in full.
+         */
+        as_error_init(&error);
+        session_p->is_read_digest_set = false;
+        if (session_p->key_bins_p) {
+            zend_hash_clean(session_p->key_bins_p);
+        }
+        session_p->has_session_bin = false;
+    }
+
+    if (session_p->key_bins_p) {
+        key_bins_count = zend_hash_num_elements(session_p->key_bins_p);
+    }
+
+    if (key_bins_max < 1) {
+        key_bins_max = 1;
+    }
+
+    if ((SESSION_BIN_PER_KEY_PHP_INI) &&
+            session_split_entries(val, vallen, key_bins_max, &entries_p, &entries_count)) {
+        as_record_inita(&record, entries_count + key_bins_count + 1);
+        init_record = 1;
+        if (AEROSPIKE_OK != session_set_key_bins(session_p, &record, entries_p,
+                    entries_count, key_bins_max, &error TSRMLS_CC)) {
+            goto exit;
+        }
+    } else {
+        as_record_inita(&record, key_bins_count + 1);
+        init_record = 1;
+        if (AEROSPIKE_OK != session_set_session_bin(session_p, &record, val,
+                    vallen, &error TSRMLS_CC)) {
+            goto exit;
+        }
+    }
+
+    if (record.bins.size == 0) {
+        /*
+         * Only the order of the keys changed, no bin needs to be written.
+         */
+        session_touch(session_p, &key_put, &error TSRMLS_CC);
         goto exit;
     }
 
@@ -347,9 +1340,16 @@ PS_WRITE_FUNC(aerospike)
     if (AEROSPIKE_OK != aerospike_key_put(session_p->aerospike_obj_p->as_ref_p->as_p,
                                         &error, NULL, &key_put, &record)) {
         DEBUG_PHP_EXT_ERROR("Unable to save session data");
+        goto exit;
     }
 
+    memcpy(session_p->read_digest, write_digest, AEROSPIKE_SESSION_DIGEST_SIZE);
+    session_p->is_read_digest_set = true;
+
 exit:
+    if (entries_p) {
+        efree(entries_p);
+    }
     if (init_record) {
         as_record_destroy(&record);
     }
@@ -392,6 +1392,8 @@ PS_DESTROY_FUNC(aerospike)
         goto exit;
     }
 
+    release_session_lock(session_p, &error TSRMLS_CC);
+
 exit:
     if (init_key) {
         as_key_destroy(&key_remove);
@@ -412,3 +1414,32 @@ PS_GC_FUNC(aerospike)
     return SUCCESS;
 }
 
+/*
+ *******************************************************************************************************
+ * PHP Exposed-Function to create a new session id.
+ * Uses the default session id generator. If
+ * aerospike.session.skip_read_new_id is set, the id is remembered so that PS_READ can skip fetching the record of
+ * a session created within this request.
+ *
+ * Invoked on calling session_start() without a session id from PHP userland.
+ * @return the new session id.
+ *******************************************************************************************************
+ */
+PS_CREATE_SID_FUNC(aerospike)
+{
+    aerospike_session*  session_p = PS_GET_MOD_DATA();
+    char*               sid_p = NULL;
+
+    DEBUG_PHP_EXT_INFO("In PS_CREATE_SID_FUNC");
+
+    sid_p = php_session_create_id(mod_data, newlen TSRMLS_CC);
+
+    if ((SESSION_SKIP_READ_NEW_ID_PHP_INI) && session_p && sid_p) {
+        if (session_p->created_sid_p) {
+            efree(session_p->created_sid_p);
+        }
+        session_p->created_sid_p = estrdup(sid_p);
+    }
+
+    return sid_p;
+}
@@ -2719,6 +2719,133 @@ exit:
     return status;
 }
 
+/*
+ *******************************************************************************************************
+ * Checks whether the key passed by the user is an Aerospike\Key object
+ * prepared by Aerospike::prepareKey().
+ *
+ * @param key_record_p              The key passed by the user.
+ *
+ * @return true if key_record_p is a prepared key. Otherwise false.
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_transform_is_key_object(zval* key_record_p TSRMLS_DC)
+{
+    Aerospike_key_object*   key_obj_p = NULL;
+
+    if ((!key_record_p) || (Z_TYPE_P(key_record_p) != IS_OBJECT) ||
+            !instanceof_function(Z_OBJCE_P(key_record_p), Aerospike_key_ce TSRMLS_CC)) {
+        return false;
+    }
+    key_obj_p = (Aerospike_key_object *) zend_object_store_get_object(key_record_p TSRMLS_CC);
+    return (key_obj_p && key_obj_p->key.ns[0] != '\0');
+}
+
+/*
+ *******************************************************************************************************
+ * Check and set the as_key for the record to be read/written from/to Aerospike,
+ * from either a key array or an Aerospike\Key object.
+ * The as_key of a prepared key is copied with its digest already computed,
+ * and borrows its string value, so that destroying the copy is harmless.
+ *
+ * @param key_record_p              The key passed by the user.
+ * @param as_key_p                  The C client's as_key to be set.
+ * @param set_val_p                 The flag to be set if as_key is allocated memory
+ *                                  so that it can be destroyed by calling function if set.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_transform_get_rec_key(zval* key_record_p, as_key* as_key_p,
+        int16_t* set_val_p TSRMLS_DC)
+{
+    as_status               status = AEROSPIKE_OK;
+    Aerospike_key_object*   key_obj_p = NULL;
+
+    if ((!key_record_p) || (!as_key_p) || (!set_val_p)) {
+        status = AEROSPIKE_ERR;
+        goto exit;
+    }
+
+    if (PHP_TYPE_ISARR(key_record_p)) {
+        status = aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_record_p),
+                as_key_p, set_val_p);
+        goto exit;
+    }
+
+    if (!aerospike_transform_is_key_object(key_record_p TSRMLS_CC)) {
+        status = AEROSPIKE_ERR_PARAM;
+        goto exit;
+    }
+
+    key_obj_p = (Aerospike_key_object *) zend_object_store_get_object(key_record_p TSRMLS_CC);
+    memcpy(as_key_p, &key_obj_p->key, sizeof(as_key));
+    if (key_obj_p->key.valuep) {
+        as_key_p->valuep = &as_key_p->value;
+        if (AS_STRING == as_val_type((as_val *) key_obj_p->key.valuep)) {
+            as_string_init(&as_key_p->value.string,
+                    as_string_get(&key_obj_p->key.value.string), false);
+        }
+    }
+    *set_val_p = 1;
+
+exit:
+    return status;
+}
+
+/*
+ *******************************************************************************************************
+ * Initializes the as_key of an Aerospike\Key object and computes its digest.
+ * A string key value is copied, as the key outlives the zval it came from.
+ *
+ * @param as_key_p                  The C client's as_key to be set.
+ * @param ns_p                      The namespace name for the record.
+ * @param ns_p_length               The length of the namespace name.
+ * @param set_p                     The set name for the record.
+ * @param set_p_length              The length of the set name.
+ * @param pk_p                      The primary key or digest of the record.
+ * @param is_digest                 The flag which indicates whether pk_p
+ *                                  is primary key or digest.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_transform_init_key_object(as_key* as_key_p, char* ns_p,
+        int ns_p_length, char* set_p, int set_p_length, zval* pk_p,
+        bool is_digest)
+{
+    as_status       status = AEROSPIKE_OK;
+
+    if ((!as_key_p) || (!ns_p) || (!set_p) || (!pk_p) ||
+            (ns_p_length >= AS_NAMESPACE_MAX_SIZE) ||
+            (set_p_length >= AS_SET_MAX_SIZE)) {
+        status = AEROSPIKE_ERR_PARAM;
+        goto exit;
+    }
+
+    if (AEROSPIKE_OK != (status = aerospike_add_key_params(as_key_p,
+                    Z_TYPE_P(pk_p), ns_p, set_p, &pk_p, is_digest))) {
+        goto exit;
+    }
+
+    if ((!is_digest) && PHP_TYPE_ISSTR(pk_p)) {
+        as_key_init_strp(as_key_p, ns_p, set_p, strdup(Z_STRVAL_P(pk_p)), true);
+    }
+
+    if (!as_key_digest(as_key_p)) {
+        as_key_destroy(as_key_p);
+        memset(as_key_p, 0, sizeof(as_key));
+        status = AEROSPIKE_ERR;
+        goto exit;
+    }
+
+exit:
+    return status;
+}
+
 /* 
  *******************************************************************************************************
  * Iterate over the input PHP record array and translate it to corresponding C
@@ -2786,6 +2913,9 @@ aerospike_transform_key_data_put(aerospike* as_object_p,
     as_record                   record;
     int16_t                     init_record = 0;
     uint16_t                    gen_value = 0;
+    uint64_t                    started_at = 0;
+    uint64_t                    marshal_at = 0;
+    aerospike_call_trace        trace;
 
     if ((!record_pp) || (!as_key_p) || (!error_p) || (!as_object_p)) {
         DEBUG_PHP_EXT_DEBUG("Unable to put record");
@@ -2809,6 +2939,7 @@ aerospike_transform_key_data_put(aerospike* as_object_p,
         goto exit;
     }
 
+    marshal_at = aerospike_latency_now();
     aerospike_transform_iterate_records(record_pp, &record, &static_pool,
             serializer_policy, error_p TSRMLS_CC);
     if (AEROSPIKE_OK != (error_p->code)) {
@@ -2818,7 +2949,18 @@ aerospike_transform_key_data_put(aerospike* as_object_p,
 
     record.gen = gen_value;
     record.ttl = ttl_u32;
+    started_at = aerospike_latency_now();
     aerospike_key_put(as_object_p, error_p, &write_policy, as_key_p, &record);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_PUT, as_key_p, started_at);
+
+    if (aerospike_call_trace_is_enabled(TSRMLS_C)) {
+        aerospike_call_trace_init(&trace, AEROSPIKE_LATENCY_PUT, as_key_p);
+        trace.status = error_p->code;
+        trace.marshal_us = started_at - marshal_at;
+        trace.network_us = aerospike_latency_now() - started_at;
+        trace.sent_record_p = &record;
+        aerospike_call_trace_add(as_object_p, &trace TSRMLS_CC);
+    }
 
 exit:
     /* clean up the as_* objects that were initialised */
@@ -2863,6 +3005,7 @@ aerospike_transform_filter_bins_exists(aerospike *as_object_p,
     const char          *select[bins_count];
     HashPosition        pointer;
     zval                **bin_names;
+    uint64_t            started_at = 0;
     
     foreach_hashtable (bins_array_p, pointer, bin_names) {
         switch (Z_TYPE_PP(bin_names)) {
@@ -2876,15 +3019,44 @@ aerospike_transform_filter_bins_exists(aerospike *as_object_p,
     }
     
     select[bins_count] = NULL;
-    if (AEROSPIKE_OK != (status =
-                aerospike_key_select(as_object_p, error_p, read_policy_p,
-                        get_rec_key_p, select, get_record_p))) {
-        goto exit;
-    }
+    started_at = aerospike_latency_now();
+    status = aerospike_key_select(as_object_p, error_p, read_policy_p,
+            get_rec_key_p, select, get_record_p);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_GET, get_rec_key_p, started_at);
 exit:
     return status;
 }
 
+/*
+ *******************************************************************************************************
+ * Reads a whole record, recording the latency of the read.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param read_policy_p             The C client's as_policy_read to be used.
+ * @param get_rec_key_p             The C client's as_key that identifies the
+ *                                  record to be read.
+ * @param get_record_p              The C client's as_record to be read into.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+aerospike_transform_key_get(aerospike *as_object_p,
+                            as_error *error_p,
+                            as_policy_read *read_policy_p,
+                            as_key *get_rec_key_p,
+                            as_record **get_record_p)
+{
+    as_status           status = AEROSPIKE_OK;
+    uint64_t            started_at = aerospike_latency_now();
+
+    status = aerospike_key_get(as_object_p, error_p, read_policy_p,
+            get_rec_key_p, get_record_p);
+    aerospike_latency_record(as_object_p, AEROSPIKE_LATENCY_GET, get_rec_key_p, started_at);
+    return status;
+}
+
 /*
  *******************************************************************************************************
  * Function that returns no. of digits of a positive integer.
@@ -3002,7 +3174,8 @@ aerospike_init_php_key(char *ns_p, long ns_p_length, char *set_p,
              * Optionally NOT NULL in case of get().
              * Always NULL in case of scan().
              */
-            zend_hash_index_find(Z_ARRVAL_P(options_p), OPT_POLICY_KEY, (void **) &key_policy_pp);
+            zend_hash_index_find(Z_ARRVAL_P(aerospike_policy_get_options(options_p TSRMLS_CC)),
+                    OPT_POLICY_KEY, (void **) &key_policy_pp);
         }
 
         if ((!record_key_p->valuep) || (get_flag && ((!key_policy_pp) || (key_policy_pp &&
@@ -3248,9 +3421,18 @@ aerospike_transform_get_record(Aerospike_object* aerospike_obj_p,
     as_status               status = AEROSPIKE_OK;
     as_policy_read          read_policy;
     as_record               *get_record = NULL;
+    as_record               *cached_record = NULL;
+    as_record               cached_record_view;
+    as_record               *read_record = NULL;
+    uint32_t                cached_ttl = 0;
+    uint32_t                cache_token = 0;
+    bool                    use_cache = false;
     aerospike               *as_object_p = aerospike_obj_p->as_ref_p->as_p;
     foreach_callback_udata  foreach_record_callback_udata;
     zval*                   get_record_p = NULL;
+    uint64_t                read_at = 0;
+    uint64_t                unmarshal_at = 0;
+    aerospike_call_trace    trace;
 
     ALLOC_INIT_ZVAL(get_record_p);
     array_init(get_record_p);
@@ -3271,22 +3453,43 @@ aerospike_transform_get_record(Aerospike_object* aerospike_obj_p,
         goto exit;
     }
 
-    if (bins_p != NULL && (AEROSPIKE_OK != (status =
+    /*
+     * Reads of whole records with OPT_READ_CACHE are served from the read
+     * cache when it holds a valid copy, the ttl being that remaining.
+     */
+    use_cache = (bins_p == NULL) && aerospike_record_cache_is_enabled(options_p TSRMLS_CC);
+    read_at = aerospike_latency_now();
+    if (use_cache && (cached_record = aerospike_record_cache_get(
+                    &aerospike_obj_p->as_ref_p->record_cache, as_object_p,
+                    &read_policy, get_rec_key_p, &cached_ttl, &cache_token TSRMLS_CC))) {
+        memcpy(&cached_record_view, cached_record, sizeof(as_record));
+        cached_record_view.ttl = cached_ttl;
+        read_record = &cached_record_view;
+    } else if (bins_p != NULL && (AEROSPIKE_OK != (status =
                     aerospike_transform_filter_bins_exists(as_object_p,
                             Z_ARRVAL_P(bins_p), &get_record, error_p,
                                     get_rec_key_p, &read_policy)))) {
         goto exit;
-    } else if (AEROSPIKE_OK != (status = aerospike_key_get(as_object_p, error_p,
+    } else if (bins_p == NULL && AEROSPIKE_OK != (status = aerospike_transform_key_get(as_object_p, error_p,
                     &read_policy, get_rec_key_p, &get_record))) {
         goto exit;
+    } else {
+        read_record = get_record;
+        if (use_cache) {
+            aerospike_record_cache_put(&aerospike_obj_p->as_ref_p->record_cache,
+                    get_rec_key_p, get_record, READ_CACHE_MAX_MEMORY_PHP_INI,
+                    cache_token TSRMLS_CC);
+        }
     }
-    if (!as_record_foreach(get_record, (as_rec_foreach_callback) AS_DEFAULT_GET,
+
+    unmarshal_at = aerospike_latency_now();
+    if (!as_record_foreach(read_record, (as_rec_foreach_callback) AS_DEFAULT_GET,
                 &foreach_record_callback_udata)) {
         status = AEROSPIKE_ERR_SERVER;
         goto exit;
     }
 
-    if (AEROSPIKE_OK != (status = aerospike_get_key_meta_bins_of_record(get_record, get_rec_key_p, outer_container_p, options_p, true TSRMLS_CC))) {
+    if (AEROSPIKE_OK != (status = aerospike_get_key_meta_bins_of_record(read_record, get_rec_key_p, outer_container_p, options_p, true TSRMLS_CC))) {
         DEBUG_PHP_EXT_DEBUG("Unable to get record key and metadata");
         status = AEROSPIKE_ERR;
         goto exit;
@@ -3299,10 +3502,33 @@ aerospike_transform_get_record(Aerospike_object* aerospike_obj_p,
     }
 
 exit:
+    /*
+     * A read served by the read cache is traced with no network time nor
+     * bytes received.
+     */
+    if (read_at && aerospike_call_trace_is_enabled(TSRMLS_C)) {
+        aerospike_call_trace_init(&trace, AEROSPIKE_LATENCY_GET, get_rec_key_p);
+        trace.status = status;
+        if (unmarshal_at) {
+            trace.unmarshal_us = aerospike_latency_now() - unmarshal_at;
+        } else {
+            unmarshal_at = aerospike_latency_now();
+        }
+        if (read_record != &cached_record_view) {
+            trace.network_us = unmarshal_at - read_at;
+            trace.received_record_p = get_record;
+        }
+        aerospike_call_trace_add(as_object_p, &trace TSRMLS_CC);
+    }
+
     if (get_record) {
         as_record_destroy(get_record);
     }
 
+    if (cached_record) {
+        as_record_destroy(cached_record);
+    }
+
     if (AEROSPIKE_OK != status) {
         if (get_record_p) {
             zval_ptr_dtor(&get_record_p);
@@ -9,6 +9,149 @@
 #include "aerospike/as_udf.h"
 #include "aerospike/aerospike_udf.h"
 #include "aerospike_policy.h"
+#include "ext/standard/sha1.h"
+
+#define UDF_LIST_FILENAME "filename"
+#define UDF_LIST_HASH "hash"
+
+/*
+ ******************************************************************************************************
+ * A UDF module looked up by its name and content hash in the entries of an
+ * udf-list info response.
+ ******************************************************************************************************
+ */
+typedef struct udf_module_match_t {
+    const char*     module_p;
+    const char*     hash_p;
+} udf_module_match;
+
+/*
+ ******************************************************************************************************
+ Compares the content hash of a UDF module listed by a node with an expected
+ one. The nodes list the hex encoded hash in either case.
+ *
+ * @param hash_p                    The listed hash, not necessarily NULL terminated.
+ * @param hash_len                  The length of the listed hash.
+ * @param expected_p                The expected hex encoded SHA1 hash.
+ *
+ * @return true if the hashes are equal.
+ ******************************************************************************************************
+ */
+static bool
+aerospike_udf_hash_equals(const char* hash_p, size_t hash_len, const char* expected_p)
+{
+    return (hash_len == strlen(expected_p)) &&
+        (0 == strncasecmp(hash_p, expected_p, hash_len));
+}
+
+/*
+ ******************************************************************************************************
+ Checks whether the udf-list info response of a node lists a module with the
+ given content hash. The response is made of ';' separated entries of ','
+ separated name=value fields, such as filename=m.lua,hash=...,type=LUA,
+ which are compared field by field rather than as a substring.
+ *
+ * @param response_p                The info response of the node.
+ * @param udata_p                   The udf_module_match to look up.
+ *
+ * @return true if the module is listed with the given hash.
+ ******************************************************************************************************
+ */
+static bool
+aerospike_udf_list_has_module(const char* response_p, void* udata_p)
+{
+    udf_module_match*       match_p = (udf_module_match *) udata_p;
+    const char*             end_p = NULL;
+    const char*             entry_end_p = NULL;
+    const char*             field_p = NULL;
+    const char*             field_end_p = NULL;
+    const char*             value_p = NULL;
+    size_t                  value_len = 0;
+    bool                    has_name = false;
+    bool                    has_hash = false;
+
+    if ((value_p = strchr(response_p, '\t'))) {
+        response_p = value_p + 1;
+    }
+    end_p = response_p + strcspn(response_p, "\n");
+
+    while (response_p < end_p) {
+        if (!(entry_end_p = memchr(response_p, ';', end_p - response_p))) {
+            entry_end_p = end_p;
+        }
+        has_name = has_hash = false;
+        for (field_p = response_p; field_p < entry_end_p; field_p = field_end_p + 1) {
+            if (!(field_end_p = memchr(field_p, ',', entry_end_p - field_p))) {
+                field_end_p = entry_end_p;
+            }
+            if (!(value_p = memchr(field_p, '=', field_end_p - field_p))) {
+                continue;
+            }
+            value_len = field_end_p - value_p - 1;
+            if ((value_p - field_p == sizeof(UDF_LIST_FILENAME) - 1) &&
+                    (0 == strncmp(field_p, UDF_LIST_FILENAME, value_p - field_p))) {
+                has_name = (value_len == strlen(match_p->module_p)) &&
+                    (0 == strncmp(value_p + 1, match_p->module_p, value_len));
+            } else if ((value_p - field_p == sizeof(UDF_LIST_HASH) - 1) &&
+                    (0 == strncmp(field_p, UDF_LIST_HASH, value_p - field_p))) {
+                has_hash = aerospike_udf_hash_equals(value_p + 1, value_len, match_p->hash_p);
+            }
+        }
+        if (has_name && has_hash) {
+            return true;
+        }
+        response_p = entry_end_p + 1;
+    }
+    return false;
+}
+
+/*
+ ******************************************************************************************************
+ Checks whether a UDF module with the given content hash is already
+ registered with the cluster, by looking it up in the list of registered
+ modules and their hashes.
+ *
+ * @param aerospike_obj_p           The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param info_policy_p             The info policy of the lookup.
+ * @param module_p                  The name of the module.
+ * @param language                  The Aerospike::UDF_TYPE_* constant.
+ * @param hash_p                    The hex encoded SHA1 hash of the content of
+ *                                  the module.
+ *
+ * @return true if the module is registered with the same type and content.
+ ******************************************************************************************************
+ */
+static bool
+aerospike_udf_is_registered(Aerospike_object* aerospike_obj_p, as_error* error_p,
+        as_policy_info* info_policy_p, char* module_p, long language, char* hash_p)
+{
+    as_udf_files            udf_files;
+    uint32_t                i = 0;
+    bool                    is_registered = false;
+
+    as_udf_files_init(&udf_files, 0);
+    if (AEROSPIKE_OK != aerospike_udf_list(aerospike_obj_p->as_ref_p->as_p,
+                error_p, info_policy_p, &udf_files)) {
+        DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+        goto exit;
+    }
+
+    for (i = 0; i < udf_files.size; i++) {
+        if ((udf_files.entries[i].type == language) &&
+                (0 == strcmp(udf_files.entries[i].name, module_p)) &&
+                aerospike_udf_hash_equals((char *) udf_files.entries[i].hash,
+                    strnlen((char *) udf_files.entries[i].hash, AS_UDF_FILE_HASH_SIZE),
+                    hash_p)) {
+            is_registered = true;
+            break;
+        }
+    }
+
+exit:
+    as_udf_files_destroy(&udf_files);
+    return is_registered;
+}
 
 /*
  ******************************************************************************************************
@@ -19,13 +162,21 @@
  * @param path_p                    The path to the module on the client side
  * @param language                  The Aerospike::UDF_TYPE_* constant.
  * @param options_p                 The optional policy.
+ * @param block                     Whether to wait until every node of the
+ *                                  cluster has the module.
+ * @param task_p                    The task handle to be populated for
+ *                                  Aerospike::taskStatus() if not waiting, or NULL.
+ *
+ * The upload, and the reload of the module by every node of the cluster, is
+ * skipped when a module of the same name, type and content is registered.
  *
  * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
  ******************************************************************************************************
  */
 extern as_status
 aerospike_udf_register(Aerospike_object* aerospike_obj_p, as_error* error_p,
-        char* path_p, char* module_p, long language, zval* options_p)
+        char* path_p, char* module_p, long language, zval* options_p,
+        bool block, zval* task_p)
 {
     FILE*                   file_p = NULL;
     uint32_t                size = 0;
@@ -36,6 +187,9 @@ aerospike_udf_register(Aerospike_object* aerospike_obj_p, as_error* error_p,
     as_bytes                udf_content;
     as_bytes*               udf_content_p = NULL;
     as_policy_info          info_policy;
+    PHP_SHA1_CTX            sha1_context;
+    unsigned char           sha1_digest[20];
+    char                    sha1_hex[41];
     TSRMLS_FETCH_FROM_CTX(aerospike_obj_p->ts);
 
     set_policy(NULL, NULL, NULL, NULL, &info_policy, NULL,
@@ -79,6 +233,24 @@ aerospike_udf_register(Aerospike_object* aerospike_obj_p, as_error* error_p,
         read = (int) fread(buff_p, 1, LUA_FILE_BUFFER_FRAME, file_p);
     }
 
+    PHP_SHA1Init(&sha1_context);
+    PHP_SHA1Update(&sha1_context, bytes_p, size);
+    PHP_SHA1Final(sha1_digest, &sha1_context);
+    make_sha1_digest(sha1_hex, sha1_digest);
+
+    if (task_p) {
+        add_assoc_string(task_p, TASK_TYPE, TASK_TYPE_UDF, 1);
+        add_assoc_string(task_p, TASK_MODULE, module_p, 1);
+        add_assoc_string(task_p, TASK_HASH, sha1_hex, 1);
+    }
+
+    if (aerospike_udf_is_registered(aerospike_obj_p, error_p, &info_policy,
+                module_p, language, sha1_hex)) {
+        DEBUG_PHP_EXT_DEBUG("UDF module is already registered, skipping upload");
+        goto exit;
+    }
+    PHP_EXT_SET_AS_ERR(error_p, DEFAULT_ERRORNO, DEFAULT_ERROR);
+
     as_bytes_init_wrap(&udf_content, bytes_p, size, false);
     udf_content_p = &udf_content;
     /*
@@ -89,9 +261,9 @@ aerospike_udf_register(Aerospike_object* aerospike_obj_p, as_error* error_p,
                       udf_content_p)) {
         DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
         goto exit;
-    } else if (AEROSPIKE_OK !=
+    } else if (block && (AEROSPIKE_OK !=
             aerospike_udf_put_wait(aerospike_obj_p->as_ref_p->as_p,
-                error_p, &info_policy, module_p, 0)) {
+                error_p, &info_policy, module_p, 0))) {
         DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
         goto exit;
     }
@@ -112,6 +284,36 @@ exit:
     return error_p->code;
 }
 
+/*
+ ******************************************************************************************************
+ Gets the progress of the registration of a UDF module, from whether each
+ node of the cluster lists the module with the registered content hash, as
+ checked by aerospike_udf_list_has_module().
+ *
+ * @param aerospike_obj_p           The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param module_p                  The name of the module.
+ * @param hash_p                    The hex encoded SHA1 hash of the registered content.
+ * @param status_p                  The task status array to be populated.
+ * @param options_p                 The optional policy.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+extern as_status
+aerospike_udf_task_status(Aerospike_object* aerospike_obj_p, as_error* error_p,
+        char* module_p, char* hash_p, zval* status_p, zval* options_p)
+{
+    udf_module_match        match;
+    TSRMLS_FETCH_FROM_CTX(aerospike_obj_p->ts);
+
+    match.module_p = module_p;
+    match.hash_p = hash_p;
+    return aerospike_info_task_status(aerospike_obj_p->as_ref_p->as_p, error_p,
+            "udf-list", aerospike_udf_list_has_module, &match, NULL, status_p,
+            options_p TSRMLS_CC);
+}
+
 /*
  ******************************************************************************************************
  Remove a UDF module from the aerospike DB.
@@ -148,6 +350,59 @@ exit:
     return error_p->code;
 }
 
+/*
+ ******************************************************************************************************
+ Applies a UDF with an already marshalled list of arguments to a record, and
+ converts its result.
+ *
+ * @param aerospike_obj_p           The C client's aerospike object.
+ * @param as_key_p                  The C client's as_key that identifies the
+ *                                  record on which UDF will be applied.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param apply_policy_p            The apply policy.
+ * @param module_p                  The name of the UDF module.
+ * @param function_p                The name of the function to be applied.
+ * @param args_list_p               The arguments of the UDF, or NULL.
+ * @param return_value_p            It will contain result value of calling the
+ *                                  UDF, if not NULL.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+static as_status
+aerospike_udf_apply_list(Aerospike_object* aerospike_obj_p, as_key* as_key_p,
+        as_error* error_p, as_policy_apply* apply_policy_p, char* module_p,
+        char* function_p, as_list* args_list_p, zval* return_value_p)
+{
+    as_val*                     udf_result_p = NULL;
+    foreach_callback_udata      udf_result_callback_udata;
+    uint64_t                    started_at = aerospike_latency_now();
+    TSRMLS_FETCH_FROM_CTX(aerospike_obj_p->ts);
+
+    aerospike_key_apply(aerospike_obj_p->as_ref_p->as_p, error_p, apply_policy_p,
+            as_key_p, module_p, function_p, args_list_p, &udf_result_p);
+    aerospike_latency_record(aerospike_obj_p->as_ref_p->as_p, AEROSPIKE_LATENCY_UDF,
+            as_key_p, started_at);
+    aerospike_call_trace_command(aerospike_obj_p->as_ref_p->as_p, AEROSPIKE_LATENCY_UDF,
+            NULL, as_key_p, error_p->code, started_at TSRMLS_CC);
+    if (AEROSPIKE_OK != error_p->code) {
+        DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+        goto exit;
+    }
+
+    if (return_value_p) {
+        udf_result_callback_udata.udata_p = return_value_p;
+        udf_result_callback_udata.error_p = error_p;
+        AS_DEFAULT_GET(NULL, udf_result_p, &udf_result_callback_udata);
+    }
+
+exit:
+    if (udf_result_p) {
+        as_val_destroy(udf_result_p);
+    }
+    return error_p->code;
+}
+
 /*
  ******************************************************************************************************
  Applies a UDF to a record at the Aerospike DB.
@@ -176,8 +431,6 @@ aerospike_udf_apply(Aerospike_object* aerospike_obj_p,
     as_arraylist                args_list;
     as_arraylist*               args_list_p = NULL;
     as_static_pool              udf_pool = {0};
-    as_val*                     udf_result_p = NULL;
-    foreach_callback_udata      udf_result_callback_udata;
     uint32_t                    serializer_policy = -1;
     as_policy_apply             apply_policy;
     TSRMLS_FETCH_FROM_CTX(aerospike_obj_p->ts);
@@ -196,24 +449,10 @@ aerospike_udf_apply(Aerospike_object* aerospike_obj_p,
         AS_LIST_PUT(NULL, args_pp, args_list_p, &udf_pool, serializer_policy, error_p TSRMLS_CC);
     }
 
-    if (AEROSPIKE_OK != (aerospike_key_apply(aerospike_obj_p->as_ref_p->as_p,
-                    error_p, &apply_policy, as_key_p, module_p, function_p,
-                    (as_list *) args_list_p, &udf_result_p))) {
-        DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
-        goto exit;
-    }
+    aerospike_udf_apply_list(aerospike_obj_p, as_key_p, error_p, &apply_policy,
+            module_p, function_p, (as_list *) args_list_p, return_value_p);
 
-    if (return_value_p) {
-        udf_result_callback_udata.udata_p = return_value_p;
-        udf_result_callback_udata.error_p = error_p;
-        AS_DEFAULT_GET(NULL, udf_result_p, &udf_result_callback_udata);
-    }
-     
 exit:
-    if (udf_result_p) {
-        as_val_destroy(udf_result_p);
-    }
-    
     if (args_list_p) {
         as_arraylist_destroy(args_list_p);
     }
@@ -224,6 +463,59 @@ exit:
     return error_p->code;
 }
 
+/*
+ ******************************************************************************************************
+ Applies a UDF call prepared by Aerospike::prepareApply() to a record. The
+ apply policy was resolved when the call was prepared, and the arguments are
+ marshalled into the list and static pool of the call, which are emptied
+ instead of released afterwards to be reused by the next call.
+ *
+ * @param aerospike_obj_p           The C client's aerospike object.
+ * @param udf_call_p                The prepared UDF call.
+ * @param as_key_p                  The C client's as_key that identifies the
+ *                                  record on which UDF will be applied.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param args_p                    An array of arguments for the UDF, or NULL.
+ * @param return_value_p            It will contain result value of calling the
+ *                                  UDF, if not NULL.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+extern as_status
+aerospike_udf_call_apply(Aerospike_object* aerospike_obj_p,
+        Aerospike_udf_call_object* udf_call_p, as_key* as_key_p,
+        as_error* error_p, zval* args_p, zval* return_value_p)
+{
+    uint32_t                    serializer_policy = -1;
+    uint32_t                    i;
+    TSRMLS_FETCH_FROM_CTX(aerospike_obj_p->ts);
+
+    PHP_EXT_SET_AS_ERR(error_p, DEFAULT_ERRORNO, DEFAULT_ERROR);
+
+    if (args_p) {
+        AS_LIST_PUT(NULL, &args_p, udf_call_p->args_list_p,
+                udf_call_p->udf_pool_p, serializer_policy, error_p TSRMLS_CC);
+        if (AEROSPIKE_OK != error_p->code) {
+            goto exit;
+        }
+    }
+
+    aerospike_udf_apply_list(aerospike_obj_p, as_key_p, error_p,
+            &udf_call_p->apply_policy, udf_call_p->module,
+            udf_call_p->function, (as_list *) udf_call_p->args_list_p,
+            return_value_p);
+
+exit:
+    for (i = 0; i < udf_call_p->args_list_p->size; i++) {
+        as_val_destroy(udf_call_p->args_list_p->elements[i]);
+    }
+    udf_call_p->args_list_p->size = 0;
+    aerospike_helper_free_static_pool(udf_call_p->udf_pool_p);
+
+    return error_p->code;
+}
+
 /*
  ******************************************************************************************************
  Lists the UDF modules registered with the server.
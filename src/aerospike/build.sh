@@ -115,7 +115,7 @@ if [ $OS = "Darwin" ] ; then
     else
         LIBLUA="-llua"
     fi
-    LDFLAGS="-L$CLIENTREPO_3X/lib -laerospike -lcrypto $LIBLUA"
+    LDFLAGS="-L$CLIENTREPO_3X/lib -laerospike -lcrypto -lz $LIBLUA"
 else
     LDFLAGS="-Wl,-Bstatic -L$CLIENTREPO_3X/lib -laerospike -Wl,-Bdynamic -llua$LUA_SUFFIX"
     # Find and link to libcrypto (provided by OpenSSL)
@@ -143,7 +143,7 @@ else
             fi
         fi
     fi
-    LDFLAGS="$LDFLAGS $LIBCRYPTO -lrt"
+    LDFLAGS="$LDFLAGS $LIBCRYPTO -lz -lrt"
 fi
 
 make clean all "CFLAGS=$CFLAGS" "EXTRA_INCLUDES+=-I$CLIENTREPO_3X/include -I$CLIENTREPO_3X/include/ck -I$INCLUDE_LUA_5_1" "EXTRA_LDFLAGS=$LDFLAGS"
@@ -2,5 +2,7 @@ PHP_ARG_ENABLE(aerospike, whether to enable Aerospike support, [ --enable-aerosp
 
 if test "$PHP_AEROSPIKE" = "yes"; then
   AC_DEFINE(HAVE_AEROSPIKE, 1, [Whether you have Aerospike])
-  PHP_NEW_EXTENSION(aerospike, aerospike.c aerospike_policy.c aerospike_transform.c aerospike_helper.c aerospike_record_operations.c aerospike_udf.c aerospike_scan.c aerospike_query.c aerospike_index_operations.c aerospike_info_operations.c aerospike_batch_operations.c aerospike_session_handler.c, $ext_shared)
+  PHP_ADD_LIBRARY(z, 1, AEROSPIKE_SHARED_LIBADD)
+  PHP_SUBST(AEROSPIKE_SHARED_LIBADD)
+  PHP_NEW_EXTENSION(aerospike, aerospike.c aerospike_policy.c aerospike_transform.c aerospike_helper.c aerospike_record_operations.c aerospike_udf.c aerospike_scan.c aerospike_query.c aerospike_index_operations.c aerospike_info_operations.c aerospike_batch_operations.c aerospike_session_handler.c aerospike_record_cache.c aerospike_latency.c, $ext_shared)
 fi
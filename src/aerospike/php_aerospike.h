@@ -33,6 +33,7 @@
 #include "TSRM.h"
 #endif
 #include "aerospike/as_error.h"
+#include "aerospike/as_key.h"
 #include "pthread.h"
 
 typedef struct global_error {
@@ -56,8 +57,38 @@ ZEND_BEGIN_MODULE_GLOBALS(aerospike)
     int shm_max_nodes;
     int shm_max_namespaces;
     int shm_takeover_threshold_sec;
+    zend_bool session_lock;
+    long session_lock_ttl;
+    long session_lock_wait;
+    zend_bool session_skip_read_new_id;
+    long session_compress_threshold;
+    zend_bool session_bin_per_key;
+    long session_bin_per_key_max;
+    long sindex_cache_ttl;
+    long read_cache_max_memory;
+    long read_cache_max_age;
+    long shm_record_cache_key;
+    long shm_record_cache_size;
+    long shm_record_cache_slot_size;
+    long shm_record_cache_max_ttl;
+    zend_bool read_memo;
+    long call_trace_size;
+    long slow_log_threshold;
+    long slow_log_sample_rate;
+    char *slow_log_path;
+    long log_handler_buffer_size;
+    char *session_save_path_g;
+    char session_ns_g[AS_NAMESPACE_MAX_SIZE];
+    char session_set_g[AS_SET_MAX_SIZE];
+    struct csdk_aerospike_obj *session_as_ref_g;
     aerospike_global_error error_g;
     HashTable *persistent_list_g;
+    HashTable *read_memo_g;
+    struct aerospike_call_trace_t *call_traces_g;
+    uint32_t call_trace_capacity_g;
+    uint32_t call_trace_count_g;
+    uint32_t call_trace_next_g;
+    uint64_t slow_log_calls_g;
     int persistent_ref_count;
     pthread_rwlock_t aerospike_mutex;
 ZEND_END_MODULE_GLOBALS(aerospike)
@@ -93,8 +124,11 @@ PHP_METHOD(Aerospike, isConnected);
 PHP_METHOD(Aerospike, close);
 PHP_METHOD(Aerospike, reconnect);
 PHP_METHOD(Aerospike, getNodes);
+PHP_METHOD(Aerospike, getStats);
+PHP_METHOD(Aerospike, lastCallTrace);
 PHP_METHOD(Aerospike, info);
 PHP_METHOD(Aerospike, infoMany);
+PHP_METHOD(Aerospike, infoParsed);
 
 /*
  * Error Handling APIs:
@@ -109,6 +143,7 @@ PHP_METHOD(Aerospike, errorno);
 
 PHP_METHOD(Aerospike, add);
 PHP_METHOD(Aerospike, append);
+PHP_METHOD(Aerospike, compilePolicy);
 PHP_METHOD(Aerospike, exists);
 PHP_METHOD(Aerospike, get);
 PHP_METHOD(Aerospike, getMany);
@@ -116,6 +151,7 @@ PHP_METHOD(Aerospike, getMetadata);
 PHP_METHOD(Aerospike, getHeader);
 PHP_METHOD(Aerospike, getHeaderMany);
 PHP_METHOD(Aerospike, initKey);
+PHP_METHOD(Aerospike, prepareKey);
 PHP_METHOD(Aerospike, increment);
 PHP_METHOD(Aerospike, operate);
 PHP_METHOD(Aerospike, prepend);
@@ -138,7 +174,10 @@ PHP_METHOD(Aerospike, setLogHandler);
  */
 
 PHP_METHOD(Aerospike, createIndex);
+PHP_METHOD(Aerospike, createIndexAsync);
 PHP_METHOD(Aerospike, dropIndex);
+PHP_METHOD(Aerospike, indexes);
+PHP_METHOD(Aerospike, taskStatus);
 
 /*
  * Query and Scan APIs:
@@ -146,22 +185,45 @@ PHP_METHOD(Aerospike, dropIndex);
 
 PHP_METHOD(Aerospike, predicateBetween);
 PHP_METHOD(Aerospike, predicateEquals);
+PHP_METHOD(Aerospike, predicateIn);
+PHP_METHOD(Aerospike, predicateContains);
 PHP_METHOD(Aerospike, query);
 PHP_METHOD(Aerospike, aggregate);
+PHP_METHOD(Aerospike, reduce);
 PHP_METHOD(Aerospike, scan);
+PHP_METHOD(Aerospike, scanNodes);
 PHP_METHOD(Aerospike, scanApply);
 PHP_METHOD(Aerospike, scanInfo);
+PHP_METHOD(Aerospike, queryApplyEach);
+PHP_METHOD(Aerospike, jobInfo);
+PHP_METHOD(Aerospike, jobsList);
+PHP_METHOD(Aerospike, jobAbort);
+PHP_METHOD(Aerospike, jobSetPriority);
 
 /*
  * User Defined Function (UDF) APIs:
  */
 
 PHP_METHOD(Aerospike, register);
+PHP_METHOD(Aerospike, registerAsync);
 PHP_METHOD(Aerospike, deregister);
 PHP_METHOD(Aerospike, apply);
+PHP_METHOD(Aerospike, prepareApply);
 PHP_METHOD(Aerospike, listRegistered);
 PHP_METHOD(Aerospike, getRegistered);
 
+/*
+ * Aerospike\UdfCall APIs:
+ */
+
+PHP_METHOD(AerospikeUdfCall, apply);
+
+/*
+ * Aerospike\Key APIs:
+ */
+
+PHP_METHOD(AerospikeKey, toArray);
+
 /*
  * Batch Operations APIs:
  */
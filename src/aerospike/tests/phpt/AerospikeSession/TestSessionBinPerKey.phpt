@@ -0,0 +1,17 @@
+--TEST--
+AerospikeSession - Check a session written and read in bin per key mode.
+
+--INI--
+aerospike.session.bin_per_key=true
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionBinPerKey");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionBinPerKey");
+--EXPECT--
+OK
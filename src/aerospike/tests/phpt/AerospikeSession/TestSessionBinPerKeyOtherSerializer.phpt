@@ -0,0 +1,18 @@
+--TEST--
+AerospikeSession - Check bin per key mode with the php_binary serialize handler.
+
+--INI--
+aerospike.session.bin_per_key=true
+session.serialize_handler=php_binary
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionBinPerKeyOtherSerializer");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionBinPerKeyOtherSerializer");
+--EXPECT--
+OK
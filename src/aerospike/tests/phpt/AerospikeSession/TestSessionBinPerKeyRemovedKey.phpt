@@ -0,0 +1,17 @@
+--TEST--
+AerospikeSession - Check removed session keys in bin per key mode.
+
+--INI--
+aerospike.session.bin_per_key=true
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionBinPerKeyRemovedKey");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionBinPerKeyRemovedKey");
+--EXPECT--
+OK
@@ -0,0 +1,17 @@
+--TEST--
+AerospikeSession - Check a session compressed above the threshold.
+
+--INI--
+aerospike.session.compress_threshold=1024
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionCompressed");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionCompressed");
+--EXPECT--
+OK
@@ -0,0 +1,18 @@
+--TEST--
+AerospikeSession - Check that session locking waits for a held lock.
+
+--INI--
+aerospike.session.lock=true
+aerospike.session.lock_wait=500
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionLockWait");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionLockWait");
+--EXPECT--
+OK
@@ -0,0 +1,14 @@
+--TEST--
+AerospikeSession - Check sessions reopened with a cached and a changed save path.
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionSavePathCache");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionSavePathCache");
+--EXPECT--
+OK
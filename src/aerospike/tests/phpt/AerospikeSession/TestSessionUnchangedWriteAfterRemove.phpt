@@ -0,0 +1,14 @@
+--TEST--
+AerospikeSession - Check that an unchanged session removed after read is written in full.
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionUnchangedWriteAfterRemove");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionUnchangedWriteAfterRemove");
+--EXPECT--
+OK
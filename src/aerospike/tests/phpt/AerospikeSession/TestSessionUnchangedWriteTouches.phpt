@@ -0,0 +1,14 @@
+--TEST--
+AerospikeSession - Check that an unchanged session is only touched.
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionUnchangedWriteTouches");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionUnchangedWriteTouches");
+--EXPECT--
+OK
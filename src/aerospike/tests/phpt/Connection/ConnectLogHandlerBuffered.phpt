@@ -0,0 +1,12 @@
+--TEST--
+Connection - log events buffered with aerospike.log_handler.buffer_size passed to a batch handler in one call
+
+--INI--
+aerospike.log_handler.buffer_size=64
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Connection", "testConnectLogHandlerBuffered");
+--EXPECT--
+OK
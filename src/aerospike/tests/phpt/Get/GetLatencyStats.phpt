@@ -0,0 +1,9 @@
+--TEST--
+Get - counted in the latency statistics of getStats()
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Get", "testGETLatencyStats");
+--EXPECT--
+OK
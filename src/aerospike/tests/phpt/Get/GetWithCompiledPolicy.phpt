@@ -0,0 +1,9 @@
+--TEST--
+Get - with a compiled read policy
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Get", "testGETWithCompiledPolicy");
+--EXPECT--
+OK
@@ -0,0 +1,13 @@
+--TEST--
+Get - with OPT_READ_CACHE evicting the least recently used record
+
+--INI--
+aerospike.read_cache.max_memory=6000
+aerospike.read_cache.max_age=60
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Get", "testGETWithReadCacheEviction");
+--EXPECT--
+OK
@@ -0,0 +1,13 @@
+--TEST--
+Get - with OPT_READ_CACHE revalidating the generation of the record
+
+--INI--
+aerospike.read_cache.max_memory=1048576
+aerospike.read_cache.max_age=2
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Get", "testGETWithReadCacheRevalidation");
+--EXPECT--
+OK
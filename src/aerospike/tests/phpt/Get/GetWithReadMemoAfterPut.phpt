@@ -0,0 +1,9 @@
+--TEST--
+Get - with aerospike.read_memo after a put
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Get", "testGETWithReadMemoAfterPut");
+--EXPECT--
+OK
@@ -0,0 +1,15 @@
+--TEST--
+Get - with OPT_READ_CACHE from the shared memory record cache
+
+--INI--
+aerospike.shm.use=true
+aerospike.shm.record_cache.key=2785017857
+aerospike.shm.record_cache.size=1048576
+aerospike.read_cache.max_memory=0
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Get", "testGETWithShmRecordCache");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Get - put with a compiled read policy
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Get", "testPUTWithCompiledReadPolicy");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Index - createIndexAsync polled with taskStatus
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Index", "testCreateIndexAsyncTaskStatusPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Index - indexes() lists a created index
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Index", "testIndexesListsCreatedIndexPositive");
+--EXPECT--
+OK
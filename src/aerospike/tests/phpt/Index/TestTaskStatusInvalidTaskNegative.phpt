@@ -0,0 +1,9 @@
+--TEST--
+Index - taskStatus with an invalid task handle
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Index", "testTaskStatusInvalidTaskNegative");
+--EXPECT--
+ERR_PARAM
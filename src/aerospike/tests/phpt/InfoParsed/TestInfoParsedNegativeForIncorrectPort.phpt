@@ -0,0 +1,9 @@
+--TEST--
+InfoParsed - Check for incorrect port no
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("InfoParsed", "testInfoParsedNegativeForIncorrectPort");
+--EXPECT--
+ERR_CLIENT
@@ -0,0 +1,9 @@
+--TEST--
+InfoParsed - Check for no arguments
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("InfoParsed", "testInfoParsedNoParameter");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+InfoParsed - Positive for sets
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("InfoParsed", "testInfoParsedPositiveForSets");
+--EXPECT--
+OK
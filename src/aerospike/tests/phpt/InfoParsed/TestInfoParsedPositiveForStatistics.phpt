@@ -0,0 +1,9 @@
+--TEST--
+InfoParsed - Positive for statistics
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("InfoParsed", "testInfoParsedPositiveForStatistics");
+--EXPECT--
+OK
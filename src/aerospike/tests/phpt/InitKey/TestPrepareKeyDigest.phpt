@@ -0,0 +1,9 @@
+--TEST--
+InitKey - prepared key digest
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("InitKey", "testPrepareKeyDigest");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+InitKey - prepared key used by key-value and batch methods
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("InitKey", "testPrepareKeyUsedByKeyValueMethods");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+jobAbort - job unknown to the cluster
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Job", "testJobAbortUnknownJob");
+--EXPECT--
+ERR_REQUEST_INVALID
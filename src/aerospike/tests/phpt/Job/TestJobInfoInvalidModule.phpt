@@ -0,0 +1,9 @@
+--TEST--
+jobInfo - invalid module
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Job", "testJobInfoInvalidModule");
+--EXPECT--
+ERR_PARAM
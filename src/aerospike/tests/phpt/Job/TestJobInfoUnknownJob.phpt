@@ -0,0 +1,9 @@
+--TEST--
+jobInfo - job unknown to the cluster
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Job", "testJobInfoUnknownJob");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+jobSetPriority - invalid priority
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Job", "testJobSetPriorityInvalidPriority");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+jobsList - jobs of every node
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Job", "testJobsListPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+PredicateContains - Basic Operation
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Predicate", "testPredicateContainsHelper");
+--EXPECT--
+OK
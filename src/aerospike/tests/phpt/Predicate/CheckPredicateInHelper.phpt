@@ -0,0 +1,9 @@
+--TEST--
+PredicateIn - Basic Operation
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Predicate", "testPredicateInHelper");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Put - get of a missing record traced by lastCallTrace()
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Put", "testGETCallTraceRecordNotFound");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Put - put and get traced by lastCallTrace()
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Put", "testPUTAndGETCallTrace");
+--EXPECT--
+OK
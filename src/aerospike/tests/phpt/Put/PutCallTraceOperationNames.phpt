@@ -0,0 +1,9 @@
+--TEST--
+Put - exists, removeBin and remove traced under their own names
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Put", "testPUTCallTraceOperationNames");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Put - call traces beyond aerospike.call_trace_size overwrite the oldest
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Put", "testPUTCallTraceOverwritesOldest");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+PUT - slow operation log sample
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Put", "testPUTSlowLogSample");
+--EXPECT--
+OK
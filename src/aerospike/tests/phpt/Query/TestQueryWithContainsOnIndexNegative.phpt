@@ -0,0 +1,9 @@
+--TEST--
+Query - CONTAINS predicate on the secondary index
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Query", "testQueryWithContainsOnIndexNegative");
+--EXPECT--
+ERR_PARAM
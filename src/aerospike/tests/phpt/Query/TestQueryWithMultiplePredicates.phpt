@@ -0,0 +1,9 @@
+--TEST--
+Query - index predicate with filters on other bins
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Query", "testQueryWithMultiplePredicates");
+--EXPECT--
+OK
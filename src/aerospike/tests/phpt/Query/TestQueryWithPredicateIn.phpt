@@ -0,0 +1,9 @@
+--TEST--
+Query - IN predicate on the secondary index
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Query", "testQueryWithPredicateIn");
+--EXPECT--
+OK
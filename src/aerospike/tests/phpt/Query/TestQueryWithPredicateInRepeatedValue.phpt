@@ -0,0 +1,9 @@
+--TEST--
+Query - IN predicate repeating a value
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Query", "testQueryWithPredicateInRepeatedValue");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Query - non-indexed bin run as a filtered scan
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Query", "testQueryWithScanFallback");
+--EXPECT--
+OK
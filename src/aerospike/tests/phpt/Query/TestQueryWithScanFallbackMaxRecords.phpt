@@ -0,0 +1,9 @@
+--TEST--
+Query - scan fallback stops after OPT_MAX_RECORDS records
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Query", "testQueryWithScanFallbackMaxRecords");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+QueryApplyEach - drops the records memoized by aerospike.read_memo
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("QueryApplyEach", "testQueryApplyEachDropsReadMemo");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+QueryApplyEach - empty module name
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("QueryApplyEach", "testQueryApplyEachEmptyModuleNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+QueryApplyEach - OPT_MAX_RECORDS is rejected
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("QueryApplyEach", "testQueryApplyEachMaxRecordsNegative");
+--EXPECT--
+ERR_PARAM
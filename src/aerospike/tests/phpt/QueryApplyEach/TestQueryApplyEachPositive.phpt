@@ -0,0 +1,9 @@
+--TEST--
+QueryApplyEach - UDF applied to the matching records
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("QueryApplyEach", "testQueryApplyEachPositive");
+--EXPECT--
+OK
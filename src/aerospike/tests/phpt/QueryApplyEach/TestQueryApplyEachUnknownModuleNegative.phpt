@@ -0,0 +1,9 @@
+--TEST--
+QueryApplyEach - unknown module
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("QueryApplyEach", "testQueryApplyEachUnknownModuleNegative");
+--EXPECT--
+ERR_UDF
@@ -0,0 +1,9 @@
+--TEST--
+Reduce - count of records matching the predicate
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Reduce", "testReduceCountPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Reduce - predicate not satisfied by any record
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Reduce", "testReduceEmptyResultPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Reduce - group values colliding as array keys
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Reduce", "testReduceGroupByCollisionNegative");
+--EXPECT--
+OK
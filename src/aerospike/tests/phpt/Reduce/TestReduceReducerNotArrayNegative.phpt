@@ -0,0 +1,9 @@
+--TEST--
+Reduce - reducer is not an array
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Reduce", "testReduceReducerNotArrayNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Reduce - sum, min and max of a bin
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Reduce", "testReduceSumMinMaxPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Reduce - sum overflowing a 64-bit integer
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Reduce", "testReduceSumOverflowNegative");
+--EXPECT--
+OK
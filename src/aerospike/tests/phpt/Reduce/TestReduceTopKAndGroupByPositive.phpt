@@ -0,0 +1,9 @@
+--TEST--
+Reduce - top k and group by sum
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Reduce", "testReduceTopKAndGroupByPositive");
+--EXPECT--
+OK
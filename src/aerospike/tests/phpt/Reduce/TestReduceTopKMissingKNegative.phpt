@@ -0,0 +1,9 @@
+--TEST--
+Reduce - top k without k
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Reduce", "testReduceTopKMissingKNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Reduce - unknown reducer type
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Reduce", "testReduceUnknownTypeNegative");
+--EXPECT--
+ERR_PARAM
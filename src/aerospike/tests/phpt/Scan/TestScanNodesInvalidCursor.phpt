@@ -0,0 +1,9 @@
+--TEST--
+Scan - scanNodes() with an invalid cursor
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanNodesInvalidCursor");
+--EXPECT--
+ERR_PARAM
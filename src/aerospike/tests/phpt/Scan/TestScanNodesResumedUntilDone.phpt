@@ -0,0 +1,9 @@
+--TEST--
+Scan - scanNodes() resumed with its cursor until done
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanNodesResumedUntilDone");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Scan - OPT_SCAN_SHARD outside of the number of shards
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanWithInvalidShard");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Scan - OPT_SCAN_SHARD with more shards than nodes
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanWithMoreShardsThanNodes");
+--EXPECT--
+ERR_PARAM
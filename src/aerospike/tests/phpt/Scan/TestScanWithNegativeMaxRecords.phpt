@@ -0,0 +1,9 @@
+--TEST--
+Scan - negative OPT_MAX_RECORDS
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanWithNegativeMaxRecords");
+--EXPECT--
+ERR_CLIENT
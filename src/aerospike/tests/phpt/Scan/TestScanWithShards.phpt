@@ -0,0 +1,9 @@
+--TEST--
+Scan - split into shards with OPT_SCAN_SHARD
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanWithShards");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Scan - shard credited to its node in getStats()
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanWithShardsNodeStats");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+ScanApply - OPT_MAX_RECORDS is rejected
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanApply", "testScanApplyMaxRecordsNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+ScanApply - OPT_SCAN_SHARD is rejected
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanApply", "testScanApplyShardNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Udf - register an unchanged module again
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Udf", "testUdfPositiveRegisterUnchangedModule");
+--EXPECT--
+OK
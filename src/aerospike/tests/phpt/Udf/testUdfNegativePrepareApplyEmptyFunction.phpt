@@ -0,0 +1,9 @@
+--TEST--
+Udf - prepareApply with an empty function name
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Udf", "testUdfNegativePrepareApplyEmptyFunction");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Udf - prepared apply called repeatedly
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Udf", "testUdfPositivePrepareApplyRepeatedly");
+--EXPECT--
+OK
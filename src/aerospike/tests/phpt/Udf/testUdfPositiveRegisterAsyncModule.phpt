@@ -0,0 +1,9 @@
+--TEST--
+Udf - registerAsync polled with taskStatus
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Udf", "testUdfPositiveRegisterAsyncModule");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Udf - taskStatus with an upper case module hash
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Udf", "testUdfTaskStatusUpperCaseHash");
+--EXPECT--
+OK